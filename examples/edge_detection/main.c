@@ -106,6 +106,21 @@ void threshold(unsigned char* original1, unsigned char* result, unsigned int dim
   }
 }
 
+/* markEdges and unmarkEdges convert the edges into three adjacent bytes {p, p, 0} and back;
+   the round trip is used to validate the coalescing of the stores (p = 255 is negative as a byte) */
+void markEdges(unsigned char* original1, unsigned char* result, unsigned int dimh, unsigned int h, unsigned int v){
+
+  unsigned char p = original1[v*dimh+h];
+  result[3*(v*dimh+h)-1]=p;
+  result[3*(v*dimh+h)]=p;
+  result[3*(v*dimh+h)+1]=0;
+}
+
+void unmarkEdges(unsigned char* original1, unsigned char* result, unsigned int dimh, unsigned int h, unsigned int v){
+
+  result[v*dimh+h]=(original1[3*(v*dimh+h)-1]+original1[3*(v*dimh+h)])/2-original1[3*(v*dimh+h)+1];
+}
+
 void loadImage(char *filename, unsigned char **dest, int *width, int *height)
 {
 
@@ -0,0 +1,13 @@
+#!/bin/sh
+# Generates the Verilog datapath of threshold.ll and simulates it with threshold_tb.v.
+# Requires the environment of <prefix_path>/setup.sh and Icarus Verilog.
+set -e
+DIR=$(cd "$(dirname "$0")" && pwd)
+TMP=$(mktemp -d)
+trap 'rm -rf "$TMP"' EXIT
+
+cd "$TMP"
+opt -load=cad-lib.so "$DIR/threshold.ll" -o /dev/null -dfg-printing -format="verilog" -function=threshold
+iverilog -o threshold_tb "$DIR/threshold_tb.v" threshold.v
+vvp threshold_tb | tee simulation.log
+grep -q "^PASSED" simulation.log
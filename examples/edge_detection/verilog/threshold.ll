@@ -0,0 +1,31 @@
+; threshold() of ../main.c after clang -m32 -S -emit-llvm and opt -mem2reg -instnamer (LLVM 3.2)
+target datalayout = "e-p:32:32:32-i1:8:8-i8:8:8-i16:16:16-i32:32:32-i64:32:64-f32:32:32-f64:32:64-v64:64:64-v128:128:128-a0:0:64-f80:32:32-n8:16:32-S128"
+target triple = "i386-pc-linux-gnu"
+
+define void @threshold(i8* %original1, i8* %result, i32 %dimh, i32 %h, i32 %v, i32 %thresh) nounwind {
+entry:
+  %mul = mul i32 %v, %dimh
+  %add = add i32 %mul, %h
+  %arrayidx = getelementptr inbounds i8* %original1, i32 %add
+  %tmp = load i8* %arrayidx, align 1
+  %conv = zext i8 %tmp to i32
+  %cmp = icmp slt i32 %conv, %thresh
+  br i1 %cmp, label %if.then, label %if.else
+
+if.then:
+  %mul1 = mul i32 %v, %dimh
+  %add2 = add i32 %mul1, %h
+  %arrayidx3 = getelementptr inbounds i8* %result, i32 %add2
+  store i8 0, i8* %arrayidx3, align 1
+  br label %if.end
+
+if.else:
+  %mul4 = mul i32 %v, %dimh
+  %add5 = add i32 %mul4, %h
+  %arrayidx6 = getelementptr inbounds i8* %result, i32 %add5
+  store i8 -1, i8* %arrayidx6, align 1
+  br label %if.end
+
+if.end:
+  ret void
+}
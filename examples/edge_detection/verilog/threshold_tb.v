@@ -0,0 +1,95 @@
+/// Testbench of threshold.v: one invocation per cycle over the inner pixels of a small image, with the
+/// memories modeled as arrays (data of the read port one cycle after the address), compared with the C
+/// code of ../main.c
+`timescale 1ns/1ps
+module threshold_tb;
+   localparam W = 8;
+   localparam H = 6;
+   localparam THRESH = 100;
+
+   reg clk = 1'b0;
+   reg rst = 1'b1;
+   reg in_valid = 1'b0;
+   reg signed [31:0] h = 0;
+   reg signed [31:0] v = 0;
+   wire out_valid;
+   wire [31:0] rd_addr, wr0_addr, wr1_addr;
+   wire rd_en, wr0_en, wr1_en;
+   reg [7:0] rd_data;
+   wire [7:0] wr0_data, wr1_data;
+
+   reg [7:0] original1 [0:W*H-1];
+   reg [7:0] result [0:W*H-1];
+   integer i, x, y, invocations, completed, errors;
+   reg [7:0] expected;
+
+   threshold dut(
+      .clk(clk), .rst(rst), .in_valid(in_valid), .out_valid(out_valid),
+      .dimh(W), .h(h), .v(v), .thresh(THRESH),
+      .original1_rd0_addr(rd_addr), .original1_rd0_en(rd_en), .original1_rd0_data(rd_data),
+      .result_wr0_addr(wr0_addr), .result_wr0_data(wr0_data), .result_wr0_en(wr0_en),
+      .result_wr1_addr(wr1_addr), .result_wr1_data(wr1_data), .result_wr1_en(wr1_en)
+   );
+
+   always #5 clk = !clk;
+
+   always @(posedge clk)
+   begin
+      if (rd_en) rd_data <= original1[rd_addr];
+      if (wr0_en) result[wr0_addr] <= wr0_data;
+      if (wr1_en) result[wr1_addr] <= wr1_data;
+      if (out_valid) completed = completed + 1;
+   end
+
+   initial
+   begin
+      for(i = 0; i < W*H; i = i + 1)
+      begin
+         original1[i] = (i * 37 + 11) % 256;
+         result[i] = 8'h55;
+      end
+      ///the comparison at the threshold
+      original1[W + 1] = THRESH;
+      original1[W + 2] = THRESH - 1;
+      invocations = 0;
+      completed = 0;
+      errors = 0;
+
+      @(negedge clk) rst = 1'b0;
+      for(y = 1; y < H - 1; y = y + 1)
+         for(x = 1; x < W - 1; x = x + 1)
+         begin
+            @(negedge clk);
+            in_valid = 1'b1;
+            v = y;
+            h = x;
+            invocations = invocations + 1;
+         end
+      @(negedge clk) in_valid = 1'b0;
+      repeat(4) @(negedge clk);
+
+      for(y = 0; y < H; y = y + 1)
+         for(x = 0; x < W; x = x + 1)
+         begin
+            i = y * W + x;
+            if (x == 0 || y == 0 || x == W - 1 || y == H - 1)
+               expected = 8'h55;
+            else
+               expected = original1[i] < THRESH ? 8'd0 : 8'd255;
+            if (result[i] !== expected)
+            begin
+               $display("result[%0d] = %0d, expected %0d", i, result[i], expected);
+               errors = errors + 1;
+            end
+         end
+      if (completed != invocations)
+      begin
+         $display("%0d invocations completed out of %0d", completed, invocations);
+         errors = errors + 1;
+      end
+
+      if (errors == 0) $display("PASSED");
+      else $display("FAILED: %0d errors", errors);
+      $finish;
+   end
+endmodule
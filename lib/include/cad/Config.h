@@ -47,6 +47,9 @@ extern cl::list<std::string> functionNames;
 ///name of the configuration file
 extern cl::opt<std::string> configFile;
 
+///returns true if the function is selected with -function or is called (directly or not) by a selected function
+bool isCalledByKernel(const Function& F);
+
 }
 
 #endif
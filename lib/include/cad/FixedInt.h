@@ -0,0 +1,500 @@
+/**
+ * The MIT License (MIT)
+ * 
+ * Copyright (c) 2013 cad-projects
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+/**
+ * Author: Christian Pilato <christian.pilato@polimi.it>
+ *
+ * Description: Header-only library of bit-accurate integers of any width up to
+ *              64 bits, fixed at compile time with their signedness. The values
+ *              are kept normalized (sign or zero extension of the low Width
+ *              bits) on the smallest native integer type, and every operation
+ *              wraps around as the hardware operator of the same width (two's
+ *              complement), or saturates with the *Sat operations. The
+ *              operations are branch-free (shifts, clamps and selects), so that
+ *              the loops over the lanes of FixedIntVector are vectorized by the
+ *              compiler on the native width.
+ *              Division and remainder by zero return 0, as in the DFG
+ *              interpreter; shifts by at least Width bits return 0 (or the sign).
+ */
+#ifndef CADLIB_FIXEDINT_H
+#define CADLIB_FIXEDINT_H
+
+#include <stdint.h>
+
+namespace cadlib
+{
+
+///native integer type of Bits bits (8, 16, 32 or 64)
+template<unsigned int Bits, bool Signed> struct FixedIntType;
+template<> struct FixedIntType<8, true> { typedef int8_t Type; };
+template<> struct FixedIntType<8, false> { typedef uint8_t Type; };
+template<> struct FixedIntType<16, true> { typedef int16_t Type; };
+template<> struct FixedIntType<16, false> { typedef uint16_t Type; };
+template<> struct FixedIntType<32, true> { typedef int32_t Type; };
+template<> struct FixedIntType<32, false> { typedef uint32_t Type; };
+template<> struct FixedIntType<64, true> { typedef int64_t Type; };
+template<> struct FixedIntType<64, false> { typedef uint64_t Type; };
+
+/// returns the value represented by the low Width bits of X, extended to the type T (UT is its unsigned version)
+template<typename T, typename UT, unsigned int Width>
+inline T fixedWrap(T X)
+{
+   ///arithmetic shift for signed types, logical for unsigned ones
+   return (T)(UT)((UT)X << (sizeof(T) * 8 - Width)) >> (sizeof(T) * 8 - Width);
+}
+
+///operations on a lane of Width bits, stored normalized on the smallest native type: the results are computed on a
+///type of at least 32 bits (no promotion to int) and wrapped on the storage type, so that the compiler keeps the
+///loops over the lanes on the native width; the bitwise operations and the shifts right need no wrapping
+template<unsigned int Width, bool Signed>
+struct FixedIntLane
+{
+   static const unsigned int Bits = Width <= 8 ? 8 : Width <= 16 ? 16 : Width <= 32 ? 32 : 64;
+   static const unsigned int ComputeBits = Bits < 32 ? 32 : Bits;
+   typedef typename FixedIntType<Bits, Signed>::Type Storage;
+   typedef typename FixedIntType<Bits, false>::Type UStorage;
+   typedef typename FixedIntType<ComputeBits, Signed>::Type Compute;
+   typedef typename FixedIntType<ComputeBits, false>::Type UCompute;
+   typedef typename FixedIntType<64, Signed>::Type Value;
+   ///type of the exact sum or difference of two lanes (below 64 bits)
+   typedef typename FixedIntType<(Width < Bits ? Bits : ComputeBits), Signed>::Type Exact;
+
+   static Value getMin()
+   {
+      return Signed ? (Value)(~0ULL << (Width - 1)) : 0;
+   }
+
+   static Value getMax()
+   {
+      return Signed ? (Value)((1ULL << (Width - 1)) - 1) : (Value)(~0ULL >> (64 - Width));
+   }
+
+   /// the low Width bits of X
+   static Storage wrap(UCompute X)
+   {
+      return fixedWrap<Storage, UStorage, Width>((Storage)(UStorage)X);
+   }
+
+   static Storage select(bool C, Storage A, Storage B)
+   {
+      return C ? A : B;
+   }
+
+   static Storage add(Storage A, Storage B) { return wrap((UCompute)A + (UCompute)B); }
+   static Storage sub(Storage A, Storage B) { return wrap((UCompute)A - (UCompute)B); }
+   static Storage mul(Storage A, Storage B) { return wrap((UCompute)A * (UCompute)B); }
+   static Storage neg(Storage A) { return wrap(0 - (UCompute)A); }
+   static Storage bitNot(Storage A) { return wrap(~(UCompute)A); }
+
+   static Storage div(Storage A, Storage B)
+   {
+      ///the divisor 0 is replaced by 1 (result 0), the signed overflow of MIN / -1 wraps around
+      Compute D = select(B == 0, 1, B);
+      bool MinusOne = Signed && D == (Compute)-1;
+      Compute Q = MinusOne ? (Compute)(0 - (UCompute)A) : (Compute)A / (MinusOne ? 1 : D);
+      return select(B == 0, 0, wrap((UCompute)Q));
+   }
+
+   static Storage rem(Storage A, Storage B)
+   {
+      Compute D = select(B == 0 || (Signed && B == (Storage)-1), 1, B);
+      return select(B == 0, 0, (Storage)((Compute)A % D));
+   }
+
+   static Storage shl(Storage A, unsigned int S)
+   {
+      return select(S >= Width, 0, wrap((UCompute)A << (S & (ComputeBits - 1))));
+   }
+
+   /// arithmetic shift for signed formats, logical for unsigned ones
+   static Storage shr(Storage A, unsigned int S)
+   {
+      Storage Shifted = (Storage)((Compute)A >> (S >= Width ? ComputeBits - 1 : S));
+      return select(S >= Width && !Signed, 0, Shifted);
+   }
+
+   /// returns X clamped to the range of the format
+   template<typename T>
+   static Storage clamp(T X)
+   {
+      return (Storage)(X < (T)getMin() ? (T)getMin() : X > (T)getMax() ? (T)getMax() : X);
+   }
+
+   static Storage addSat(Storage A, Storage B)
+   {
+      ///below ComputeBits the sum is exact, on the storage type if narrower than it
+      if (Width < ComputeBits) return clamp((Exact)((Exact)A + (Exact)B));
+      Compute R = (Compute)((UCompute)A + (UCompute)B);
+      if (Signed)
+      {
+         ///the sum exceeds the format, or (Width = ComputeBits) overflows with operands of the same sign
+         bool Overflow = R != fixedWrap<Compute, UCompute, Width>(R) || (Compute)(((Compute)A ^ R) & ((Compute)B ^ R)) < 0;
+         return select(Overflow, (Storage)(A < 0 ? getMin() : getMax()), (Storage)R);
+      }
+      return select((UCompute)R > (UCompute)getMax() || (UCompute)R < (UCompute)A, (Storage)getMax(), (Storage)R);
+   }
+
+   static Storage subSat(Storage A, Storage B)
+   {
+      if (Signed && Width < ComputeBits) return clamp((Exact)((Exact)A - (Exact)B));
+      Compute R = (Compute)((UCompute)A - (UCompute)B);
+      if (Signed)
+      {
+         bool Overflow = R != fixedWrap<Compute, UCompute, Width>(R) || (Compute)(((Compute)A ^ (Compute)B) & ((Compute)A ^ R)) < 0;
+         return select(Overflow, (Storage)(A < 0 ? getMin() : getMax()), (Storage)R);
+      }
+      return select(A < B, 0, (Storage)R);
+   }
+
+   static Storage mulSat(Storage A, Storage B)
+   {
+      ///the product of two operands up to ComputeBits / 2 bits is exact on Compute, up to 32 bits on 64 bits
+      if (2 * Width <= ComputeBits) return clamp<Compute>((Compute)A * (Compute)B);
+      Value X = A, Y = B;
+      Value R = (Value)((uint64_t)X * (uint64_t)Y);
+      bool Overflow;
+      if (Width <= 32)
+         Overflow = R != fixedWrap<Value, uint64_t, Width>(R);
+      else if (Signed)
+      {
+         ///-1 is not a valid divisor for the check (MIN / -1)
+         Value D = X == 0 || X == (Value)-1 ? 1 : X;
+         Overflow = R != fixedWrap<Value, uint64_t, Width>(R) || (X == (Value)-1 ? Y == (Value)(1ULL << 63) : X != 0 && R / D != Y);
+      }
+      else
+         Overflow = R != fixedWrap<Value, uint64_t, Width>(R) || (X != 0 && (uint64_t)R / (uint64_t)X != (uint64_t)Y);
+      return select(Overflow, (Storage)(Signed && ((X < 0) != (Y < 0)) ? getMin() : getMax()), (Storage)R);
+   }
+};
+
+template<unsigned int Width, bool Signed>
+class FixedInt
+{
+   ///the width has to be between 1 and 64 bits
+   typedef char WidthCheck[(Width >= 1 && Width <= 64) ? 1 : -1];
+
+   public:
+
+      typedef FixedIntLane<Width, Signed> Lane;
+      typedef typename Lane::Value Value;
+      typedef typename Lane::Storage Storage;
+
+   private:
+
+      ///normalized value, on the smallest native type
+      Storage V;
+
+      static FixedInt make(Storage X)
+      {
+         FixedInt R;
+         R.V = X;
+         return R;
+      }
+
+   public:
+
+      FixedInt() : V(0) {}
+
+      /// truncates X to Width bits
+      explicit FixedInt(int64_t X) : V(Lane::wrap((typename Lane::UCompute)(uint64_t)X)) {}
+
+      /// converts an integer of another format: extension by the signedness of the source, then truncation
+      template<unsigned int W2, bool S2>
+      explicit FixedInt(const FixedInt<W2, S2>& X) : V(Lane::wrap((typename Lane::UCompute)(uint64_t)X.get())) {}
+
+      Value get() const
+      {
+         return V;
+      }
+
+      static Value getMin()
+      {
+         return Lane::getMin();
+      }
+
+      static Value getMax()
+      {
+         return Lane::getMax();
+      }
+
+      /// returns X clamped to the range of the format
+      static FixedInt saturate(int64_t X)
+      {
+         if (Signed)
+            return make((Storage)(X < (int64_t)getMin() ? getMin() : X > (int64_t)getMax() ? getMax() : (Value)X));
+         return make((Storage)(X < 0 ? 0 : (uint64_t)X > (uint64_t)getMax() ? getMax() : (Value)X));
+      }
+
+      /// converts an integer of another format, clamping its value to the range of this one
+      template<unsigned int W2, bool S2>
+      static FixedInt saturate(const FixedInt<W2, S2>& X)
+      {
+         ///unsigned values beyond the range of int64_t are above the range of every format but the unsigned 64-bit one
+         if (!S2 && (uint64_t)X.get() > (~0ULL >> 1))
+            return make((Storage)(!Signed && Width == 64 ? (Value)X.get() : getMax()));
+         return saturate((int64_t)X.get());
+      }
+
+      FixedInt operator+(const FixedInt& B) const { return make(Lane::add(V, B.V)); }
+      FixedInt operator-(const FixedInt& B) const { return make(Lane::sub(V, B.V)); }
+      FixedInt operator*(const FixedInt& B) const { return make(Lane::mul(V, B.V)); }
+      FixedInt operator/(const FixedInt& B) const { return make(Lane::div(V, B.V)); }
+      FixedInt operator%(const FixedInt& B) const { return make(Lane::rem(V, B.V)); }
+      FixedInt operator&(const FixedInt& B) const { return make(V & B.V); }
+      FixedInt operator|(const FixedInt& B) const { return make(V | B.V); }
+      FixedInt operator^(const FixedInt& B) const { return make(V ^ B.V); }
+      FixedInt operator-() const { return make(Lane::neg(V)); }
+      FixedInt operator~() const { return make(Lane::bitNot(V)); }
+      FixedInt operator<<(unsigned int S) const { return make(Lane::shl(V, S)); }
+      /// arithmetic shift for signed formats, logical for unsigned ones
+      FixedInt operator>>(unsigned int S) const { return make(Lane::shr(V, S)); }
+
+      bool operator==(const FixedInt& B) const { return V == B.V; }
+      bool operator!=(const FixedInt& B) const { return V != B.V; }
+      bool operator<(const FixedInt& B) const { return V < B.V; }
+      bool operator<=(const FixedInt& B) const { return V <= B.V; }
+      bool operator>(const FixedInt& B) const { return V > B.V; }
+      bool operator>=(const FixedInt& B) const { return V >= B.V; }
+
+      FixedInt& operator+=(const FixedInt& B) { return *this = *this + B; }
+      FixedInt& operator-=(const FixedInt& B) { return *this = *this - B; }
+      FixedInt& operator*=(const FixedInt& B) { return *this = *this * B; }
+
+      /// saturating addition
+      static FixedInt addSat(const FixedInt& A, const FixedInt& B) { return make(Lane::addSat(A.V, B.V)); }
+
+      /// saturating subtraction
+      static FixedInt subSat(const FixedInt& A, const FixedInt& B) { return make(Lane::subSat(A.V, B.V)); }
+
+      /// saturating multiplication
+      static FixedInt mulSat(const FixedInt& A, const FixedInt& B) { return make(Lane::mulSat(A.V, B.V)); }
+};
+
+/// vector of N integers of the same format, each one stored on the smallest native type: the operations are loops
+/// over the arrays of lanes, vectorized by the compiler
+template<unsigned int Width, bool Signed, unsigned int N>
+class FixedIntVector
+{
+   public:
+
+      typedef FixedIntLane<Width, Signed> Lane;
+      typedef typename Lane::Storage Storage;
+      typedef typename Lane::UCompute UCompute;
+      typedef FixedInt<Width, Signed> Scalar;
+
+      Storage Lanes[N];
+
+      FixedIntVector()
+      {
+         for(unsigned int i = 0; i < N; i++)
+            Lanes[i] = 0;
+      }
+
+      /// sets every lane to X (truncated to Width bits)
+      explicit FixedIntVector(int64_t X)
+      {
+         Storage S = Lane::wrap((UCompute)(uint64_t)X);
+         for(unsigned int i = 0; i < N; i++)
+            Lanes[i] = S;
+      }
+
+      /// loads N values, truncated to Width bits
+      template<typename T>
+      static FixedIntVector load(const T* Data)
+      {
+         FixedIntVector R;
+         for(unsigned int i = 0; i < N; i++)
+            R.Lanes[i] = Lane::wrap((UCompute)Data[i]);
+         return R;
+      }
+
+      template<typename T>
+      void store(T* Data) const
+      {
+         for(unsigned int i = 0; i < N; i++)
+            Data[i] = (T)Lanes[i];
+      }
+
+      Scalar operator[](unsigned int i) const
+      {
+         return Scalar((int64_t)Lanes[i]);
+      }
+
+      void set(unsigned int i, const Scalar& X)
+      {
+         Lanes[i] = (Storage)X.get();
+      }
+
+      FixedIntVector operator+(const FixedIntVector& B) const
+      {
+         FixedIntVector R;
+         for(unsigned int i = 0; i < N; i++)
+            R.Lanes[i] = Lane::add(Lanes[i], B.Lanes[i]);
+         return R;
+      }
+
+      FixedIntVector operator-(const FixedIntVector& B) const
+      {
+         FixedIntVector R;
+         for(unsigned int i = 0; i < N; i++)
+            R.Lanes[i] = Lane::sub(Lanes[i], B.Lanes[i]);
+         return R;
+      }
+
+      FixedIntVector operator*(const FixedIntVector& B) const
+      {
+         FixedIntVector R;
+         for(unsigned int i = 0; i < N; i++)
+            R.Lanes[i] = Lane::mul(Lanes[i], B.Lanes[i]);
+         return R;
+      }
+
+      FixedIntVector operator/(const FixedIntVector& B) const
+      {
+         FixedIntVector R;
+         for(unsigned int i = 0; i < N; i++)
+            R.Lanes[i] = Lane::div(Lanes[i], B.Lanes[i]);
+         return R;
+      }
+
+      FixedIntVector operator%(const FixedIntVector& B) const
+      {
+         FixedIntVector R;
+         for(unsigned int i = 0; i < N; i++)
+            R.Lanes[i] = Lane::rem(Lanes[i], B.Lanes[i]);
+         return R;
+      }
+
+      FixedIntVector operator&(const FixedIntVector& B) const
+      {
+         FixedIntVector R;
+         for(unsigned int i = 0; i < N; i++)
+            R.Lanes[i] = Lanes[i] & B.Lanes[i];
+         return R;
+      }
+
+      FixedIntVector operator|(const FixedIntVector& B) const
+      {
+         FixedIntVector R;
+         for(unsigned int i = 0; i < N; i++)
+            R.Lanes[i] = Lanes[i] | B.Lanes[i];
+         return R;
+      }
+
+      FixedIntVector operator^(const FixedIntVector& B) const
+      {
+         FixedIntVector R;
+         for(unsigned int i = 0; i < N; i++)
+            R.Lanes[i] = Lanes[i] ^ B.Lanes[i];
+         return R;
+      }
+
+      FixedIntVector operator<<(unsigned int S) const
+      {
+         FixedIntVector R;
+         for(unsigned int i = 0; i < N; i++)
+            R.Lanes[i] = Lane::shl(Lanes[i], S);
+         return R;
+      }
+
+      /// arithmetic shift for signed formats, logical for unsigned ones
+      FixedIntVector operator>>(unsigned int S) const
+      {
+         FixedIntVector R;
+         for(unsigned int i = 0; i < N; i++)
+            R.Lanes[i] = Lane::shr(Lanes[i], S);
+         return R;
+      }
+
+      /// comparisons: each lane of the result is 1 if the condition holds, 0 otherwise
+      FixedIntVector<1, false, N> operator==(const FixedIntVector& B) const
+      {
+         FixedIntVector<1, false, N> R;
+         for(unsigned int i = 0; i < N; i++)
+            R.Lanes[i] = Lanes[i] == B.Lanes[i];
+         return R;
+      }
+
+      FixedIntVector<1, false, N> operator!=(const FixedIntVector& B) const
+      {
+         FixedIntVector<1, false, N> R;
+         for(unsigned int i = 0; i < N; i++)
+            R.Lanes[i] = Lanes[i] != B.Lanes[i];
+         return R;
+      }
+
+      FixedIntVector<1, false, N> operator<(const FixedIntVector& B) const
+      {
+         FixedIntVector<1, false, N> R;
+         for(unsigned int i = 0; i < N; i++)
+            R.Lanes[i] = Lanes[i] < B.Lanes[i];
+         return R;
+      }
+
+      FixedIntVector<1, false, N> operator<=(const FixedIntVector& B) const
+      {
+         FixedIntVector<1, false, N> R;
+         for(unsigned int i = 0; i < N; i++)
+            R.Lanes[i] = Lanes[i] <= B.Lanes[i];
+         return R;
+      }
+
+      FixedIntVector<1, false, N> operator>(const FixedIntVector& B) const { return B < *this; }
+      FixedIntVector<1, false, N> operator>=(const FixedIntVector& B) const { return B <= *this; }
+
+      /// returns the lanes of A where the condition is 1, those of B elsewhere
+      static FixedIntVector select(const FixedIntVector<1, false, N>& C, const FixedIntVector& A, const FixedIntVector& B)
+      {
+         FixedIntVector R;
+         for(unsigned int i = 0; i < N; i++)
+            R.Lanes[i] = C.Lanes[i] ? A.Lanes[i] : B.Lanes[i];
+         return R;
+      }
+
+      static FixedIntVector addSat(const FixedIntVector& A, const FixedIntVector& B)
+      {
+         FixedIntVector R;
+         for(unsigned int i = 0; i < N; i++)
+            R.Lanes[i] = Lane::addSat(A.Lanes[i], B.Lanes[i]);
+         return R;
+      }
+
+      static FixedIntVector subSat(const FixedIntVector& A, const FixedIntVector& B)
+      {
+         FixedIntVector R;
+         for(unsigned int i = 0; i < N; i++)
+            R.Lanes[i] = Lane::subSat(A.Lanes[i], B.Lanes[i]);
+         return R;
+      }
+
+      static FixedIntVector mulSat(const FixedIntVector& A, const FixedIntVector& B)
+      {
+         FixedIntVector R;
+         for(unsigned int i = 0; i < N; i++)
+            R.Lanes[i] = Lane::mulSat(A.Lanes[i], B.Lanes[i]);
+         return R;
+      }
+};
+
+}
+
+#endif
@@ -40,6 +40,21 @@ namespace llvm {
 llvm::Pass *createDfgGenerationPass();
 llvm::Pass *createDfgPrintingPass();
 llvm::Pass *createDetermineBitWidthPass();
+llvm::Pass *createDfgSchedulingPass();
+llvm::Pass *createDfgTimingPass();
+llvm::Pass *createDfgTreeHeightReductionPass();
+llvm::Pass *createDfgStrengthReductionPass();
+llvm::Pass *createDfgStencilPass();
+llvm::Pass *createAffineIndexPass();
+llvm::Pass *createDfgMemoryCoalescingPass();
+llvm::Pass *createDfgMemoryPortsPass();
+llvm::Pass *createDfgInitiationIntervalPass();
+llvm::Pass *createDfgMemoryDependencePass();
+llvm::Pass *createDfgTaskGraphPass();
+llvm::Pass *createDfgIfConversionPass();
+llvm::Pass *createDfgPruningPass();
+llvm::Pass *createDfgValidationPass();
+llvm::Pass *createDfgProfilingPass();
 
 namespace {
    struct CodesignForcePassLinking {
@@ -47,6 +62,21 @@ namespace {
          createDfgGenerationPass();
          createDfgPrintingPass();
          createDetermineBitWidthPass();
+         createDfgSchedulingPass();
+         createDfgTimingPass();
+         createDfgTreeHeightReductionPass();
+         createDfgStrengthReductionPass();
+         createDfgStencilPass();
+         createAffineIndexPass();
+         createDfgMemoryCoalescingPass();
+         createDfgMemoryPortsPass();
+         createDfgInitiationIntervalPass();
+         createDfgMemoryDependencePass();
+         createDfgTaskGraphPass();
+         createDfgIfConversionPass();
+         createDfgPruningPass();
+         createDfgValidationPass();
+         createDfgProfilingPass();
       }
    } CodesignForcePassLinking; // Force link by creating a global definition.
 }
@@ -57,6 +87,21 @@ namespace llvm {
   void initializeDfgGenerationPass(llvm::PassRegistry&);
   void initializeDfgPrintingPass(llvm::PassRegistry&);
   void initializeDetermineBitWidthPass(llvm::PassRegistry&);
+  void initializeDfgSchedulingPass(llvm::PassRegistry&);
+  void initializeDfgTimingPass(llvm::PassRegistry&);
+  void initializeDfgTreeHeightReductionPass(llvm::PassRegistry&);
+  void initializeDfgStrengthReductionPass(llvm::PassRegistry&);
+  void initializeDfgStencilPass(llvm::PassRegistry&);
+  void initializeAffineIndexPass(llvm::PassRegistry&);
+  void initializeDfgMemoryCoalescingPass(llvm::PassRegistry&);
+  void initializeDfgMemoryPortsPass(llvm::PassRegistry&);
+  void initializeDfgInitiationIntervalPass(llvm::PassRegistry&);
+  void initializeDfgMemoryDependencePass(llvm::PassRegistry&);
+  void initializeDfgTaskGraphPass(llvm::PassRegistry&);
+  void initializeDfgIfConversionPass(llvm::PassRegistry&);
+  void initializeDfgPruningPass(llvm::PassRegistry&);
+  void initializeDfgValidationPass(llvm::PassRegistry&);
+  void initializeDfgProfilingPass(llvm::PassRegistry&);
 }
 
 #endif
@@ -34,7 +34,9 @@
 #include "llvm/Support/ToolOutputFile.h"
 
 #include <list>
+#include <map>
 #include <set>
+#include <vector>
 
 using namespace llvm;
 
@@ -55,6 +57,76 @@ void getMemoryOps(const Value* I, std::list<const Value*>& operations);
 
 const Value* getRealValue(const Value *I);
 
+/// the instructions synthesized by the DFG transformations use detached placeholders in place of the values
+/// of the function, so that they do not become users of those values; records that P stands for V (a NULL V
+/// removes the placeholder)
+void setPlaceholder(const Value* P, const Value* V);
+
+/// returns the value of the function represented by a placeholder (the value itself if it is not a placeholder)
+const Value* getOriginalValue(const Value* V);
+
+/// returns the bitwidth of an integer constant, with the same rule of DetermineBitWidth
+unsigned int getConstantWidth(int64_t C);
+
+///polynomial form of an integer expression: a constant plus a sum of coefficient x monomial, where a monomial
+///is a product of variables (e.g., (v-1)*dimh+h-1 = [v*dimh] - [dimh] + [h] - 1)
+struct AffineForm
+{
+      typedef std::vector<const Value*> Monomial;
+
+      ///coefficient of each monomial (the variables of a monomial are sorted)
+      std::map<Monomial, int64_t> Terms;
+
+      int64_t Constant;
+
+      AffineForm() : Constant(0) {}
+
+      /// adds Scale times Other to this form
+      void add(const AffineForm& Other, int64_t Scale);
+
+      /// returns the product of the two forms
+      static AffineForm multiply(const AffineForm& A, const AffineForm& B);
+
+      /// returns the coefficient of the monomial (0 if missing)
+      int64_t getCoefficient(const Monomial& M) const;
+
+      bool isConstant() const
+      {
+         return Terms.empty();
+      }
+
+      bool operator==(const AffineForm& Other) const
+      {
+         return Constant == Other.Constant && Terms == Other.Terms;
+      }
+
+      static std::string getString(const Monomial& M);
+
+      std::string toString() const;
+};
+
+/// computes the polynomial form of an integer value; the values that are not additions, subtractions,
+/// multiplications or shifts by constants are variables. The forms of the subexpressions are stored
+/// in Cache (when given) and reused
+void getAffineForm(const Value* I, AffineForm& Form, std::map<const Value*, AffineForm>* Cache = 0);
+
+/// computes the offset of an address (in elements of the accessed memory); returns false if not supported
+bool getAddressForm(const Value* Ptr, AffineForm& Form, std::map<const Value*, AffineForm>* Cache = 0);
+
+/// returns the number of bytes of a type (integers, pointers and arrays of them; 0 if not supported)
+uint64_t getTypeBytes(const Type* Ty);
+
+/// decomposes an address (getelementptr and bitcast instructions on a parameter or global) into the accessed
+/// memory and the byte stride of each index, from the outermost getelementptr; returns false if not supported
+bool getAddressTerms(const Value* Ptr, const Value*& Memory, std::vector<std::pair<const Value*, uint64_t> >& Terms);
+
+/// returns the name of a parameter or global in the generated code (argN for an unnamed parameter)
+std::string getVarName(const Value* V);
+
+/// returns the basic blocks of the function in reverse post-order; returns false if the control flow has a
+/// cycle (an edge to a block that does not follow its source)
+bool getReversePostOrder(Function* F, std::vector<BasicBlock*>& Blocks);
+
 struct FormattedOutput
 {
       unsigned int IndentNum;
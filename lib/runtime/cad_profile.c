@@ -0,0 +1,103 @@
+/**
+ * The MIT License (MIT)
+ * 
+ * Copyright (c) 2013 cad-projects
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+/**
+ * Author: Christian Pilato <christian.pilato@polimi.it>
+ *
+ * Description: Runtime of the profiling of the values (dfg-profiling). Each
+ *              instrumented value is identified by the address of its name;
+ *              at the exit of the program the observed ranges are written to
+ *              the file in CAD_PROFILE (default profile.txt), one entry per
+ *              value:
+ *                PROFILE <function>.<value> <min> <max> <samples>
+ */
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+struct cad_profile_entry
+{
+   const char* name;
+   int64_t min;
+   int64_t max;
+   uint64_t samples;
+};
+
+static struct cad_profile_entry* cad_profile_table = 0;
+static unsigned int cad_profile_size = 0;
+static unsigned int cad_profile_used = 0;
+
+static void cad_profile_write(void)
+{
+   const char* file_name = getenv("CAD_PROFILE") ? getenv("CAD_PROFILE") : "profile.txt";
+   FILE* file = fopen(file_name, "w");
+   unsigned int i;
+   if (!file) return;
+   for(i = 0; i < cad_profile_size; i++)
+      if (cad_profile_table[i].name)
+         fprintf(file, "PROFILE %s %lld %lld %llu\n", cad_profile_table[i].name, (long long)cad_profile_table[i].min, (long long)cad_profile_table[i].max, (unsigned long long)cad_profile_table[i].samples);
+   fclose(file);
+}
+
+/* returns the entry of the value (open addressing on the address of the name) */
+static struct cad_profile_entry* cad_profile_lookup(const char* name)
+{
+   unsigned int i = (unsigned int)(((uintptr_t)name >> 3) * 2654435761u) & (cad_profile_size - 1);
+   while (cad_profile_table[i].name && cad_profile_table[i].name != name)
+      i = (i + 1) & (cad_profile_size - 1);
+   return &cad_profile_table[i];
+}
+
+static void cad_profile_grow(void)
+{
+   struct cad_profile_entry* old_table = cad_profile_table;
+   unsigned int old_size = cad_profile_size, i;
+   cad_profile_size = old_size ? old_size * 2 : 1024;
+   cad_profile_table = (struct cad_profile_entry*)calloc(cad_profile_size, sizeof(struct cad_profile_entry));
+   if (!cad_profile_table)
+   {
+      fprintf(stderr, "cad_profile: out of memory\n");
+      exit(1);
+   }
+   for(i = 0; i < old_size; i++)
+      if (old_table[i].name)
+         *cad_profile_lookup(old_table[i].name) = old_table[i];
+   free(old_table);
+   if (!old_size) atexit(cad_profile_write);
+}
+
+void cad_profile_value(const char* name, int64_t value)
+{
+   struct cad_profile_entry* entry;
+   if (2 * (cad_profile_used + 1) > cad_profile_size) cad_profile_grow();
+   entry = cad_profile_lookup(name);
+   if (!entry->name)
+   {
+      entry->name = name;
+      entry->min = value;
+      entry->max = value;
+      cad_profile_used++;
+   }
+   if (value < entry->min) entry->min = value;
+   if (value > entry->max) entry->max = value;
+   entry->samples++;
+}
@@ -0,0 +1,129 @@
+/**
+ * The MIT License (MIT)
+ * 
+ * Copyright (c) 2013 cad-projects
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+/**
+ * Author: Christian Pilato <christian.pilato@polimi.it>
+ *
+ * Description: Implementation of the affine canonicalization of the addresses.
+ *              The form of each GEP and of each pointer accessed by a load or a
+ *              store is computed once; the forms of the index subexpressions
+ *              are cached per value, so shared subexpressions (e.g. v*dimh)
+ *              are decomposed only once.
+ */
+#include "AffineIndex.h"
+
+#include "cad/Config.h"
+
+#define DEBUG_TYPE "affine-index"
+#include "llvm/Instructions.h"
+#include "llvm/Support/raw_ostream.h"
+#include "llvm/ADT/Statistic.h"
+
+STATISTIC(AffineAddresses, "[CAD] Number of addresses in affine form");
+
+using namespace llvm;
+using namespace cadlib;
+
+char AffineIndex::ID = 0;
+static const char affine_index_name[] = "[CAD] Affine canonicalization of the addresses";
+INITIALIZE_PASS(AffineIndex, DEBUG_TYPE, affine_index_name, false, true)
+
+void AffineIndex::getAnalysisUsage(AnalysisUsage &AU) const
+{
+   AU.setPreservesAll();
+}
+
+Pass* createAffineIndexPass() {
+   return new AffineIndex;
+}
+
+bool AffineIndex::runOnFunction(Function &F)
+{
+   if (std::find(functionNames.begin(), functionNames.end(), F.getName()) == functionNames.end())
+      return false;
+
+   errs() << "Affine Index: #" << F.getName() << "#\n";
+   for (Function::iterator b = F.begin(), be = F.end(); b != be; b++)
+   {
+      for (BasicBlock::iterator i = b->begin(), ie = b->end(); i != ie; i++)
+      {
+         Instruction& I = *i;
+         if (dyn_cast<GetElementPtrInst>(&I))
+            computeAddress(&I);
+         else if (dyn_cast<LoadInst>(&I))
+            computeAddress(dyn_cast<LoadInst>(&I)->getPointerOperand());
+         else if (dyn_cast<StoreInst>(&I))
+            computeAddress(dyn_cast<StoreInst>(&I)->getPointerOperand());
+      }
+   }
+   errs() << " - " << Addresses.size() << " affine addresses, " << Forms.size() << " index expressions\n";
+   errs() << "##\n\n";
+   return false;
+}
+
+void AffineIndex::computeAddress(const Value* Ptr)
+{
+   if (Addresses.find(Ptr) != Addresses.end()) return;
+   AffineForm Form;
+   if (!getAddressForm(Ptr, Form, &Forms)) return;
+   Addresses[Ptr] = Form;
+   ++AffineAddresses;
+}
+
+void AffineIndex::releaseMemory()
+{
+   Forms.clear();
+   Addresses.clear();
+}
+
+const AffineForm* AffineIndex::getAddress(const Value* Ptr) const
+{
+   std::map<const Value*, AffineForm>::const_iterator a = Addresses.find(Ptr);
+   if (a == Addresses.end()) return NULL;
+   return &a->second;
+}
+
+const AffineForm& AffineIndex::getForm(const Value* I)
+{
+   AffineForm Form;
+   getAffineForm(I, Form, &Forms);
+   return Forms.find(getRealValue(I))->second;
+}
+
+int64_t AffineIndex::getStride(const Value* Ptr, const Value* Var) const
+{
+   const AffineForm* Form = getAddress(Ptr);
+   if (!Form) return 0;
+   return Form->getCoefficient(AffineForm::Monomial(1, Var));
+}
+
+bool AffineIndex::getDistance(const Value* Ptr0, const Value* Ptr1, int64_t& Distance) const
+{
+   const AffineForm* Form0 = getAddress(Ptr0);
+   const AffineForm* Form1 = getAddress(Ptr1);
+   if (!Form0 || !Form1 || getMemoryVar(Ptr0) != getMemoryVar(Ptr1)) return false;
+   AffineForm Diff = *Form1;
+   Diff.add(*Form0, -1);
+   if (!Diff.isConstant()) return false;
+   Distance = Diff.Constant;
+   return true;
+}
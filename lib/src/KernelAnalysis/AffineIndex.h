@@ -0,0 +1,77 @@
+/**
+ * The MIT License (MIT)
+ * 
+ * Copyright (c) 2013 cad-projects
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+/**
+ * Author: Christian Pilato <christian.pilato@polimi.it>
+ *
+ * Description: This class defines the pass computing the canonical affine form
+ *              (constant plus sum of coefficient x monomial) of the addresses
+ *              of the function, cached for the analyses of the accesses
+ */
+#ifndef AFFINEINDEX_H
+#define AFFINEINDEX_H
+
+#include "cad/Support.h"
+
+#include "llvm/Pass.h"
+#include "llvm/Function.h"
+
+#include <map>
+
+namespace llvm {
+
+  // AffineIndex
+  struct AffineIndex : public FunctionPass {
+    static char ID; // Pass identification, replacement for typeid
+    AffineIndex() : FunctionPass(ID) {}
+
+    virtual bool runOnFunction(Function &F);
+
+    void getAnalysisUsage(AnalysisUsage &AU) const;
+
+    virtual void releaseMemory();
+
+    /// returns the form of the address, in elements of the accessed memory (NULL if it is not affine)
+    const cadlib::AffineForm* getAddress(const Value* Ptr) const;
+
+    /// returns the form of an integer value, computing it if it is not cached
+    const cadlib::AffineForm& getForm(const Value* I);
+
+    /// returns the stride of the address with respect to the variable (0 if not affine)
+    int64_t getStride(const Value* Ptr, const Value* Var) const;
+
+    /// returns true if the two addresses access the same memory at a constant distance (Ptr1 - Ptr0)
+    bool getDistance(const Value* Ptr0, const Value* Ptr1, int64_t& Distance) const;
+
+    private:
+
+      void computeAddress(const Value* Ptr);
+
+      ///forms of the integer values (index expressions and their subexpressions)
+      std::map<const Value*, cadlib::AffineForm> Forms;
+
+      ///forms of the affine addresses
+      std::map<const Value*, cadlib::AffineForm> Addresses;
+  };
+}
+
+#endif
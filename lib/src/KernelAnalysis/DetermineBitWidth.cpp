@@ -24,6 +24,9 @@
  * Author: Christian Pilato <christian.pilato@polimi.it>
  *
  * Description: Implementation of methods to compute minimal bitwidth of operations.
+ *              The ranges observed by the dfg-profiling runtime can be used to
+ *              bound the parameters and the phi nodes (-bitwidth-profile-hint)
+ *              and are compared with the computed widths.
  */
 #include "DetermineBitWidth.h"
 
@@ -32,15 +35,25 @@
 #include "llvm/ADT/Statistic.h"
 #include "llvm/Constants.h"
 #include "llvm/Instructions.h"
+#include "llvm/Support/CommandLine.h"
 #include "llvm/Support/raw_ostream.h"
 #include "llvm/Transforms/Utils/BasicBlockUtils.h"
 
 #include <fstream>
 #include <list>
+#include <sstream>
 
 using namespace llvm;
 using namespace cadlib;
 
+static cl::opt<std::string> bitwidthProfile("bitwidth-profile",
+  cl::desc("[CAD] Ranges of the values observed by the profiling (dfg-profiling)"),
+  cl::value_desc("file"));
+
+static cl::opt<bool> bitwidthProfileHint("bitwidth-profile-hint",
+  cl::desc("[CAD] Bound the width of the scalar parameters and of the phi nodes with the profiled ranges"),
+  cl::init(false));
+
 char DetermineBitWidth::ID = 0;
 #define DEBUG_TYPE "determine-bitwidth"
 static const char determine_bitwidth_name[] = "[CAD] Determine data bitwidth";
@@ -68,9 +81,9 @@ void DetermineBitWidth::parseConfig(const std::string& funName, const std::strin
          {
             std::string substring = line.substr(line.find_first_of(" ")+1,line.size());
             std::string Name = substring.substr(0, substring.find_first_of(" "));
-            std::string FuncName = Name.substr(0, Name.find_first_of("."));
-            std::string VarName = Name.substr(Name.find_first_of(".")+1,Name.size());
-            if (FuncName != funName) continue;
+            ///the name of the function may contain dots too (e.g., "kernel.1")
+            if (Name.compare(0, funName.size() + 1, funName + ".") != 0) continue;
+            std::string VarName = Name.substr(funName.size() + 1);
             unsigned int size = atoi(substring.substr(substring.find_first_of(" ")+1,substring.size()).c_str());
             parameterSize[VarName] = size;
             errs() << "#" << VarName << "# -> size = " << size << "\n";
@@ -80,6 +93,60 @@ void DetermineBitWidth::parseConfig(const std::string& funName, const std::strin
    }
 }
 
+void DetermineBitWidth::parseProfile(const std::string& funName, const std::string& profileFile)
+{
+   std::string line;
+   std::ifstream myfile(profileFile.c_str());
+   if (!myfile.is_open())
+   {
+      errs() << "WARNING: profile " << profileFile << " not available\n";
+      return;
+   }
+   while (getline(myfile, line))
+   {
+      std::istringstream iss(line);
+      std::string Key, Name;
+      int64_t Min = 0, Max = 0;
+      if (!(iss >> Key >> Name >> Min >> Max) || Key != "PROFILE") continue;
+      ///the entry is "<function>.<value>", as emitted by the profiling
+      if (Name.compare(0, funName.size() + 1, funName + ".") != 0) continue;
+      profileRange[Name.substr(funName.size() + 1)] = std::make_pair(Min, Max);
+   }
+   myfile.close();
+}
+
+unsigned int DetermineBitWidth::getProfileWidth(const Value* I) const
+{
+   if (!I->hasName()) return 0;
+   std::map<std::string, std::pair<int64_t, int64_t> >::const_iterator It = profileRange.find(I->getName().str());
+   if (It == profileRange.end()) return 0;
+   return std::max(getConstantWidth(It->second.first), getConstantWidth(It->second.second));
+}
+
+void DetermineBitWidth::checkProfile(Function& F)
+{
+   std::vector<const Value*> Values;
+   for(Function::const_arg_iterator A = F.arg_begin(); A != F.arg_end(); A++)
+      Values.push_back(&*A);
+   for(Function::const_iterator b = F.begin(); b != F.end(); b++)
+      for(BasicBlock::const_iterator i = b->begin(); i != b->end(); i++)
+         Values.push_back(&*i);
+   unsigned int Profiled = 0, Exceeded = 0;
+   for(unsigned int v = 0; v < Values.size(); v++)
+   {
+      unsigned int Observed = getProfileWidth(Values[v]);
+      if (!Observed || !hasBitWidth(Values[v])) continue;
+      Profiled++;
+      ///the static width does not cover the observed values
+      if (Observed > getBitWidth(Values[v]))
+      {
+         errs() << "WARNING: #" << Values[v]->getName() << "# size = " << getBitWidth(Values[v]) << " exceeded by the profile (" << Observed << " bits)\n";
+         Exceeded++;
+      }
+   }
+   errs() << "profiled values = " << Profiled << ", exceeding the static size = " << Exceeded << "\n";
+}
+
 unsigned int DetermineBitWidth::getBitWidth(const Value* I) const
 {
    assert(bitWidth.find(I) != bitWidth.end() && "missing value");
@@ -93,7 +160,8 @@ bool DetermineBitWidth::hasBitWidth(const Value *I) const
 
 bool DetermineBitWidth::runOnFunction(Function &F)
 {
-   if (std::find(functionNames.begin(), functionNames.end(), F.getName()) == functionNames.end())
+   ///the functions called by the kernels are analyzed as well, to be referenced by the call nodes
+   if (!isCalledByKernel(F))
       return false;
 
    errs() << "Determine bit width: #" << F.getName() << "#\n";
@@ -102,6 +170,11 @@ bool DetermineBitWidth::runOnFunction(Function &F)
    {
       parseConfig(F.getName(), configFile);
    }
+   profileRange.clear();
+   if (bitwidthProfile.size())
+   {
+      parseProfile(F.getName(), bitwidthProfile);
+   }
 
    bool Modified = false;
    std::list<Value*> WorkList;
@@ -151,6 +224,8 @@ bool DetermineBitWidth::runOnFunction(Function &F)
       Argument& A = *p;
       errs() << A << " -> Size = " << bitWidth[&A] << "\n";
    }
+   if (profileRange.size())
+      checkProfile(F);
 
    errs() << "##\n\n";
    return Modified;
@@ -206,6 +281,9 @@ bool DetermineBitWidth::processInstruction(const Value* I)
       else if (bitWidth.find(I) == bitWidth.end())
       {
          bitWidth[I] = getDataSize(I, I->getType(), false);
+         ///the observed range is a hint, not a bound valid for every input
+         if (bitwidthProfileHint && getProfileWidth(I))
+            bitWidth[I] = std::min(bitWidth[I], getProfileWidth(I));
       }
       return false;
    }
@@ -313,6 +391,17 @@ bool DetermineBitWidth::processInstruction(const Value* I)
          bitWidth[I] = bit;
          return Modified;
       }
+      case Instruction::PHI:
+      {
+         ///the values carried across the iterations of a loop are not bounded by their initial value
+         const PHINode* P = dyn_cast<PHINode>(I);
+         for(unsigned int i = 0; i < P->getNumIncomingValues(); i++)
+            if (dyn_cast<ConstantInt>(P->getIncomingValue(i))) processInstruction(P->getIncomingValue(i));
+         bitWidth[I] = getDataSize(I, I->getType(), false);
+         if (bitwidthProfileHint && getProfileWidth(I))
+            bitWidth[I] = std::min(bitWidth[I], getProfileWidth(I));
+         return false;
+      }
       case Instruction::Trunc:
       case Instruction::ZExt:
       {
@@ -326,7 +415,37 @@ bool DetermineBitWidth::processInstruction(const Value* I)
          if (dyn_cast<ReturnInst>(I)->getReturnValue())
          {
             Modified = processInstruction(dyn_cast<ReturnInst>(I)->getReturnValue());
+            bitWidth[I] = bitWidth[dyn_cast<ReturnInst>(I)->getReturnValue()];
+         }
+         return Modified;
+      }
+      case Instruction::Call:
+      {
+         const CallInst* Call = dyn_cast<CallInst>(I);
+         bool Modified = false;
+         for(unsigned int a = 0; a < Call->getNumArgOperands(); a++)
+            Modified |= processInstruction(Call->getArgOperand(a));
+         if (Call->getType()->isVoidTy())
+         {
+            bitWidth[I] = 0;
+            return Modified;
+         }
+         ///the width of the returned values, if the callee has been already analyzed
+         unsigned int bit = 0;
+         const Function* Callee = Call->getCalledFunction();
+         if (Callee)
+         {
+            for(Function::const_iterator b = Callee->begin(); b != Callee->end(); b++)
+            {
+               const ReturnInst* Ret = dyn_cast<ReturnInst>(b->getTerminator());
+               if (!Ret || !Ret->getReturnValue() || bitWidth.find(Ret->getReturnValue()) == bitWidth.end()) continue;
+               bit = std::max(bit, bitWidth[Ret->getReturnValue()]);
+            }
          }
+         if (!bit) bit = getDataSize(I, I->getType(), false);
+         if ((bitWidth.find(I) != bitWidth.end()) && (bitWidth[I] < bit))
+            Modified = true;
+         bitWidth[I] = bit;
          return Modified;
       }
       case Instruction::Br:
@@ -339,6 +458,13 @@ bool DetermineBitWidth::processInstruction(const Value* I)
          bitWidth[I] = 0;
          return Modified;
       }
+      case Instruction::Switch:
+      {
+         ///one-hot encoding of the outcome: one bit per case plus the default
+         bool Modified = processInstruction(dyn_cast<SwitchInst>(I)->getCondition());
+         bitWidth[I] = dyn_cast<SwitchInst>(I)->getNumCases() + 1;
+         return Modified;
+      }
       default:
       {
          errs() << "not supported = " << In->getOpcodeName() << "\n";
@@ -50,6 +50,13 @@ struct DetermineBitWidth : public FunctionPass {
       std::map<std::string, unsigned int> parameterSize;
       void parseConfig(const std::string& funName, const std::string &configFile);
 
+      ///observed range (min, max) of the values of the function, from the profile written by the dfg-profiling runtime
+      std::map<std::string, std::pair<int64_t, int64_t> > profileRange;
+      void parseProfile(const std::string& funName, const std::string& profileFile);
+
+      /// returns the width of the observed range of the value (0 if it has not been profiled)
+      unsigned int getProfileWidth(const Value* I) const;
+
       unsigned int getDataSize(const Value *I, const Type *Ty, bool checkBitwidth);
       Type* changeDataSize(Value* I, Type *Ty, unsigned int Size);
 
@@ -61,6 +68,9 @@ struct DetermineBitWidth : public FunctionPass {
 
       std::map<const Value*, unsigned int> bitWidth;
 
+      /// reports the values whose static width is smaller than the observed one
+      void checkProfile(Function& F);
+
 };
 }
 
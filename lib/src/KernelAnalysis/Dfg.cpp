@@ -29,17 +29,21 @@
 #include "cad/Config.h"
 
 #include "Dfg.h"
+#include "DfgPredicates.h"
+#include "DfgReachability.h"
 
 #include "llvm/Constants.h"
+#include "llvm/Function.h"
 #include "llvm/Instructions.h"
 #include "llvm/Support/raw_ostream.h"
 
+#include <algorithm>
 #include <sstream>
 
 using namespace llvm;
 using namespace cadlib;
 
-DfgNode::DfgNode(const Value* NewOp, unsigned int width) : Op(NewOp), Type(INSTRUCTION), Width(width)
+DfgNode::DfgNode(const Value* NewOp, unsigned int width) : Op(NewOp), Id(0), Level(0), Predicate(DfgPredicates::Always), Type(INSTRUCTION), Callee(0), Width(width)
 {
    if (dyn_cast<Argument>(Op))
    {
@@ -62,6 +66,7 @@ DfgNode::DfgNode(const Value* NewOp, unsigned int width) : Op(NewOp), Type(INSTR
 
    if (dyn_cast<StoreInst>(Op)) Type = STORE;
    if (dyn_cast<LoadInst>(Op)) Type = LOAD;
+   if (dyn_cast<CallInst>(Op)) Type = CALL;
 
 }
 
@@ -70,6 +75,11 @@ unsigned DfgNode::getWidth() const
    return Width;
 }
 
+bool DfgNode::hasValue() const
+{
+   return !dyn_cast<StoreInst>(Op) && !dyn_cast<TerminatorInst>(Op) && !Op->getType()->isVoidTy() && !dyn_cast<Argument>(Op);
+}
+
 std::string DfgNode::getName() const
 {
    if (dyn_cast<ConstantInt>(Op))
@@ -124,6 +134,27 @@ std::string DfgNode::getName() const
          const Value* val = dyn_cast<LoadInst>(Op)->getPointerOperand();
          return /*Op->getName().str() + */" [ load: " + getMemoryString(val) + "]";
       }
+      case Instruction::PHI:
+      {
+         return Op->getName().str() + " = {phi}";
+      }
+      case Instruction::Call:
+      {
+         const Function* Callee = dyn_cast<CallInst>(Op)->getCalledFunction();
+         return "[ call: " + (Callee ? Callee->getName().str() : std::string("<indirect>")) + "]";
+      }
+      case Instruction::Ret:
+      {
+         return "[ return ]";
+      }
+      case Instruction::Select:
+      {
+         return "[ mux ]";
+      }
+      case Instruction::Switch:
+      {
+         return "[ switch: " + dyn_cast<SwitchInst>(Op)->getCondition()->getName().str() + "]";
+      }
       case Instruction::GetElementPtr:
       {
          const Value* val = dyn_cast<GetElementPtrInst>(Op)->getPointerOperand();
@@ -132,6 +163,9 @@ std::string DfgNode::getName() const
       case Instruction::Add:
       case Instruction::AShr:
       case Instruction::ICmp:
+      case Instruction::Shl:
+      case Instruction::LShr:
+      case Instruction::Or:
       case Instruction::Mul:
       case Instruction::SDiv:
       case Instruction::Sub:
@@ -148,8 +182,26 @@ std::string DfgNode::getName() const
    return dyn_cast<Instruction>(Op)->getOpcodeName();
 }
 
-DfgGraph::DfgGraph(const std::string& Name) : FunctionName(Name) {
+DfgGraph::DfgGraph(const std::string& Name) : FunctionName(Name), LevelBegin(1, 0), Acyclic(true), Reachability(0), Predicates(new DfgPredicates) {
+
+}
 
+DfgGraph::~DfgGraph()
+{
+   delete Reachability;
+   delete Predicates;
+   for(unsigned int i = 0; i < Nodes.size(); i++)
+      delete Nodes[i];
+   ///synthesized instructions may use each other
+   for(unsigned int i = 0; i < Synthesized.size(); i++)
+      Synthesized[i]->dropAllReferences();
+   for(unsigned int i = 0; i < Synthesized.size(); i++)
+      delete Synthesized[i];
+   for(std::map<const Value*, Value*>::iterator p = Placeholders.begin(); p != Placeholders.end(); p++)
+   {
+      setPlaceholder(p->second, NULL);
+      delete p->second;
+   }
 }
 
 const std::vector<DfgNode*>& DfgGraph::getNodes() const
@@ -186,12 +238,118 @@ DfgNode* DfgGraph::getNode(const Value* Op, unsigned int Width, unsigned int bb)
    if (nodeMap.find(Op) != nodeMap.end()) return nodeMap.find(Op)->second;
    DfgNode* dn = new DfgNode(Op, Width);
    if (dn->Type == DfgNode::IN_PARAM || dn->Type == DfgNode::OUT_PARAM) bb = 0;
+   dn->Id = Nodes.size();
    bbNodes[bb].push_back(Op);
    Nodes.push_back(dn);
    nodeMap[Op] = dn;
    return dn;
 }
 
+DfgNode* DfgGraph::createNode(Instruction* I, unsigned int Width, unsigned int bb, const Value* Before)
+{
+   assert(!I->getParent() && nodeMap.find(I) == nodeMap.end() && "instruction already in the program");
+   Synthesized.push_back(I);
+   DfgNode* dn = new DfgNode(I, Width);
+   dn->Id = Nodes.size();
+   std::vector<const Value*>& bbValues = bbNodes[bb];
+   bbValues.insert(std::find(bbValues.begin(), bbValues.end(), Before), I);
+   Nodes.push_back(dn);
+   nodeMap[I] = dn;
+   return dn;
+}
+
+void DfgGraph::addSynthesized(Instruction* I)
+{
+   assert(!I->getParent() && "instruction already in the program");
+   Synthesized.push_back(I);
+}
+
+Value* DfgGraph::getPlaceholder(Value* V)
+{
+   if (getOriginalValue(V) != V) return V;
+   const Instruction* I = dyn_cast<Instruction>(V);
+   if (I ? !I->getParent() : !dyn_cast<Argument>(V) && !dyn_cast<GlobalValue>(V)) return V;
+   std::map<const Value*, Value*>::iterator p = Placeholders.find(V);
+   if (p != Placeholders.end()) return p->second;
+   ///a detached argument of the same type and name, which does not appear in the use list of V
+   Value* P = new Argument(V->getType(), V->getName());
+   setPlaceholder(P, V);
+   Placeholders[V] = P;
+   return P;
+}
+
+void DfgGraph::moveNode(DfgNode* N, unsigned int bb, const Value* Before)
+{
+   for(std::map<unsigned int, std::vector<const Value*> >::iterator b = bbNodes.begin(); b != bbNodes.end(); b++)
+      b->second.erase(std::remove(b->second.begin(), b->second.end(), N->Op), b->second.end());
+   std::vector<const Value*>& bbValues = bbNodes[bb];
+   bbValues.insert(std::find(bbValues.begin(), bbValues.end(), Before), N->Op);
+}
+
+void DfgGraph::replaceNodes(const std::map<DfgNode*, DfgNode*>& Replacement)
+{
+   if (Replacement.empty()) return;
+
+   std::set<const Value*> Replaced;
+   for(std::map<DfgNode*, DfgNode*>::const_iterator r = Replacement.begin(); r != Replacement.end(); r++)
+   {
+      assert(Replacement.find(r->second) == Replacement.end() && "replacing with a replaced node");
+      Replaced.insert(r->first->Op);
+   }
+
+   std::vector<DfgNode*> Kept;
+   Kept.reserve(Nodes.size());
+   for(unsigned int i = 0; i < Nodes.size(); i++)
+   {
+      if (Replacement.find(Nodes[i]) != Replacement.end()) continue;
+      Kept.push_back(Nodes[i]);
+      std::vector<DfgNode*>& Uses = Nodes[i]->UseNodes;
+      for(unsigned int u = 0; u < Uses.size(); u++)
+      {
+         std::map<DfgNode*, DfgNode*>::const_iterator r = Replacement.find(Uses[u]);
+         if (r == Replacement.end()) continue;
+         assert(r->second && "removing a used node");
+         Uses[u] = r->second;
+      }
+      std::vector<DfgNode::Carried_t>& Carried = Nodes[i]->CarriedNodes;
+      for(unsigned int c = 0; c < Carried.size(); c++)
+      {
+         std::map<DfgNode*, DfgNode*>::const_iterator r = Replacement.find(Carried[c].first);
+         if (r == Replacement.end()) continue;
+         assert(r->second && "removing a loop-carried value");
+         Carried[c].first = r->second;
+      }
+   }
+   Nodes.swap(Kept);
+   std::vector<unsigned int> PredicateIndex = Predicates->replaceConditions(Replacement);
+   for(unsigned int i = 0; i < Nodes.size(); i++)
+      Nodes[i]->Predicate = PredicateIndex[Nodes[i]->Predicate];
+   for(std::map<unsigned int, unsigned int>::iterator b = BlockPredicates.begin(); b != BlockPredicates.end(); b++)
+      b->second = PredicateIndex[b->second];
+
+   for(std::map<const Value*, DfgNode*>::iterator n = nodeMap.begin(); n != nodeMap.end();)
+   {
+      std::map<DfgNode*, DfgNode*>::const_iterator r = Replacement.find(n->second);
+      if (r == Replacement.end())
+         n++;
+      else if (r->second)
+         (n++)->second = r->second;
+      else
+         nodeMap.erase(n++);
+   }
+
+   for(std::map<unsigned int, std::vector<const Value*> >::iterator bb = bbNodes.begin(); bb != bbNodes.end(); bb++)
+   {
+      std::vector<const Value*> Values;
+      for(unsigned int v = 0; v < bb->second.size(); v++)
+         if (Replaced.find(bb->second[v]) == Replaced.end()) Values.push_back(bb->second[v]);
+      bb->second.swap(Values);
+   }
+
+   for(std::map<DfgNode*, DfgNode*>::const_iterator r = Replacement.begin(); r != Replacement.end(); r++)
+      delete r->first;
+}
+
 const std::vector<const Value*>& DfgGraph::getBbNode(unsigned int bb) const
 {
    return bbNodes.find(bb)->second;
@@ -208,3 +366,204 @@ unsigned int DfgGraph::getWidth(const Value* I) const
    assert(bitWidth.find(I) != bitWidth.end() && "Malformed bitwidth");
    return bitWidth.find(I)->second;
 }
+
+bool DfgGraph::hasWidth(const Value* V) const
+{
+   return isNode(V) || bitWidth.find(V) != bitWidth.end();
+}
+
+int DfgGraph::getLoop(unsigned int bb) const
+{
+   int Innermost = -1;
+   for(unsigned int l = 0; l < Loops.size(); l++)
+   {
+      if (std::find(Loops[l].Blocks.begin(), Loops[l].Blocks.end(), bb) == Loops[l].Blocks.end()) continue;
+      if (Innermost < 0 || Loops[l].Depth > Loops[Innermost].Depth) Innermost = l;
+   }
+   return Innermost;
+}
+
+unsigned int DfgGraph::getBlockPredicate(unsigned int bb) const
+{
+   std::map<unsigned int, unsigned int>::const_iterator p = BlockPredicates.find(bb);
+   return p == BlockPredicates.end() ? DfgPredicates::Always : p->second;
+}
+
+bool DfgGraph::isOutputUse(const DfgNode* User, const DfgNode* Used)
+{
+   return Used->Type == DfgNode::OUT_PARAM && (User->Type == DfgNode::STORE || User->Type == DfgNode::CALL);
+}
+
+void DfgGraph::finalize()
+{
+   delete Reachability;
+   Reachability = 0;
+
+   unsigned int NumNodes = Nodes.size();
+   std::vector<unsigned int> OutDegree(NumNodes, 0);
+   std::vector<unsigned int> InDegree(NumNodes, 0);
+   for(unsigned int i = 0; i < NumNodes; i++)
+   {
+      Nodes[i]->Id = i;
+      Nodes[i]->DefinitionNodes.clear();
+   }
+   for(unsigned int i = 0; i < NumNodes; i++)
+   {
+      const std::vector<DfgNode*>& Uses = Nodes[i]->UseNodes;
+      for(unsigned int u = 0; u < Uses.size(); u++)
+      {
+         Uses[u]->DefinitionNodes.push_back(Nodes[i]);
+         DfgNode* Src = isOutputUse(Nodes[i], Uses[u]) ? Nodes[i] : Uses[u];
+         DfgNode* Tgt = isOutputUse(Nodes[i], Uses[u]) ? Uses[u] : Nodes[i];
+         OutDegree[Src->Id]++;
+         InDegree[Tgt->Id]++;
+      }
+   }
+
+   SuccBegin.assign(NumNodes + 1, 0);
+   PredBegin.assign(NumNodes + 1, 0);
+   for(unsigned int i = 0; i < NumNodes; i++)
+   {
+      SuccBegin[i+1] = SuccBegin[i] + OutDegree[i];
+      PredBegin[i+1] = PredBegin[i] + InDegree[i];
+   }
+   Succ.resize(SuccBegin[NumNodes]);
+   Pred.resize(PredBegin[NumNodes]);
+   std::vector<unsigned int> NextSucc(SuccBegin.begin(), SuccBegin.end() - 1);
+   std::vector<unsigned int> NextPred(PredBegin.begin(), PredBegin.end() - 1);
+   for(unsigned int i = 0; i < NumNodes; i++)
+   {
+      const std::vector<DfgNode*>& Uses = Nodes[i]->UseNodes;
+      for(unsigned int u = 0; u < Uses.size(); u++)
+      {
+         DfgNode* Src = isOutputUse(Nodes[i], Uses[u]) ? Nodes[i] : Uses[u];
+         DfgNode* Tgt = isOutputUse(Nodes[i], Uses[u]) ? Uses[u] : Nodes[i];
+         Succ[NextSucc[Src->Id]++] = Tgt;
+         Pred[NextPred[Tgt->Id]++] = Src;
+      }
+   }
+
+   ///Kahn's algorithm: the level of a node is the longest path from a source
+   std::vector<DfgNode*> Order;
+   Order.reserve(NumNodes);
+   for(unsigned int i = 0; i < NumNodes; i++)
+   {
+      Nodes[i]->Level = 0;
+      if (InDegree[i] == 0) Order.push_back(Nodes[i]);
+   }
+   unsigned int NumLevels = 0;
+   for(unsigned int o = 0; o < Order.size(); o++)
+   {
+      DfgNode* N = Order[o];
+      NumLevels = std::max(NumLevels, N->Level + 1);
+      for(node_iterator s = succ_begin(N); s != succ_end(N); s++)
+      {
+         (*s)->Level = std::max((*s)->Level, N->Level + 1);
+         if (--InDegree[(*s)->Id] == 0) Order.push_back(*s);
+      }
+   }
+   Acyclic = Order.size() == NumNodes;
+   if (!Acyclic)
+   {
+      errs() << "WARNING: cyclic dependences in the DFG of " << FunctionName << "\n";
+      ///nodes on a cycle are placed in an additional last level
+      for(unsigned int i = 0; i < NumNodes; i++)
+      {
+         if (InDegree[i] == 0) continue;
+         Nodes[i]->Level = NumLevels;
+         Order.push_back(Nodes[i]);
+      }
+      NumLevels++;
+   }
+
+   ///counting sort by level, so that each level is a contiguous range
+   LevelBegin.assign(NumLevels + 1, 0);
+   for(unsigned int i = 0; i < NumNodes; i++)
+      LevelBegin[Nodes[i]->Level+1]++;
+   for(unsigned int l = 0; l < NumLevels; l++)
+      LevelBegin[l+1] += LevelBegin[l];
+   TopologicalOrder.resize(NumNodes);
+   std::vector<unsigned int> Next(LevelBegin.begin(), LevelBegin.end() - 1);
+   for(unsigned int o = 0; o < Order.size(); o++)
+      TopologicalOrder[Next[Order[o]->Level]++] = Order[o];
+}
+
+const std::vector<DfgNode*>& DfgGraph::getTopologicalOrder() const
+{
+   return TopologicalOrder;
+}
+
+void DfgGraph::getEvaluationOrder(std::map<unsigned int, std::vector<DfgNode*> >& Order) const
+{
+   std::vector<unsigned int> Position(Nodes.size(), 0);
+   for(unsigned int n = 0; n < TopologicalOrder.size(); n++)
+      Position[TopologicalOrder[n]->Id] = n;
+
+   Order.clear();
+   for(std::map<unsigned int, std::vector<const Value*> >::const_iterator b = bbNodes.begin(); b != bbNodes.end(); b++)
+   {
+      if (b->first == 0) continue;
+      ///number of the predecessors of each node that are not evaluated yet; the DFG has no edges between the
+      ///memory accesses, so each access also waits for the previous access of the basic block
+      std::map<const DfgNode*, unsigned int> Pending;
+      std::map<const DfgNode*, DfgNode*> NextAccess;
+      DfgNode* LastAccess = NULL;
+      for(unsigned int v = 0; v < b->second.size(); v++)
+      {
+         if (!isNode(b->second[v])) continue;
+         DfgNode* N = getNode(b->second[v]);
+         if (N->Op != b->second[v] || !dyn_cast<Instruction>(N->Op) || dyn_cast<PHINode>(N->Op) || Pending.count(N)) continue;
+         Pending[N] = 0;
+         if (N->Type != DfgNode::LOAD && N->Type != DfgNode::STORE && N->Type != DfgNode::CALL) continue;
+         if (LastAccess)
+         {
+            NextAccess[LastAccess] = N;
+            Pending[N]++;
+         }
+         LastAccess = N;
+      }
+      for(std::map<const DfgNode*, unsigned int>::iterator p = Pending.begin(); p != Pending.end(); p++)
+         for(node_iterator i = pred_begin(p->first); i != pred_end(p->first); i++)
+            if (Pending.count(*i)) p->second++;
+
+      ///Kahn's algorithm, the ready node first in topological order is evaluated first
+      std::set<std::pair<unsigned int, DfgNode*> > Ready;
+      for(std::map<const DfgNode*, unsigned int>::iterator p = Pending.begin(); p != Pending.end(); p++)
+         if (p->second == 0) Ready.insert(std::make_pair(Position[p->first->Id], const_cast<DfgNode*>(p->first)));
+      std::vector<DfgNode*>& Block = Order[b->first];
+      while (!Ready.empty())
+      {
+         DfgNode* N = Ready.begin()->second;
+         Ready.erase(Ready.begin());
+         Block.push_back(N);
+         std::vector<DfgNode*> Released(succ_begin(N), succ_end(N));
+         if (NextAccess.count(N)) Released.push_back(NextAccess[N]);
+         for(unsigned int r = 0; r < Released.size(); r++)
+            if (Pending.count(Released[r]) && --Pending[Released[r]] == 0)
+               Ready.insert(std::make_pair(Position[Released[r]->Id], Released[r]));
+      }
+      ///the nodes on a cycle of the DFG follow in topological order
+      if (Block.size() < Pending.size())
+      {
+         std::vector<std::pair<unsigned int, DfgNode*> > Cyclic;
+         for(std::map<const DfgNode*, unsigned int>::iterator p = Pending.begin(); p != Pending.end(); p++)
+            if (p->second > 0) Cyclic.push_back(std::make_pair(Position[p->first->Id], const_cast<DfgNode*>(p->first)));
+         std::sort(Cyclic.begin(), Cyclic.end());
+         for(unsigned int c = 0; c < Cyclic.size(); c++)
+            Block.push_back(Cyclic[c].second);
+      }
+      if (Block.empty()) Order.erase(b->first);
+   }
+}
+
+const DfgReachability& DfgGraph::getReachability() const
+{
+   assert(SuccBegin.size() == Nodes.size() + 1 && "DFG not finalized");
+   if (!Reachability) Reachability = new DfgReachability(*this);
+   return *Reachability;
+}
+
+bool DfgGraph::reaches(const DfgNode* From, const DfgNode* To) const
+{
+   return getReachability().reaches(From, To);
+}
@@ -40,7 +40,10 @@ namespace llvm {
 class Value;
 class Instruction;
 class DfgNode;
+class DfgGraph;
 class BasicBlock;
+class DfgReachability;
+class DfgPredicates;
 
 struct DfgNode
 {
@@ -51,6 +54,7 @@ struct DfgNode
       INOUT_PARAM,
       LOAD,
       STORE,
+      CALL,
       INSTRUCTION
    } Type_t;
 
@@ -63,11 +67,24 @@ struct DfgNode
    } Control_t;
 
    const Value* Op;
+   ///dense index of the node inside the graph (position in DfgGraph::getNodes())
+   unsigned int Id;
+   ///ASAP level of the node (longest dependence path from a source), set by DfgGraph::finalize()
+   unsigned int Level;
+   ///nodes using this node (reverse of UseNodes), set by DfgGraph::finalize()
    std::vector<DfgNode*> DefinitionNodes;
+   ///nodes used by this node
    std::vector<DfgNode*> UseNodes;
+   ///outcome of a branch: condition node, edge and bit of the one-hot outcome of a switch (literal of the predicates)
    typedef std::tr1::tuple<DfgNode*, Control_t, unsigned int> Condition_t;
-   std::vector<Condition_t> ControlNodes;
+   ///execution condition of the node, index in the predicate table of the graph (DfgPredicates::Always if unconditional)
+   unsigned int Predicate;
+   ///loop-carried dependences: values of a previous iteration (at the given distance) used by this node
+   typedef std::pair<DfgNode*, unsigned int> Carried_t;
+   std::vector<Carried_t> CarriedNodes;
    Type_t Type;
+   ///DFG of the called function (CALL nodes), NULL if not available
+   DfgGraph* Callee;
 
    DfgNode(const Value* NewOp, unsigned int width);
 
@@ -75,12 +92,27 @@ struct DfgNode
 
    unsigned getWidth() const;
 
+   /// returns true if the node has a value (not a store, a terminator, a void call or a parameter)
+   bool hasValue() const;
+
    private:
 
       unsigned int Width;
 
 };
 
+///natural loop of the function, with the basic blocks identified by their index
+struct DfgLoop
+{
+   unsigned int Header;
+   ///nesting depth (1 for the outermost loops)
+   unsigned int Depth;
+   ///position of the enclosing loop in DfgGraph::getLoops() (-1 for the outermost loops)
+   int Parent;
+   bool Innermost;
+   std::vector<unsigned int> Blocks;
+};
+
 class DfgGraph
 {
 
@@ -97,11 +129,40 @@ class DfgGraph
       std::map<BasicBlock*, unsigned int> bbMap;
       std::map<unsigned int, BasicBlock*> bbReverseMap;
 
+      ///dependence edges in compressed form (data flows from a predecessor to its successors)
+      std::vector<DfgNode*> Succ;
+      std::vector<unsigned int> SuccBegin;
+      std::vector<DfgNode*> Pred;
+      std::vector<unsigned int> PredBegin;
+
+      ///nodes in topological order, sorted by level
+      std::vector<DfgNode*> TopologicalOrder;
+      std::vector<unsigned int> LevelBegin;
+      bool Acyclic;
+
+      ///transitive-dependence index, built on the first reachability query
+      mutable DfgReachability* Reachability;
+
+      ///instructions synthesized by the DFG transformations (not inserted in the function)
+      std::vector<Instruction*> Synthesized;
+      ///placeholders of the values of the function used by the synthesized instructions
+      std::map<const Value*, Value*> Placeholders;
+
+      ///loops of the function, each one after its enclosing loop
+      std::vector<DfgLoop> Loops;
+
+      ///execution conditions of the nodes
+      DfgPredicates* Predicates;
+      ///execution condition of each basic block (index in the predicate table)
+      std::map<unsigned int, unsigned int> BlockPredicates;
+
       friend class DfgGeneration;
    public:
 
       DfgGraph(const std::string& Name);
 
+      ~DfgGraph();
+
       std::string getFunctionName() const {
          return FunctionName;
       }
@@ -112,6 +173,25 @@ class DfgGraph
 
       bool isNode(const Value* Op) const;
 
+      /// creates the node of an instruction synthesized by a DFG transformation; the graph takes the
+      /// ownership of I, whose node is placed in the basic block bb before the value Before (at the end if NULL)
+      DfgNode* createNode(Instruction* I, unsigned int Width, unsigned int bb, const Value* Before);
+
+      /// the graph takes the ownership of an instruction synthesized by a DFG transformation, that is not a node
+      void addSynthesized(Instruction* I);
+
+      /// returns the operand to be used in place of V by an instruction synthesized by a DFG transformation: the
+      /// values of the function are replaced by placeholders owned by the graph (see cadlib::getOriginalValue),
+      /// the constants and the synthesized instructions are used directly
+      Value* getPlaceholder(Value* V);
+
+      /// moves the node to the basic block bb, before the value Before (at the end if NULL)
+      void moveNode(DfgNode* N, unsigned int bb, const Value* Before);
+
+      /// replaces each node of the map with the associated one, or removes it if the associated node is NULL;
+      /// the values represented by a replaced node are then represented by the new one. The graph has to be finalized again
+      void replaceNodes(const std::map<DfgNode*, DfgNode*>& Replacement);
+
       const std::vector<DfgNode*>& getNodes() const;
 
       const std::vector<const Value*>& getBbNode(unsigned int bb) const;
@@ -124,6 +204,87 @@ class DfgGraph
 
       unsigned int getWidth(const Value*) const;
 
+      /// returns true if the width of the value is known (nodes and index computations)
+      bool hasWidth(const Value* V) const;
+
+      const std::vector<DfgLoop>& getLoops() const {
+         return Loops;
+      }
+
+      /// returns the position in getLoops() of the innermost loop containing the basic block (-1 if none)
+      int getLoop(unsigned int bb) const;
+
+      DfgPredicates& getPredicates() {
+         return *Predicates;
+      }
+
+      const DfgPredicates& getPredicates() const {
+         return *Predicates;
+      }
+
+      /// returns the execution condition of the basic block (index in the predicate table)
+      unsigned int getBlockPredicate(unsigned int bb) const;
+
+      /// returns true if the use of Used by User is an output (i.e., data flows from User to Used)
+      static bool isOutputUse(const DfgNode* User, const DfgNode* Used);
+
+      /// computes adjacency, topological order and levels; to be called once the graph is complete
+      void finalize();
+
+      bool isAcyclic() const {
+         return Acyclic;
+      }
+
+      typedef std::vector<DfgNode*>::const_iterator node_iterator;
+
+      node_iterator succ_begin(const DfgNode* N) const {
+         return Succ.begin() + SuccBegin[N->Id];
+      }
+
+      node_iterator succ_end(const DfgNode* N) const {
+         return Succ.begin() + SuccBegin[N->Id+1];
+      }
+
+      node_iterator pred_begin(const DfgNode* N) const {
+         return Pred.begin() + PredBegin[N->Id];
+      }
+
+      node_iterator pred_end(const DfgNode* N) const {
+         return Pred.begin() + PredBegin[N->Id+1];
+      }
+
+      unsigned int getFanIn(const DfgNode* N) const {
+         return PredBegin[N->Id+1] - PredBegin[N->Id];
+      }
+
+      unsigned int getFanOut(const DfgNode* N) const {
+         return SuccBegin[N->Id+1] - SuccBegin[N->Id];
+      }
+
+      const std::vector<DfgNode*>& getTopologicalOrder() const;
+
+      /// returns the non-phi instruction nodes of each basic block in an evaluation order: the nodes follow the
+      /// topological order, except that the loads, stores and calls of a basic block keep their program order
+      void getEvaluationOrder(std::map<unsigned int, std::vector<DfgNode*> >& Order) const;
+
+      unsigned int getNumLevels() const {
+         return LevelBegin.size() - 1;
+      }
+
+      /// nodes of level L are in the range [getLevelBegin(L), getLevelEnd(L))
+      node_iterator getLevelBegin(unsigned int L) const {
+         return TopologicalOrder.begin() + LevelBegin[L];
+      }
+
+      node_iterator getLevelEnd(unsigned int L) const {
+         return TopologicalOrder.begin() + LevelBegin[L+1];
+      }
+
+      const DfgReachability& getReachability() const;
+
+      /// returns true if there is a (non-empty) dependence path from From to To
+      bool reaches(const DfgNode* From, const DfgNode* To) const;
+
 };
 
 }
@@ -0,0 +1,469 @@
+/**
+ * The MIT License (MIT)
+ * 
+ * Copyright (c) 2013 cad-projects
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+/**
+ * Author: Christian Pilato <christian.pilato@polimi.it>
+ *
+ * Description: Implementation of the batched DFG interpreter. When the control
+ *              flow of the function is acyclic and there are no calls, the basic
+ *              blocks are visited once in reverse post-order: the active lanes of
+ *              a block are those that take one of its incoming edges, the phi
+ *              nodes select the value of the edge taken by each lane and every
+ *              node is evaluated with a loop over the lanes (the loads gather
+ *              and the stores scatter only the active lanes). The other functions
+ *              are executed one lane at a time by the DfgInterpreter.
+ */
+#include "DfgBatchInterpreter.h"
+
+#include "cad/Support.h"
+
+#include "llvm/BasicBlock.h"
+#include "llvm/Constants.h"
+#include "llvm/DerivedTypes.h"
+#include "llvm/Function.h"
+#include "llvm/Instructions.h"
+#include "llvm/Support/CFG.h"
+
+#include <algorithm>
+
+using namespace llvm;
+using namespace cadlib;
+
+DfgBatchInterpreter::DfgBatchInterpreter(DfgGraph* G, unsigned int Lanes) : Graph(G), MaxLanes(Lanes), Batched(true), Values(G->getNodes().size() * Lanes, 0), Scalar(NULL), ScratchUsed(0), NumEvaluated(0), NumErrors(0)
+{
+   std::vector<BasicBlock*> RPO;
+   Batched = getReversePostOrder(Graph->getBasicBlock(1)->getParent(), RPO);
+   for(unsigned int b = 0; b < RPO.size(); b++)
+      Blocks.push_back(std::make_pair(RPO[b], Graph->getBbIdx(RPO[b])));
+
+   Graph->getEvaluationOrder(Order);
+   const std::vector<DfgNode*>& Nodes = Graph->getNodes();
+   for(unsigned int n = 0; n < Nodes.size(); n++)
+   {
+      DfgNode* N = Nodes[n];
+      if (N->Type == DfgNode::CALL) Batched = false;
+      if (const ConstantInt* C = dyn_cast<ConstantInt>(N->Op))
+         setScalar(N->Op, C->getBitWidth() == 1 ? (int64_t)C->getZExtValue() : C->getSExtValue());
+   }
+   unsigned int NumBlocks = 0;
+   for(unsigned int b = 0; b < Blocks.size(); b++)
+      NumBlocks = std::max(NumBlocks, Blocks[b].second + 1);
+   Active.resize(NumBlocks * MaxLanes, 0);
+
+   if (!Batched) Scalar = new DfgInterpreter(Graph);
+}
+
+DfgBatchInterpreter::~DfgBatchInterpreter()
+{
+   delete Scalar;
+}
+
+void DfgBatchInterpreter::setScalar(const Value* Param, int64_t V)
+{
+   if (Scalar) Scalar->setScalar(Param, V);
+   LaneValues.erase(Param);
+   if (!Graph->isNode(Param)) return;
+   const DfgNode* N = Graph->getNode(Param);
+   int64_t* R = getLanes(N);
+   V = DfgInterpreter::wrap(V, N->getWidth());
+   for(unsigned int l = 0; l < MaxLanes; l++)
+      R[l] = V;
+}
+
+void DfgBatchInterpreter::setLanes(const Value* Param, const int64_t* V, unsigned int Lanes)
+{
+   if (Scalar) LaneValues[Param].assign(V, V + Lanes);
+   if (!Graph->isNode(Param)) return;
+   const DfgNode* N = Graph->getNode(Param);
+   int64_t* R = getLanes(N);
+   for(unsigned int l = 0; l < Lanes; l++)
+      R[l] = DfgInterpreter::wrap(V[l], N->getWidth());
+}
+
+void DfgBatchInterpreter::bindMemory(const Value* Memory, unsigned char* Data, uint64_t Size)
+{
+   if (Scalar) Scalar->bindMemory(Memory, Data, Size);
+   DfgInterpreter::Buffer B;
+   B.Data = Data;
+   B.Size = Size;
+   Memories[Memory] = B;
+}
+
+uint64_t DfgBatchInterpreter::getNumEvaluated() const
+{
+   return NumEvaluated + (Scalar ? Scalar->getNumEvaluated() : 0);
+}
+
+unsigned int DfgBatchInterpreter::getNumErrors() const
+{
+   return NumErrors + (Scalar ? Scalar->getNumErrors() : 0);
+}
+
+int64_t* DfgBatchInterpreter::getScratch()
+{
+   if (ScratchUsed == Scratch.size()) Scratch.push_back(std::vector<int64_t>(MaxLanes, 0));
+   return &Scratch[ScratchUsed++][0];
+}
+
+/// computes the lanes of a binary operation, returns the number of lanes of Mask (all if NULL) dividing by zero
+static unsigned int compute(const BinaryOperator* B, const int64_t* Op0, const int64_t* Op1, int64_t* R, const unsigned char* Mask, unsigned int Lanes)
+{
+   unsigned int Width = DfgInterpreter::getTypeWidth(B);
+   unsigned int Errors = 0;
+   switch(B->getOpcode())
+   {
+      case Instruction::Add:
+         for(unsigned int l = 0; l < Lanes; l++) R[l] = Op0[l] + Op1[l];
+         break;
+      case Instruction::Sub:
+         for(unsigned int l = 0; l < Lanes; l++) R[l] = Op0[l] - Op1[l];
+         break;
+      case Instruction::Mul:
+         for(unsigned int l = 0; l < Lanes; l++) R[l] = Op0[l] * Op1[l];
+         break;
+      case Instruction::And:
+         for(unsigned int l = 0; l < Lanes; l++) R[l] = Op0[l] & Op1[l];
+         break;
+      case Instruction::Or:
+         for(unsigned int l = 0; l < Lanes; l++) R[l] = Op0[l] | Op1[l];
+         break;
+      case Instruction::Xor:
+         for(unsigned int l = 0; l < Lanes; l++) R[l] = Op0[l] ^ Op1[l];
+         break;
+      case Instruction::Shl:
+         for(unsigned int l = 0; l < Lanes; l++) R[l] = Op1[l] >= 64 ? 0 : (int64_t)((uint64_t)Op0[l] << Op1[l]);
+         break;
+      case Instruction::AShr:
+         for(unsigned int l = 0; l < Lanes; l++) R[l] = Op1[l] >= 64 ? (Op0[l] < 0 ? -1 : 0) : Op0[l] >> Op1[l];
+         break;
+      case Instruction::LShr:
+         for(unsigned int l = 0; l < Lanes; l++) R[l] = Op1[l] >= 64 ? 0 : (int64_t)(DfgInterpreter::mask(Op0[l], Width) >> Op1[l]);
+         break;
+      case Instruction::SDiv:
+      case Instruction::SRem:
+      case Instruction::UDiv:
+      case Instruction::URem:
+      {
+         for(unsigned int l = 0; l < Lanes; l++)
+         {
+            if (Op1[l] == 0)
+            {
+               ///the inactive lanes may divide by zero
+               if (!Mask || Mask[l]) Errors++;
+               R[l] = 0;
+            }
+            else if (B->getOpcode() == Instruction::SDiv)
+               R[l] = Op0[l] / Op1[l];
+            else if (B->getOpcode() == Instruction::SRem)
+               R[l] = Op0[l] % Op1[l];
+            else if (B->getOpcode() == Instruction::UDiv)
+               R[l] = DfgInterpreter::mask(Op0[l], Width) / DfgInterpreter::mask(Op1[l], Width);
+            else
+               R[l] = DfgInterpreter::mask(Op0[l], Width) % DfgInterpreter::mask(Op1[l], Width);
+         }
+         break;
+      }
+      default:
+         assert(0 && "Operation not supported by the interpreter");
+   }
+   return Errors;
+}
+
+const int64_t* DfgBatchInterpreter::getOperand(const Value* V, unsigned int Lanes)
+{
+   V = getOriginalValue(V);
+   if (Graph->isNode(V)) return getLanes(Graph->getNode(V));
+   if (const ConstantInt* C = dyn_cast<ConstantInt>(V))
+   {
+      int64_t* R = getScratch();
+      int64_t K = C->getBitWidth() == 1 ? (int64_t)C->getZExtValue() : C->getSExtValue();
+      for(unsigned int l = 0; l < Lanes; l++)
+         R[l] = K;
+      return R;
+   }
+   if (const CastInst* C = dyn_cast<CastInst>(V))
+   {
+      const int64_t* Op = getOperand(C->getOperand(0), Lanes);
+      if (!dyn_cast<ZExtInst>(C) && !dyn_cast<SExtInst>(C) && !dyn_cast<TruncInst>(C)) return Op;
+      int64_t* R = getScratch();
+      if (dyn_cast<ZExtInst>(C))
+      {
+         unsigned int Width = DfgInterpreter::getTypeWidth(C->getOperand(0));
+         for(unsigned int l = 0; l < Lanes; l++)
+            R[l] = DfgInterpreter::mask(Op[l], Width);
+      }
+      else
+      {
+         unsigned int Width = DfgInterpreter::getTypeWidth(dyn_cast<SExtInst>(C) ? C->getOperand(0) : C);
+         for(unsigned int l = 0; l < Lanes; l++)
+            R[l] = DfgInterpreter::wrap(Op[l], Width);
+      }
+      return R;
+   }
+   ///index computations that are not nodes, truncated to their width
+   if (const BinaryOperator* B = dyn_cast<BinaryOperator>(V))
+   {
+      const int64_t* Op0 = getOperand(B->getOperand(0), Lanes);
+      const int64_t* Op1 = getOperand(B->getOperand(1), Lanes);
+      int64_t* R = getScratch();
+      compute(B, Op0, Op1, R, NULL, Lanes);
+      unsigned int Width = Graph->hasWidth(B) ? Graph->getWidth(B) : DfgInterpreter::getTypeWidth(B);
+      for(unsigned int l = 0; l < Lanes; l++)
+         R[l] = DfgInterpreter::wrap(R[l], Width);
+      return R;
+   }
+   ///undefined values and parameters that are not used by the DFG
+   int64_t* R = getScratch();
+   std::fill(R, R + Lanes, 0);
+   return R;
+}
+
+bool DfgBatchInterpreter::getOffsets(const Value* Ptr, DfgInterpreter::Buffer& B, int64_t* Offsets, unsigned int Lanes)
+{
+   const Value* Memory = NULL;
+   std::vector<std::pair<const Value*, uint64_t> > Terms;
+   if (!getAddressTerms(Ptr, Memory, Terms) || Memories.find(Memory) == Memories.end()) return false;
+   B = Memories[Memory];
+   std::fill(Offsets, Offsets + Lanes, 0);
+   for(unsigned int t = 0; t < Terms.size(); t++)
+   {
+      int64_t Stride = Terms[t].second;
+      const int64_t* Index = getOperand(Terms[t].first, Lanes);
+      for(unsigned int l = 0; l < Lanes; l++)
+         Offsets[l] += Index[l] * Stride;
+   }
+   return true;
+}
+
+void DfgBatchInterpreter::getEdgeMask(BasicBlock* From, BasicBlock* To, std::vector<unsigned char>& Mask, unsigned int Lanes)
+{
+   const unsigned char* Source = &Active[Graph->getBbIdx(From) * MaxLanes];
+   Mask.assign(Source, Source + MaxLanes);
+   ScratchUsed = 0;
+   const TerminatorInst* T = From->getTerminator();
+   if (const BranchInst* Br = dyn_cast<BranchInst>(T))
+   {
+      if (Br->isUnconditional() || Br->getSuccessor(0) == Br->getSuccessor(1)) return;
+      const int64_t* Condition = getOperand(Br->getCondition(), Lanes);
+      bool True = Br->getSuccessor(0) == To;
+      for(unsigned int l = 0; l < Lanes; l++)
+         Mask[l] &= (unsigned char)((Condition[l] & 1) == (True ? 1 : 0));
+   }
+   else if (const SwitchInst* Sw = dyn_cast<SwitchInst>(T))
+   {
+      const int64_t* Condition = getOperand(Sw->getCondition(), Lanes);
+      unsigned int Width = DfgInterpreter::getTypeWidth(Sw->getCondition());
+      for(unsigned int l = 0; l < Lanes; l++)
+      {
+         const BasicBlock* Dest = Sw->getDefaultDest();
+         for(SwitchInst::ConstCaseIt c = Sw->case_begin(); c != Sw->case_end(); ++c)
+            if (c.getCaseValue()->getSExtValue() == DfgInterpreter::wrap(Condition[l], Width))
+               Dest = c.getCaseSuccessor();
+         Mask[l] &= (unsigned char)(Dest == To);
+      }
+   }
+}
+
+void DfgBatchInterpreter::evaluate(DfgNode* N, const unsigned char* Mask, unsigned int Lanes)
+{
+   const Instruction* I = dyn_cast<Instruction>(N->Op);
+   int64_t* R = getLanes(N);
+   ///the operands are computed in the scratch lanes, reused by each evaluation
+   ScratchUsed = 0;
+   if (const BinaryOperator* B = dyn_cast<BinaryOperator>(I))
+   {
+      const int64_t* Op0 = getOperand(B->getOperand(0), Lanes);
+      const int64_t* Op1 = getOperand(B->getOperand(1), Lanes);
+      NumErrors += compute(B, Op0, Op1, R, Mask, Lanes);
+   }
+   else if (const ICmpInst* C = dyn_cast<ICmpInst>(I))
+   {
+      const int64_t* Op0 = getOperand(C->getOperand(0), Lanes);
+      const int64_t* Op1 = getOperand(C->getOperand(1), Lanes);
+      ///the unsigned comparisons compare the zero-extended operands
+      if (C->isUnsigned())
+      {
+         unsigned int Width = DfgInterpreter::getTypeWidth(C->getOperand(0));
+         for(unsigned int l = 0; l < Lanes; l++)
+         {
+            uint64_t A = DfgInterpreter::mask(Op0[l], Width), B = DfgInterpreter::mask(Op1[l], Width);
+            R[l] = A < B ? -1 : (A > B ? 1 : 0);
+         }
+      }
+      else
+      {
+         for(unsigned int l = 0; l < Lanes; l++)
+            R[l] = Op0[l] < Op1[l] ? -1 : (Op0[l] > Op1[l] ? 1 : 0);
+      }
+      ///R holds the sign of the difference, converted to the outcome of the comparison
+      switch(C->getPredicate())
+      {
+         case CmpInst::ICMP_EQ:
+            for(unsigned int l = 0; l < Lanes; l++) R[l] = R[l] == 0;
+            break;
+         case CmpInst::ICMP_NE:
+            for(unsigned int l = 0; l < Lanes; l++) R[l] = R[l] != 0;
+            break;
+         case CmpInst::ICMP_SGT:
+         case CmpInst::ICMP_UGT:
+            for(unsigned int l = 0; l < Lanes; l++) R[l] = R[l] > 0;
+            break;
+         case CmpInst::ICMP_SGE:
+         case CmpInst::ICMP_UGE:
+            for(unsigned int l = 0; l < Lanes; l++) R[l] = R[l] >= 0;
+            break;
+         case CmpInst::ICMP_SLT:
+         case CmpInst::ICMP_ULT:
+            for(unsigned int l = 0; l < Lanes; l++) R[l] = R[l] < 0;
+            break;
+         case CmpInst::ICMP_SLE:
+         case CmpInst::ICMP_ULE:
+            for(unsigned int l = 0; l < Lanes; l++) R[l] = R[l] <= 0;
+            break;
+         default:
+            assert(0 && "Predicate not supported by the interpreter");
+      }
+   }
+   else if (const SelectInst* S = dyn_cast<SelectInst>(I))
+   {
+      const int64_t* Condition = getOperand(S->getCondition(), Lanes);
+      const int64_t* Op0 = getOperand(S->getTrueValue(), Lanes);
+      const int64_t* Op1 = getOperand(S->getFalseValue(), Lanes);
+      for(unsigned int l = 0; l < Lanes; l++)
+         R[l] = (Condition[l] & 1) ? Op0[l] : Op1[l];
+   }
+   else if (const CastInst* C = dyn_cast<CastInst>(I))
+   {
+      const int64_t* Op = getOperand(C->getOperand(0), Lanes);
+      unsigned int Width = dyn_cast<ZExtInst>(C) ? DfgInterpreter::getTypeWidth(C->getOperand(0)) : 64;
+      for(unsigned int l = 0; l < Lanes; l++)
+         R[l] = DfgInterpreter::mask(Op[l], Width);
+   }
+   else if (const LoadInst* L = dyn_cast<LoadInst>(I))
+   {
+      ///gather of the active lanes
+      DfgInterpreter::Buffer B;
+      uint64_t Bytes = DfgInterpreter::getTypeBytes(L->getType());
+      int64_t* Offsets = getScratch();
+      bool Bound = getOffsets(L->getPointerOperand(), B, Offsets, Lanes);
+      for(unsigned int l = 0; l < Lanes; l++)
+      {
+         R[l] = 0;
+         if (!Mask[l]) continue;
+         if (!Bound || Offsets[l] < 0 || (uint64_t)Offsets[l] + Bytes > B.Size)
+         {
+            NumErrors++;
+            continue;
+         }
+         for(unsigned int b = 0; b < Bytes; b++)
+            R[l] |= (int64_t)B.Data[Offsets[l] + b] << (8 * b);
+      }
+   }
+   else if (const StoreInst* St = dyn_cast<StoreInst>(I))
+   {
+      ///scatter of the active lanes
+      DfgInterpreter::Buffer B;
+      uint64_t Bytes = DfgInterpreter::getTypeBytes(St->getValueOperand()->getType());
+      int64_t* Offsets = getScratch();
+      bool Bound = getOffsets(St->getPointerOperand(), B, Offsets, Lanes);
+      const int64_t* V = getOperand(St->getValueOperand(), Lanes);
+      for(unsigned int l = 0; l < Lanes; l++)
+      {
+         R[l] = 0;
+         if (!Mask[l]) continue;
+         if (!Bound || Offsets[l] < 0 || (uint64_t)Offsets[l] + Bytes > B.Size)
+         {
+            NumErrors++;
+            continue;
+         }
+         for(unsigned int b = 0; b < Bytes; b++)
+            B.Data[Offsets[l] + b] = (unsigned char)(V[l] >> (8 * b));
+      }
+   }
+   else
+      ///branches, switches and returns: the control flow is handled by run()
+      std::fill(R, R + Lanes, 0);
+
+   unsigned int Width = N->getWidth();
+   for(unsigned int l = 0; l < Lanes; l++)
+      R[l] = DfgInterpreter::wrap(R[l], Width);
+}
+
+void DfgBatchInterpreter::run(unsigned int Lanes)
+{
+   assert(Lanes <= MaxLanes && "too many lanes");
+   if (!Batched)
+   {
+      for(unsigned int l = 0; l < Lanes; l++)
+      {
+         for(std::map<const Value*, std::vector<int64_t> >::iterator p = LaneValues.begin(); p != LaneValues.end(); p++)
+            Scalar->setScalar(p->first, p->second[l]);
+         Scalar->run();
+      }
+      return;
+   }
+
+   std::vector<unsigned char> Mask;
+   for(unsigned int b = 0; b < Blocks.size(); b++)
+   {
+      BasicBlock* BB = Blocks[b].first;
+      unsigned char* A = &Active[Blocks[b].second * MaxLanes];
+      if (b == 0)
+         std::fill(A, A + Lanes, 1);
+      else
+      {
+         std::fill(A, A + Lanes, 0);
+         for(pred_iterator p = pred_begin(BB); p != pred_end(BB); p++)
+         {
+            getEdgeMask(*p, BB, Mask, Lanes);
+            for(unsigned int l = 0; l < Lanes; l++)
+               A[l] |= Mask[l];
+         }
+      }
+      unsigned int Count = 0;
+      for(unsigned int l = 0; l < Lanes; l++)
+         Count += A[l];
+      if (!Count) continue;
+
+      ///the phi nodes take the value of the edge taken by each lane
+      for(BasicBlock::iterator i = BB->begin(); dyn_cast<PHINode>(&*i); i++)
+      {
+         const PHINode* P = dyn_cast<PHINode>(&*i);
+         if (!Graph->isNode(P) || Graph->getNode(P)->Op != P) continue;
+         DfgNode* N = Graph->getNode(P);
+         int64_t* R = getLanes(N);
+         for(unsigned int v = 0; v < P->getNumIncomingValues(); v++)
+         {
+            getEdgeMask(P->getIncomingBlock(v), BB, Mask, Lanes);
+            const int64_t* V = getOperand(P->getIncomingValue(v), Lanes);
+            for(unsigned int l = 0; l < Lanes; l++)
+               R[l] = Mask[l] ? DfgInterpreter::wrap(V[l], N->getWidth()) : R[l];
+         }
+         NumEvaluated += Count;
+      }
+
+      std::vector<DfgNode*>& Nodes = Order[Blocks[b].second];
+      for(unsigned int n = 0; n < Nodes.size(); n++)
+         evaluate(Nodes[n], A, Lanes);
+      NumEvaluated += (uint64_t)Nodes.size() * Count;
+   }
+}
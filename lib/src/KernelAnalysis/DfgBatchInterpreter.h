@@ -0,0 +1,137 @@
+/**
+ * The MIT License (MIT)
+ * 
+ * Copyright (c) 2013 cad-projects
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+/**
+ * Author: Christian Pilato <christian.pilato@polimi.it>
+ *
+ * Description: This file defines the batched interpreter of a DFG: each node is
+ *              evaluated for a vector of invocations of the function at once
+ *              (one lane per invocation, the values of a node are contiguous)
+ */
+#ifndef DFGBATCHINTERPRETER_H
+#define DFGBATCHINTERPRETER_H
+
+#include "DfgInterpreter.h"
+
+#include <deque>
+#include <map>
+#include <vector>
+
+namespace llvm {
+
+class BasicBlock;
+
+class DfgBatchInterpreter
+{
+
+   private:
+
+      DfgGraph* Graph;
+
+      ///maximum number of invocations of a batch
+      unsigned int MaxLanes;
+
+      ///true if the lanes can be evaluated together (acyclic control flow without calls)
+      bool Batched;
+
+      ///values of the lanes of each node: node n uses [n * MaxLanes, (n + 1) * MaxLanes)
+      std::vector<int64_t> Values;
+
+      ///basic blocks in reverse post-order, with their index in the DFG
+      std::vector<std::pair<BasicBlock*, unsigned int> > Blocks;
+
+      ///non-phi nodes of each basic block in evaluation order (memory accesses in program order)
+      std::map<unsigned int, std::vector<DfgNode*> > Order;
+
+      ///active lanes of each basic block (same layout as Values, indexed by basic block)
+      std::vector<unsigned char> Active;
+
+      std::map<const Value*, DfgInterpreter::Buffer> Memories;
+
+      ///interpreter used, one lane at a time, for the functions with loops or calls
+      DfgInterpreter* Scalar;
+
+      ///values of the parameters that differ among the lanes (for the scalar interpreter)
+      std::map<const Value*, std::vector<int64_t> > LaneValues;
+
+      ///lanes of the operands that are not nodes and of the addresses, allocated once and reused by each evaluation
+      std::deque<std::vector<int64_t> > Scratch;
+      unsigned int ScratchUsed;
+
+      uint64_t NumEvaluated;
+
+      unsigned int NumErrors;
+
+      int64_t* getLanes(const DfgNode* N)
+      {
+         return &Values[N->Id * MaxLanes];
+      }
+
+      /// returns scratch lanes, valid until the next evaluation
+      int64_t* getScratch();
+
+      /// returns the lanes of an operand: those of its node, or scratch lanes with the constant, the extension
+      /// of a node or the index computation
+      const int64_t* getOperand(const Value* V, unsigned int Lanes);
+
+      /// computes the byte offsets addressed by the lanes of a pointer in its host buffer
+      bool getOffsets(const Value* Ptr, DfgInterpreter::Buffer& B, int64_t* Offsets, unsigned int Lanes);
+
+      /// sets Mask to the lanes that take the edge from the (executed) basic block From to To
+      void getEdgeMask(BasicBlock* From, BasicBlock* To, std::vector<unsigned char>& Mask, unsigned int Lanes);
+
+      /// evaluates the lanes of a node; Mask are the active lanes of its basic block
+      void evaluate(DfgNode* N, const unsigned char* Mask, unsigned int Lanes);
+
+   public:
+
+      DfgBatchInterpreter(DfgGraph* G, unsigned int Lanes);
+
+      ~DfgBatchInterpreter();
+
+      bool isBatched() const
+      {
+         return Batched;
+      }
+
+      /// sets the value of a scalar parameter for all the lanes
+      void setScalar(const Value* Param, int64_t V);
+
+      /// sets the value of a scalar parameter for each lane
+      void setLanes(const Value* Param, const int64_t* V, unsigned int Lanes);
+
+      /// binds the memory (pointer parameter or global) to a host buffer of Size bytes
+      void bindMemory(const Value* Memory, unsigned char* Data, uint64_t Size);
+
+      /// executes the first Lanes invocations of the function (at most the lanes of the interpreter)
+      void run(unsigned int Lanes);
+
+      /// number of node evaluations (one per active lane)
+      uint64_t getNumEvaluated() const;
+
+      unsigned int getNumErrors() const;
+
+};
+
+}
+
+#endif
@@ -0,0 +1,448 @@
+/**
+ * The MIT License (MIT)
+ * 
+ * Copyright (c) 2013 cad-projects
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+/**
+ * Author: Christian Pilato <christian.pilato@polimi.it>
+ *
+ * Description: Implementation of the C++ model of a DFG. Each node is a
+ *              variable of the smallest integer type of its width, computed on
+ *              64 bits and truncated to the width (cad_wrap); the extensions
+ *              removed from the DFG are applied by the users. When the control
+ *              flow is acyclic and there are no calls, the function has no
+ *              branches: each basic block has an activity flag, the phi nodes
+ *              select the value of the active edge and the loads and stores are
+ *              guarded by the flag of their block, so that a loop calling the
+ *              inlined function over many invocations can be vectorized. The
+ *              other functions follow the control flow with gotos.
+ */
+#include "DfgCppWriter.h"
+
+#include "cad/Support.h"
+
+#include "DfgInterpreter.h"
+
+#include "llvm/BasicBlock.h"
+#include "llvm/Constants.h"
+#include "llvm/DerivedTypes.h"
+#include "llvm/Function.h"
+#include "llvm/GlobalVariable.h"
+#include "llvm/Instructions.h"
+#include "llvm/Support/CFG.h"
+#include "llvm/Support/raw_ostream.h"
+#include "llvm/ADT/StringExtras.h"
+
+using namespace llvm;
+using namespace cadlib;
+
+/// returns the innermost element of the arrays
+static Type* getScalarType(Type* Ty)
+{
+   while (ArrayType* AT = dyn_cast<ArrayType>(Ty))
+      Ty = AT->getElementType();
+   return Ty;
+}
+
+/// returns the unsigned type used for the elements of a memory
+static std::string getMemoryType(Type* Ty)
+{
+   unsigned int Bytes = DfgInterpreter::getTypeBytes(getScalarType(Ty));
+   if (Bytes <= 1) return "uint8_t";
+   if (Bytes <= 2) return "uint16_t";
+   if (Bytes <= 4) return "uint32_t";
+   return "uint64_t";
+}
+
+static std::string getNodeName(const DfgNode* N)
+{
+   return "n" + utostr(N->Id);
+}
+
+DfgCppWriter::DfgCppWriter(DfgGraph* G, const Function* F) : Graph(G), F(F)
+{
+   Graph->getEvaluationOrder(Order);
+}
+
+std::string DfgCppWriter::getType(unsigned int Width)
+{
+   if (Width == 0 || Width > 32) return "int64_t";
+   if (Width > 16) return "int32_t";
+   if (Width > 8) return "int16_t";
+   return "int8_t";
+}
+
+std::string DfgCppWriter::getSignature(const Function* F)
+{
+   std::string Signature = "int64_t " + F->getName().str() + "(";
+   for(Function::const_arg_iterator A = F->arg_begin(); A != F->arg_end(); A++)
+   {
+      if (A != F->arg_begin()) Signature += ", ";
+      if (PointerType* PT = dyn_cast<PointerType>(A->getType()))
+         Signature += getMemoryType(PT->getElementType()) + "* " + getVarName(&*A);
+      else
+         Signature += "int64_t " + getVarName(&*A);
+   }
+   return Signature + ")";
+}
+
+std::string DfgCppWriter::getOperand(const Value* V) const
+{
+   V = getOriginalValue(V);
+   if (const ConstantInt* C = dyn_cast<ConstantInt>(V))
+      return C->getBitWidth() == 1 ? utostr(C->getZExtValue()) : "(int64_t)" + itostr(C->getSExtValue()) + "LL";
+   if (Graph->isNode(V)) return "(int64_t)" + getNodeName(Graph->getNode(V));
+   if (const CastInst* C = dyn_cast<CastInst>(V))
+   {
+      std::string Op = getOperand(C->getOperand(0));
+      if (dyn_cast<ZExtInst>(C)) return "(int64_t)cad_mask(" + Op + ", " + utostr(DfgInterpreter::getTypeWidth(C->getOperand(0))) + ")";
+      if (dyn_cast<SExtInst>(C)) return "cad_wrap(" + Op + ", " + utostr(DfgInterpreter::getTypeWidth(C->getOperand(0))) + ")";
+      if (dyn_cast<TruncInst>(C)) return "cad_wrap(" + Op + ", " + utostr(DfgInterpreter::getTypeWidth(C)) + ")";
+      return Op;
+   }
+   ///index computations that are not nodes, truncated to their width
+   if (const BinaryOperator* B = dyn_cast<BinaryOperator>(V))
+   {
+      unsigned int Width = Graph->hasWidth(B) ? Graph->getWidth(B) : DfgInterpreter::getTypeWidth(B);
+      return "cad_wrap(" + getBinary(B, getOperand(B->getOperand(0)), getOperand(B->getOperand(1))) + ", " + utostr(Width) + ")";
+   }
+   ///undefined values and parameters that are not used by the DFG
+   return "(int64_t)0";
+}
+
+std::string DfgCppWriter::getBinary(const BinaryOperator* B, const std::string& A, const std::string& C)
+{
+   std::string Width = utostr(DfgInterpreter::getTypeWidth(B));
+   ///the arithmetic is performed on unsigned values to wrap around
+   switch(B->getOpcode())
+   {
+      case Instruction::Add: return "(int64_t)((uint64_t)" + A + " + (uint64_t)" + C + ")";
+      case Instruction::Sub: return "(int64_t)((uint64_t)" + A + " - (uint64_t)" + C + ")";
+      case Instruction::Mul: return "(int64_t)((uint64_t)" + A + " * (uint64_t)" + C + ")";
+      case Instruction::And: return "(" + A + " & " + C + ")";
+      case Instruction::Or: return "(" + A + " | " + C + ")";
+      case Instruction::Xor: return "(" + A + " ^ " + C + ")";
+      case Instruction::Shl: return "((uint64_t)" + C + " >= 64 ? 0 : (int64_t)((uint64_t)" + A + " << " + C + "))";
+      case Instruction::AShr: return "((uint64_t)" + C + " >= 64 ? (" + A + " < 0 ? -1 : 0) : " + A + " >> " + C + ")";
+      case Instruction::LShr: return "((uint64_t)" + C + " >= 64 ? 0 : (int64_t)(cad_mask(" + A + ", " + Width + ") >> " + C + "))";
+      case Instruction::SDiv: return "(" + C + " == 0 ? 0 : " + A + " / " + C + ")";
+      case Instruction::SRem: return "(" + C + " == 0 ? 0 : " + A + " % " + C + ")";
+      case Instruction::UDiv: return "(" + C + " == 0 ? 0 : (int64_t)(cad_mask(" + A + ", " + Width + ") / cad_mask(" + C + ", " + Width + ")))";
+      case Instruction::URem: return "(" + C + " == 0 ? 0 : (int64_t)(cad_mask(" + A + ", " + Width + ") % cad_mask(" + C + ", " + Width + ")))";
+      default:
+         errs() << "WARNING: operation not supported by the C++ model: " << B->getOpcodeName() << "\n";
+         return "0";
+   }
+}
+
+std::string DfgCppWriter::getElement(const Value* Ptr, Type* ElementTy)
+{
+   ///byte offsets of the indexes of the address
+   std::vector<std::pair<const Value*, uint64_t> > Terms;
+   if (!getAddressTerms(Ptr, Ptr, Terms))
+   {
+      errs() << "WARNING: address not supported by the C++ model: " << Ptr->getName() << "\n";
+      return "*(" + getMemoryType(ElementTy) + "*)0";
+   }
+   if (dyn_cast<GlobalVariable>(Ptr)) Globals.insert(Ptr);
+
+   ///the index in elements of the memory if all the offsets are multiple of the element, the byte offset otherwise
+   uint64_t Bytes = DfgInterpreter::getTypeBytes(ElementTy);
+   bool Elements = Bytes == DfgInterpreter::getTypeBytes(getScalarType(dyn_cast<PointerType>(Ptr->getType())->getElementType()));
+   for(unsigned int t = 0; t < Terms.size(); t++)
+      Elements = Elements && Terms[t].second % Bytes == 0;
+   std::string Index;
+   for(unsigned int t = 0; t < Terms.size(); t++)
+   {
+      uint64_t Scale = Elements ? Terms[t].second / Bytes : Terms[t].second;
+      if (t) Index += " + ";
+      Index += getOperand(Terms[t].first);
+      if (Scale != 1) Index += " * " + utostr(Scale);
+   }
+   if (Index.empty()) Index = "0";
+   if (Elements) return getVarName(Ptr) + "[" + Index + "]";
+   return "*(" + getMemoryType(ElementTy) + "*)((uint8_t*)" + getVarName(Ptr) + " + " + Index + ")";
+}
+
+std::string DfgCppWriter::getExpression(const DfgNode* N, const std::string& Guard)
+{
+   const Instruction* I = dyn_cast<Instruction>(N->Op);
+   if (const BinaryOperator* B = dyn_cast<BinaryOperator>(I))
+      return getBinary(B, getOperand(B->getOperand(0)), getOperand(B->getOperand(1)));
+   else if (const ICmpInst* C = dyn_cast<ICmpInst>(I))
+   {
+      std::string A = getOperand(C->getOperand(0)), B = getOperand(C->getOperand(1));
+      if (C->isUnsigned())
+      {
+         std::string Width = utostr(DfgInterpreter::getTypeWidth(C->getOperand(0)));
+         A = "cad_mask(" + A + ", " + Width + ")";
+         B = "cad_mask(" + B + ", " + Width + ")";
+      }
+      switch(C->getPredicate())
+      {
+         case CmpInst::ICMP_EQ: return "(" + A + " == " + B + ")";
+         case CmpInst::ICMP_NE: return "(" + A + " != " + B + ")";
+         case CmpInst::ICMP_SGT:
+         case CmpInst::ICMP_UGT: return "(" + A + " > " + B + ")";
+         case CmpInst::ICMP_SGE:
+         case CmpInst::ICMP_UGE: return "(" + A + " >= " + B + ")";
+         case CmpInst::ICMP_SLT:
+         case CmpInst::ICMP_ULT: return "(" + A + " < " + B + ")";
+         case CmpInst::ICMP_SLE:
+         case CmpInst::ICMP_ULE: return "(" + A + " <= " + B + ")";
+         default:
+            break;
+      }
+   }
+   else if (const SelectInst* S = dyn_cast<SelectInst>(I))
+      return "((" + getOperand(S->getCondition()) + " & 1) ? " + getOperand(S->getTrueValue()) + " : " + getOperand(S->getFalseValue()) + ")";
+   else if (const CastInst* C = dyn_cast<CastInst>(I))
+   {
+      ///extensions and truncations that are nodes of the DFG (their users refer to the original value)
+      if (dyn_cast<ZExtInst>(C)) return "(int64_t)cad_mask(" + getOperand(C->getOperand(0)) + ", " + utostr(DfgInterpreter::getTypeWidth(C->getOperand(0))) + ")";
+      return getOperand(C->getOperand(0));
+   }
+   else if (const LoadInst* L = dyn_cast<LoadInst>(I))
+   {
+      std::string Element = "(int64_t)" + getElement(L->getPointerOperand(), L->getType());
+      if (Guard.empty()) return Element;
+      ///the inactive lanes do not access the memory
+      return "(" + Guard + " ? " + Element + " : 0)";
+   }
+   else if (const CallInst* Call = dyn_cast<CallInst>(I))
+   {
+      Callees.insert(Call->getCalledFunction());
+      std::string Expression = Call->getCalledFunction()->getName().str() + "(";
+      for(unsigned int a = 0; a < Call->getNumArgOperands(); a++)
+      {
+         const Value* Arg = Call->getArgOperand(a);
+         if (a) Expression += ", ";
+         if (PointerType* PT = dyn_cast<PointerType>(Arg->getType()))
+            Expression += "&" + getElement(Arg, getScalarType(PT->getElementType()));
+         else
+            Expression += getOperand(Arg);
+      }
+      return Expression + ")";
+   }
+
+   errs() << "WARNING: operation not supported by the C++ model: " << I->getOpcodeName() << "\n";
+   return "0";
+}
+
+std::string DfgCppWriter::getEdge(BasicBlock* From, BasicBlock* To) const
+{
+   std::string Source = "bb" + utostr(Graph->getBbIdx(From));
+   const TerminatorInst* T = From->getTerminator();
+   if (const BranchInst* Br = dyn_cast<BranchInst>(T))
+   {
+      if (Br->isUnconditional() || Br->getSuccessor(0) == Br->getSuccessor(1)) return Source;
+      std::string Condition = "(" + getOperand(Br->getCondition()) + " & 1)";
+      return "(" + Source + " && " + (Br->getSuccessor(0) == To ? "" : "!") + Condition + ")";
+   }
+   const SwitchInst* Sw = dyn_cast<SwitchInst>(T);
+   if (!Sw) return "false";
+   std::string Condition = "cad_wrap(" + getOperand(Sw->getCondition()) + ", " + utostr(DfgInterpreter::getTypeWidth(Sw->getCondition())) + ")";
+   std::string Cases, Taken;
+   for(SwitchInst::ConstCaseIt c = Sw->case_begin(); c != Sw->case_end(); ++c)
+   {
+      std::string Case = Condition + " == " + itostr(c.getCaseValue()->getSExtValue()) + "LL";
+      Cases += (Cases.empty() ? "" : " || ") + Case;
+      if (c.getCaseSuccessor() == To) Taken += (Taken.empty() ? "" : " || ") + Case;
+   }
+   if (Sw->getDefaultDest() == To)
+      Taken += (Taken.empty() ? "" : " || ") + (Cases.empty() ? std::string("true") : "!(" + Cases + ")");
+   return "(" + Source + " && (" + Taken + "))";
+}
+
+std::string DfgCppWriter::getPhiCopies(BasicBlock* From, BasicBlock* To, const std::string& Indent) const
+{
+   ///the phi nodes are assigned at the same time
+   std::string Reads, Writes;
+   unsigned int t = 0;
+   for(BasicBlock::iterator i = To->begin(); dyn_cast<PHINode>(&*i); i++)
+   {
+      const PHINode* P = dyn_cast<PHINode>(&*i);
+      if (!Graph->isNode(P) || Graph->getNode(P)->Op != P) continue;
+      const DfgNode* N = Graph->getNode(P);
+      std::string Tmp = "t" + utostr(t++);
+      Reads += "const int64_t " + Tmp + " = " + getOperand(P->getIncomingValueForBlock(From)) + "; ";
+      Writes += getNodeName(N) + " = (" + getType(N->getWidth()) + ")cad_wrap(" + Tmp + ", " + utostr(N->getWidth()) + "); ";
+   }
+   if (!t) return "";
+   return Indent + "{ " + Reads + Writes + "}\n";
+}
+
+void DfgCppWriter::writePredicated(std::ostringstream& oss, const std::vector<BasicBlock*>& Blocks)
+{
+   std::set<BasicBlock*> Reachable(Blocks.begin(), Blocks.end());
+   oss << "   int64_t ret = 0;\n";
+   for(unsigned int b = 0; b < Blocks.size(); b++)
+   {
+      BasicBlock* BB = Blocks[b];
+      std::string Active = "bb" + utostr(Graph->getBbIdx(BB));
+      std::string Incoming;
+      if (b == 0)
+         Incoming = "true";
+      else
+      {
+         std::set<BasicBlock*> Predecessors;
+         for(pred_iterator p = pred_begin(BB); p != pred_end(BB); p++)
+         {
+            if (!Reachable.count(*p) || !Predecessors.insert(*p).second) continue;
+            std::string Edge = "e" + utostr(Graph->getBbIdx(*p)) + "_" + utostr(Graph->getBbIdx(BB));
+            oss << "   const bool " << Edge << " = " << getEdge(*p, BB) << ";\n";
+            Incoming += (Incoming.empty() ? "" : " || ") + Edge;
+         }
+      }
+      oss << "   const bool " << Active << " = " << (Incoming.empty() ? "false" : Incoming) << ";\n";
+
+      ///the phi nodes select the value of the active incoming edge
+      for(BasicBlock::iterator i = BB->begin(); dyn_cast<PHINode>(&*i); i++)
+      {
+         const PHINode* P = dyn_cast<PHINode>(&*i);
+         if (!Graph->isNode(P) || Graph->getNode(P)->Op != P) continue;
+         const DfgNode* N = Graph->getNode(P);
+         std::string Select = "0";
+         for(unsigned int v = P->getNumIncomingValues(); v > 0; v--)
+         {
+            if (!Reachable.count(P->getIncomingBlock(v-1))) continue;
+            std::string Edge = "e" + utostr(Graph->getBbIdx(P->getIncomingBlock(v-1))) + "_" + utostr(Graph->getBbIdx(BB));
+            Select = "(" + Edge + " ? " + getOperand(P->getIncomingValue(v-1)) + " : " + Select + ")";
+         }
+         oss << "   const " << getType(N->getWidth()) << " " << getNodeName(N) << " = (" << getType(N->getWidth()) << ")cad_wrap(" << Select << ", " << N->getWidth() << "); // " << P->getName().str() << "\n";
+      }
+
+      std::vector<DfgNode*>& Nodes = Order[Graph->getBbIdx(BB)];
+      for(unsigned int n = 0; n < Nodes.size(); n++)
+      {
+         const DfgNode* N = Nodes[n];
+         if (const StoreInst* S = dyn_cast<StoreInst>(N->Op))
+            oss << "   if (" << Active << ") " << getElement(S->getPointerOperand(), S->getValueOperand()->getType()) << " = (" << getMemoryType(S->getValueOperand()->getType()) << ")" << getOperand(S->getValueOperand()) << ";\n";
+         else if (N->hasValue())
+            oss << "   const " << getType(N->getWidth()) << " " << getNodeName(N) << " = (" << getType(N->getWidth()) << ")cad_wrap(" << getExpression(N, Active) << ", " << N->getWidth() << "); // " << N->Op->getName().str() << "\n";
+      }
+      if (const ReturnInst* Ret = dyn_cast<ReturnInst>(BB->getTerminator()))
+         if (Ret->getReturnValue())
+            oss << "   ret = " << Active << " ? " << getOperand(Ret->getReturnValue()) << " : ret;\n";
+   }
+   oss << "   return ret;\n";
+}
+
+void DfgCppWriter::writeGoto(std::ostringstream& oss)
+{
+   const std::vector<DfgNode*>& Nodes = Graph->getNodes();
+   for(unsigned int n = 0; n < Nodes.size(); n++)
+      if (dyn_cast<Instruction>(Nodes[n]->Op) && Nodes[n]->hasValue())
+         oss << "   " << getType(Nodes[n]->getWidth()) << " " << getNodeName(Nodes[n]) << " = 0; // " << Nodes[n]->Op->getName().str() << "\n";
+
+   for(Function::const_iterator b = F->begin(); b != F->end(); b++)
+   {
+      BasicBlock* BB = const_cast<BasicBlock*>(&*b);
+      oss << "bb" << Graph->getBbIdx(BB) << ":\n";
+      std::vector<DfgNode*>& Block = Order[Graph->getBbIdx(BB)];
+      for(unsigned int n = 0; n < Block.size(); n++)
+      {
+         const DfgNode* N = Block[n];
+         if (const StoreInst* S = dyn_cast<StoreInst>(N->Op))
+            oss << "   " << getElement(S->getPointerOperand(), S->getValueOperand()->getType()) << " = (" << getMemoryType(S->getValueOperand()->getType()) << ")" << getOperand(S->getValueOperand()) << ";\n";
+         else if (N->hasValue())
+            oss << "   " << getNodeName(N) << " = (" << getType(N->getWidth()) << ")cad_wrap(" << getExpression(N, "") << ", " << N->getWidth() << ");\n";
+      }
+      const TerminatorInst* T = BB->getTerminator();
+      if (const BranchInst* Br = dyn_cast<BranchInst>(T))
+      {
+         if (Br->isConditional())
+         {
+            oss << "   if (" << getOperand(Br->getCondition()) << " & 1)\n   {\n";
+            oss << getPhiCopies(BB, Br->getSuccessor(0), "      ");
+            oss << "      goto bb" << Graph->getBbIdx(Br->getSuccessor(0)) << ";\n   }\n";
+            oss << getPhiCopies(BB, Br->getSuccessor(1), "   ");
+            oss << "   goto bb" << Graph->getBbIdx(Br->getSuccessor(1)) << ";\n";
+         }
+         else
+         {
+            oss << getPhiCopies(BB, Br->getSuccessor(0), "   ");
+            oss << "   goto bb" << Graph->getBbIdx(Br->getSuccessor(0)) << ";\n";
+         }
+      }
+      else if (const SwitchInst* Sw = dyn_cast<SwitchInst>(T))
+      {
+         oss << "   switch (cad_wrap(" << getOperand(Sw->getCondition()) << ", " << DfgInterpreter::getTypeWidth(Sw->getCondition()) << "))\n   {\n";
+         for(SwitchInst::ConstCaseIt c = Sw->case_begin(); c != Sw->case_end(); ++c)
+         {
+            BasicBlock* Dest = const_cast<BasicBlock*>(c.getCaseSuccessor());
+            oss << "      case " << c.getCaseValue()->getSExtValue() << "LL:\n";
+            oss << getPhiCopies(BB, Dest, "         ");
+            oss << "         goto bb" << Graph->getBbIdx(Dest) << ";\n";
+         }
+         oss << "      default:\n";
+         oss << getPhiCopies(BB, Sw->getDefaultDest(), "         ");
+         oss << "         goto bb" << Graph->getBbIdx(Sw->getDefaultDest()) << ";\n   }\n";
+      }
+      else if (const ReturnInst* Ret = dyn_cast<ReturnInst>(T))
+         oss << "   return " << (Ret->getReturnValue() ? getOperand(Ret->getReturnValue()) : std::string("0")) << ";\n";
+      else
+         oss << "   return 0;\n";
+   }
+}
+
+std::string DfgCppWriter::write()
+{
+   Globals.clear();
+   Callees.clear();
+
+   ///the branch-free form requires an acyclic control flow and no calls
+   std::vector<BasicBlock*> Blocks;
+   bool Predicated = getReversePostOrder(const_cast<Function*>(F), Blocks);
+   for(unsigned int n = 0; n < Graph->getNodes().size(); n++)
+      if (Graph->getNodes()[n]->Type == DfgNode::CALL) Predicated = false;
+
+   std::ostringstream body;
+   ///scalar parameters, truncated to their width
+   for(Function::const_arg_iterator A = F->arg_begin(); A != F->arg_end(); A++)
+   {
+      if (A->getType()->isPointerTy() || !Graph->isNode(&*A)) continue;
+      const DfgNode* N = Graph->getNode(&*A);
+      body << "   const " << getType(N->getWidth()) << " " << getNodeName(N) << " = (" << getType(N->getWidth()) << ")cad_wrap(" << getVarName(&*A) << ", " << N->getWidth() << ");\n";
+   }
+   if (Predicated)
+      writePredicated(body, Blocks);
+   else
+      writeGoto(body);
+
+   std::ostringstream oss;
+   oss << "/// C++ model of the DFG of " << Graph->getFunctionName() << ": each value is computed on 64 bits and\n";
+   oss << "/// truncated to the width of its node (bit-accurate with respect to the generated hardware)\n";
+   if (Predicated)
+      oss << "/// The control flow is converted into predicates: calling the function in a loop over the\n/// invocations allows the compiler to inline and vectorize it.\n";
+   oss << "#include <stdint.h>\n\n";
+   oss << "#ifndef CAD_DFG_HELPERS\n#define CAD_DFG_HELPERS\n";
+   oss << "/// returns the value represented by the low w bits of v (two's complement)\n";
+   oss << "static inline int64_t cad_wrap(int64_t v, unsigned int w)\n{\n   return w == 0 || w >= 64 ? v : (int64_t)((uint64_t)v << (64 - w)) >> (64 - w);\n}\n\n";
+   oss << "/// returns the low w bits of v\n";
+   oss << "static inline uint64_t cad_mask(int64_t v, unsigned int w)\n{\n   return w == 0 || w >= 64 ? (uint64_t)v : (uint64_t)v & ((1ULL << w) - 1);\n}\n#endif\n\n";
+   for(std::set<const Value*>::iterator g = Globals.begin(); g != Globals.end(); g++)
+      oss << "extern " << getMemoryType(dyn_cast<PointerType>((*g)->getType())->getElementType()) << " " << getVarName(*g) << "[];\n";
+   for(std::set<const Function*>::iterator c = Callees.begin(); c != Callees.end(); c++)
+      oss << getSignature(*c) << ";\n";
+   if (Globals.size() || Callees.size()) oss << "\n";
+   oss << "inline " << getSignature(F) << "\n{\n" << body.str() << "}\n";
+   return oss.str();
+}
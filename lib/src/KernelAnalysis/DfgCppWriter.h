@@ -0,0 +1,103 @@
+/**
+ * The MIT License (MIT)
+ * 
+ * Copyright (c) 2013 cad-projects
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+/**
+ * Author: Christian Pilato <christian.pilato@polimi.it>
+ *
+ * Description: This file defines the generator of the C++ model of a DFG: a
+ *              self-contained function computing each node on the integer type
+ *              of its width, used as bit-accurate golden model of the kernel
+ */
+#ifndef DFGCPPWRITER_H
+#define DFGCPPWRITER_H
+
+#include "Dfg.h"
+
+#include <map>
+#include <set>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace llvm {
+
+class BasicBlock;
+class BinaryOperator;
+class Function;
+class Type;
+
+class DfgCppWriter
+{
+
+   private:
+
+      DfgGraph* Graph;
+
+      const Function* F;
+
+      ///non-phi nodes of each basic block in evaluation order (memory accesses in program order)
+      std::map<unsigned int, std::vector<DfgNode*> > Order;
+
+      ///globals accessed by the function (declared extern) and called functions (declared)
+      std::set<const Value*> Globals;
+      std::set<const Function*> Callees;
+
+      /// returns the expression of the value of an operand (constant, node, extension/truncation of a node or index computation)
+      std::string getOperand(const Value* V) const;
+
+      /// returns the expression of a binary operation on the given operands (before the truncation to its width)
+      static std::string getBinary(const BinaryOperator* B, const std::string& A, const std::string& C);
+
+      /// returns the element accessed through the pointer, e.g. "original1[n12 + 1]"
+      std::string getElement(const Value* Ptr, Type* ElementTy);
+
+      /// returns the expression computed by the node (before the truncation to its width); Guard is the condition of its basic block
+      std::string getExpression(const DfgNode* N, const std::string& Guard);
+
+      /// returns the condition of the edge between two basic blocks of the acyclic form
+      std::string getEdge(BasicBlock* From, BasicBlock* To) const;
+
+      /// returns the assignments of the phi nodes of To for the edge from From (cyclic form)
+      std::string getPhiCopies(BasicBlock* From, BasicBlock* To, const std::string& Indent) const;
+
+      void writePredicated(std::ostringstream& oss, const std::vector<BasicBlock*>& Blocks);
+
+      void writeGoto(std::ostringstream& oss);
+
+   public:
+
+      DfgCppWriter(DfgGraph* G, const Function* F);
+
+      /// returns the C++ code of the function
+      std::string write();
+
+      /// returns the signature of the function generated for F
+      static std::string getSignature(const Function* F);
+
+      /// returns the smallest signed integer type of at least Width bits
+      static std::string getType(unsigned int Width);
+
+};
+
+}
+
+#endif
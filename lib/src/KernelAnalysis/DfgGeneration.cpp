@@ -33,24 +33,53 @@
 #include "DetermineBitWidth.h"
 
 #include "Dfg.h"
+#include "DfgPredicates.h"
+#include "DfgReachability.h"
 #include "llvm/Support/raw_ostream.h"
 #include "llvm/ADT/Statistic.h"
+#include "llvm/Analysis/Dominators.h"
+#include "llvm/Analysis/LoopInfo.h"
+#include "llvm/Analysis/PostDominators.h"
+#include "llvm/ADT/PostOrderIterator.h"
+#include "llvm/Constants.h"
 #include "llvm/Instructions.h"
+#include "llvm/ADT/StringExtras.h"
+
+#include <algorithm>
 
 STATISTIC(DfgCounter, "[CAD] Counts number of functions analyzed");
+STATISTIC(MergedNodes, "[CAD] Number of equivalent DFG nodes merged");
 
 using namespace llvm;
 using namespace cadlib;
 
+static cl::opt<unsigned int> reachabilityBench("dfg-reachability-bench",
+  cl::desc("[CAD] Run the given number of random reachability queries on each generated DFG"),
+  cl::init(0));
+
+static cl::opt<bool> flattenCalls("dfg-flatten-calls",
+  cl::desc("[CAD] Replace the calls to single-block functions with a copy of the callee DFG"),
+  cl::init(false));
+
+static cl::opt<bool> hashConsing("dfg-hash-consing",
+  cl::desc("[CAD] Merge the DFG nodes that compute the same operation on the same operands"),
+  cl::init(false));
+
 char DfgGeneration::ID = 0;
 static const char dfg_generation_name[] = "[CAD] DFG Generation";
 INITIALIZE_PASS_BEGIN(DfgGeneration, DEBUG_TYPE, dfg_generation_name, false, false)
 INITIALIZE_PASS_DEPENDENCY(DetermineBitWidth)
+INITIALIZE_PASS_DEPENDENCY(LoopInfo)
+INITIALIZE_PASS_DEPENDENCY(DominatorTree)
+INITIALIZE_PASS_DEPENDENCY(PostDominatorTree)
 INITIALIZE_PASS_END(DfgGeneration, DEBUG_TYPE, dfg_generation_name, false, false)
 
 void DfgGeneration::getAnalysisUsage(AnalysisUsage &AU) const
 {
    AU.addRequired<DetermineBitWidth>();
+   AU.addRequired<LoopInfo>();
+   AU.addRequired<DominatorTree>();
+   AU.addRequired<PostDominatorTree>();
    AU.setPreservesAll();
 }
 
@@ -58,9 +87,25 @@ Pass* createDfgGenerationPass() {
   return new DfgGeneration;
 }
 
+/// returns true if the edge from From to To goes back to the header of a loop
+static bool isBackEdge(const LoopInfo& LI, const BasicBlock* From, const BasicBlock* To)
+{
+   const Loop* L = LI.getLoopFor(To);
+   return L && L->getHeader() == To && L->contains(From);
+}
+
+/// returns the width of a value of the current function
+static unsigned int getValueWidth(const DetermineBitWidth& BW, const Value* V)
+{
+   if (BW.hasBitWidth(V)) return BW.getBitWidth(V);
+   if (dyn_cast<ConstantInt>(V)) return getConstantWidth(dyn_cast<ConstantInt>(V)->getSExtValue());
+   return V->getType()->isIntegerTy() ? V->getType()->getIntegerBitWidth() : 0;
+}
+
 bool DfgGeneration::runOnFunction(Function &F)
 {
-   if (std::find(functionNames.begin(), functionNames.end(), F.getName()) == functionNames.end())
+   ///the functions called by the kernels are analyzed as well, to be referenced by the call nodes
+   if (!isCalledByKernel(F))
       return false;
 
    ++DfgCounter;
@@ -68,7 +113,6 @@ bool DfgGeneration::runOnFunction(Function &F)
    graph = new DfgGraph(F.getName());
 
    unsigned int bbIdx = 1;
-   std::map<BasicBlock*, std::tr1::tuple<const Instruction*, unsigned int> > ControlEdge;
    for (Function::iterator b = F.begin(), be = F.end(); b != be; b++)
    {
       unsigned int index = bbIdx++;
@@ -76,27 +120,19 @@ bool DfgGeneration::runOnFunction(Function &F)
       graph->bbMap[&BB] = index;
       graph->bbReverseMap[index] = &BB;
    }
+   LoopInfo& LI = getAnalysis<LoopInfo>();
+   for(LoopInfo::iterator l = LI.begin(); l != LI.end(); l++)
+      processLoop(graph, *l, -1);
+   std::vector<PHINode*> Phis;
+   std::set<const Instruction*> Processed;
    for (Function::iterator b = F.begin(), be = F.end(); b != be; b++)
    {
       BasicBlock& BB = *b;
       const TerminatorInst* LastInst = BB.getTerminator();
       if (LastInst)
       {
-         if (LastInst->getOpcode() == Instruction::Br)
-         {
-            const BranchInst* br = dyn_cast<BranchInst>(LastInst);
-            if (br->isConditional())
-            {
-               const Instruction* val = dyn_cast<Instruction>(br->getCondition());
-               ControlEdge[br->getSuccessor(0)] = std::tr1::tuple<const Instruction*, unsigned int>(val, 1);
-               ControlEdge[br->getSuccessor(1)] = std::tr1::tuple<const Instruction*, unsigned int>(val, 0);
-            }
-         }
-         else if (LastInst->getOpcode() == Instruction::Switch)
-         {
-            assert(0 && "Switch not yet supported");
-         }
-         else if (!LastInst->getOpcode() == Instruction::Ret)
+         ///the control dependences of the branches and switches are computed once all the conditions are nodes
+         if (LastInst->getOpcode() != Instruction::Br && LastInst->getOpcode() != Instruction::Switch && LastInst->getOpcode() != Instruction::Ret)
          {
             errs() << "LAST INSTRUCTION NOT SUPPORTED! " << LastInst->getOpcodeName() << "\n";
             assert(0);
@@ -106,30 +142,510 @@ bool DfgGeneration::runOnFunction(Function &F)
       for (BasicBlock::iterator i = b->begin(), ie = b->end(); i != ie; i++)
       {
          Instruction& I = *i;
+         if (dyn_cast<PHINode>(&I))
+         {
+            ///the incoming values are connected once all the instructions have been processed
+            graph->getNode(&I, getAnalysis<DetermineBitWidth>().getBitWidth(&I), graph->bbMap[&BB]);
+            Phis.push_back(dyn_cast<PHINode>(&I));
+            continue;
+         }
          std::set<const Value*> alreadyAnalyzed;
          bool isLoad = false, isStore = false;
          if (!isMemoryRelated(&I, alreadyAnalyzed, isLoad, isStore))
          {
             if (dyn_cast<CastInst>(&I) || dyn_cast<BranchInst>(&I)) continue;
-            DfgNode* dfg = processInstruction(graph, &I, graph->bbMap[&BB]);
-            if (dfg && ControlEdge.find(&BB) != ControlEdge.end())
+            Processed.insert(&I);
+            processInstruction(graph, &I, graph->bbMap[&BB]);
+         }
+      }
+   }
+
+   for(unsigned int p = 0; p < Phis.size(); p++)
+      processPhi(graph, Phis[p]);
+
+   ///address computations that are also used by other nodes (e.g., the increment of an induction variable)
+   ///are created by their users, their operands are connected here
+   for(unsigned int n = 0; n < graph->Nodes.size(); n++)
+   {
+      Instruction* I = const_cast<Instruction*>(dyn_cast<Instruction>(graph->Nodes[n]->Op));
+      if (!I || dyn_cast<PHINode>(I) || !Processed.insert(I).second) continue;
+      processInstruction(graph, I, graph->bbMap[I->getParent()]);
+   }
+
+   if (hashConsing)
+   {
+      unsigned int NumNodes = graph->Nodes.size();
+      unsigned int Addresses = 0;
+      unsigned int Merged = mergeEquivalentNodes(graph, F, getAnalysis<DominatorTree>(), Addresses);
+      errs() << " - hash-consing: " << Merged << " nodes merged, " << Addresses << " of them computing addresses (" << NumNodes << " -> " << NumNodes - Merged << ")\n";
+   }
+
+   computePredicates(graph, F);
+
+   ///pointer parameters accessed by the called functions
+   std::vector<DfgNode*> Calls;
+   std::set<DfgNode*> Parameters;
+   for(unsigned int n = 0; n < graph->Nodes.size(); n++)
+   {
+      if (graph->Nodes[n]->Type != DfgNode::CALL) continue;
+      Calls.push_back(graph->Nodes[n]);
+      const std::vector<DfgNode*>& Uses = graph->Nodes[n]->UseNodes;
+      for(unsigned int u = 0; u < Uses.size(); u++)
+         if (dyn_cast<Argument>(Uses[u]->Op) && Uses[u]->Op->getType()->isPointerTy()) Parameters.insert(Uses[u]);
+   }
+   if (flattenCalls && Calls.size())
+   {
+      std::map<DfgNode*, DfgNode*> Replacement;
+      for(unsigned int c = 0; c < Calls.size(); c++)
+         flattenCall(graph, Calls[c], Replacement);
+      ///the result of a flattened call may be the result of another one
+      for(std::map<DfgNode*, DfgNode*>::iterator r = Replacement.begin(); r != Replacement.end(); r++)
+         while (r->second && Replacement.find(r->second) != Replacement.end())
+            r->second = Replacement[r->second];
+      graph->replaceNodes(Replacement);
+   }
+   updateParameters(graph, Parameters);
+
+   graph->finalize();
+
+   ///the DFG of a called function is kept for the call nodes of its callers
+   for(Value::use_iterator It = F.use_begin(); It != F.use_end(); It++)
+   {
+      if (!dyn_cast<CallInst>(*It) || dyn_cast<CallInst>(*It)->getCalledFunction() != &F) continue;
+      Callees[&F] = graph;
+      break;
+   }
+
+   if (reachabilityBench)
+      graph->getReachability().benchmark(reachabilityBench);
+
+   errs() << "##\n\n";
+   return false;
+}
+
+/// returns true if the operands of the instruction can be swapped
+static bool isCommutative(const Instruction* I)
+{
+   if (dyn_cast<ICmpInst>(I)) return dyn_cast<ICmpInst>(I)->isEquality();
+   return I->isCommutative();
+}
+
+unsigned int DfgGeneration::mergeEquivalentNodes(DfgGraph* g, Function& F, DominatorTree& DT, unsigned int& Addresses)
+{
+   ///basic block of each node (the operands may be placed in the basic block of their first user)
+   std::map<const DfgNode*, BasicBlock*> NodeBB;
+   for(std::map<unsigned int, std::vector<const Value*> >::const_iterator b = g->bbNodes.begin(); b != g->bbNodes.end(); b++)
+   {
+      if (b->first == 0) continue;
+      for(unsigned int i = 0; i < b->second.size(); i++)
+         NodeBB[g->getNode(b->second[i])] = g->bbReverseMap[b->first];
+   }
+
+   ///the key of a node is its opcode, comparison predicate, width and the ids of its (merged) operands;
+   ///once the index computations of the accesses are nodes (addIndexNodes), the addresses share their subexpressions
+   typedef std::vector<unsigned int> Key_t;
+   std::map<Key_t, std::vector<DfgNode*> > Table;
+   std::map<DfgNode*, DfgNode*> Replacement;
+   ///the operands of an instruction are visited before it (reverse post-order of the basic blocks)
+   ReversePostOrderTraversal<Function*> RPOT(&F);
+   for(ReversePostOrderTraversal<Function*>::rpo_iterator b = RPOT.begin(); b != RPOT.end(); b++)
+   {
+      for(BasicBlock::iterator i = (*b)->begin(); i != (*b)->end(); i++)
+      {
+         Instruction* I = &*i;
+         if ((!dyn_cast<BinaryOperator>(I) && !dyn_cast<ICmpInst>(I)) || !g->isNode(I)) continue;
+         DfgNode* N = g->getNode(I);
+         if (N->Op != I || N->Type != DfgNode::INSTRUCTION || NodeBB.find(N) == NodeBB.end()) continue;
+         Key_t Operands;
+         for(unsigned int u = 0; u < N->UseNodes.size(); u++)
+         {
+            DfgNode* Op = N->UseNodes[u];
+            if (Replacement.find(Op) != Replacement.end()) Op = Replacement[Op];
+            Operands.push_back(Op->Id);
+         }
+         if (isCommutative(I)) std::sort(Operands.begin(), Operands.end());
+         Key_t Key;
+         Key.push_back(I->getOpcode());
+         Key.push_back(dyn_cast<CmpInst>(I) ? dyn_cast<CmpInst>(I)->getPredicate() : 0);
+         Key.push_back(N->getWidth());
+         Key.insert(Key.end(), Operands.begin(), Operands.end());
+
+         std::vector<DfgNode*>& Candidates = Table[Key];
+         for(unsigned int c = 0; c < Candidates.size() && Replacement.find(N) == Replacement.end(); c++)
+            if (DT.dominates(NodeBB[Candidates[c]], NodeBB[N])) Replacement[N] = Candidates[c];
+         if (Replacement.find(N) == Replacement.end())
+         {
+            Candidates.push_back(N);
+            continue;
+         }
+         std::set<const Value*> alreadyAnalyzed;
+         bool isLoad = false, isStore = false;
+         if (isMemoryRelated(I, alreadyAnalyzed, isLoad, isStore)) Addresses++;
+      }
+   }
+   MergedNodes += Replacement.size();
+   g->replaceNodes(Replacement);
+   return Replacement.size();
+}
+
+void DfgGeneration::computePredicates(DfgGraph* g, Function& F)
+{
+   LoopInfo& LI = getAnalysis<LoopInfo>();
+   PostDominatorTree& PDT = getAnalysis<PostDominatorTree>();
+   DfgPredicates& Table = g->getPredicates();
+
+   ///control dependences of each basic block: branching block and literal of the edge
+   std::map<const BasicBlock*, std::vector<std::pair<const BasicBlock*, unsigned int> > > Dependences;
+   for(Function::iterator It = F.begin(); It != F.end(); It++)
+   {
+      BasicBlock* b = &*It;
+      if (!PDT.getNode(b)) continue;
+      ///outcomes of the terminator: successor and literal
+      std::vector<std::pair<BasicBlock*, unsigned int> > Outcomes;
+      const BranchInst* br = dyn_cast<BranchInst>(b->getTerminator());
+      if (br && br->isConditional() && g->isNode(br->getCondition()))
+      {
+         DfgNode* Condition = g->getNode(br->getCondition());
+         Outcomes.push_back(std::make_pair(br->getSuccessor(0), Table.getLiteral(Condition, DfgNode::T_EDGE, 0)));
+         Outcomes.push_back(std::make_pair(br->getSuccessor(1), Table.getLiteral(Condition, DfgNode::F_EDGE, 0)));
+      }
+      ///the outcomes of a switch are the bits of its one-hot encoding: one per case, then the default
+      const SwitchInst* sw = dyn_cast<SwitchInst>(b->getTerminator());
+      if (sw && g->isNode(sw))
+      {
+         DfgNode* Condition = g->getNode(sw);
+         for(SwitchInst::ConstCaseIt c = sw->case_begin(); c != sw->case_end(); ++c)
+            Outcomes.push_back(std::make_pair(const_cast<BasicBlock*>(c.getCaseSuccessor()), Table.getLiteral(Condition, DfgNode::SWITCH_CASE_EDGE, c.getCaseIndex())));
+         Outcomes.push_back(std::make_pair(sw->getDefaultDest(), Table.getLiteral(Condition, DfgNode::SWITCH_DEF_EDGE, sw->getNumCases())));
+      }
+      DomTreeNode* Stop = PDT.getNode(b)->getIDom();
+      for(unsigned int o = 0; o < Outcomes.size(); o++)
+      {
+         ///the header of a loop is executed on entry, its dependence on the back edge is carried by the phi nodes
+         if (isBackEdge(LI, b, Outcomes[o].first)) continue;
+         ///the blocks from the successor up to the immediate post-dominator of the branch (excluded) in the post-dominator tree
+         for(DomTreeNode* B = PDT.getNode(Outcomes[o].first); B && B != Stop && B->getBlock() && B->getBlock() != b; B = B->getIDom())
+            Dependences[B->getBlock()].push_back(std::make_pair(b, Outcomes[o].second));
+      }
+   }
+
+   ///the predicate of a block is the disjunction of the predicates of its controlling edges
+   std::map<const BasicBlock*, unsigned int> BlockPredicate;
+   ReversePostOrderTraversal<Function*> RPOT(&F);
+   for(ReversePostOrderTraversal<Function*>::rpo_iterator b = RPOT.begin(); b != RPOT.end(); b++)
+   {
+      const std::vector<std::pair<const BasicBlock*, unsigned int> >& Edges = Dependences[*b];
+      unsigned int Predicate = DfgPredicates::Always;
+      for(unsigned int e = 0; e < Edges.size(); e++)
+      {
+         unsigned int Edge = Table.getAnd(BlockPredicate[Edges[e].first], Edges[e].second);
+         Predicate = e ? Table.getOr(Predicate, Edge) : Edge;
+      }
+      BlockPredicate[*b] = Predicate;
+   }
+
+   for(std::map<BasicBlock*, unsigned int>::iterator b = g->bbMap.begin(); b != g->bbMap.end(); b++)
+      g->BlockPredicates[b->second] = BlockPredicate[b->first];
+
+   for(std::map<unsigned int, std::vector<const Value*> >::iterator bb = g->bbNodes.begin(); bb != g->bbNodes.end(); bb++)
+   {
+      if (bb->first == 0) continue;
+      unsigned int Predicate = g->BlockPredicates[bb->first];
+      for(unsigned int v = 0; v < bb->second.size(); v++)
+         if (g->isNode(bb->second[v]) && g->getNode(bb->second[v])->Op == bb->second[v])
+            g->getNode(bb->second[v])->Predicate = Predicate;
+   }
+   errs() << " - " << Table.getNumPredicates() << " predicates on " << Table.getNumLiterals() << " branch outcomes (";
+   errs() << Table.getMemoryUsage() << " bytes)\n";
+}
+
+bool DfgGeneration::isHashConsing() const
+{
+   return hashConsing;
+}
+
+/// returns the pointers accessed by a load, a store or a call (the pointer arguments)
+static std::vector<const Value*> getAccessedPointers(const DfgNode* N)
+{
+   std::vector<const Value*> Pointers;
+   if (N->Type == DfgNode::LOAD) Pointers.push_back(dyn_cast<LoadInst>(N->Op)->getPointerOperand());
+   if (N->Type == DfgNode::STORE) Pointers.push_back(dyn_cast<StoreInst>(N->Op)->getPointerOperand());
+   if (N->Type == DfgNode::CALL)
+   {
+      const CallInst* C = dyn_cast<CallInst>(N->Op);
+      for(unsigned int a = 0; a < C->getNumArgOperands(); a++)
+         if (C->getArgOperand(a)->getType()->isPointerTy()) Pointers.push_back(getRealValue(C->getArgOperand(a)));
+   }
+   ///the wide accesses (memory coalescing) cast the address of their first element
+   for(unsigned int p = 0; p < Pointers.size(); p++)
+      if (dyn_cast<BitCastInst>(Pointers[p])) Pointers[p] = dyn_cast<BitCastInst>(Pointers[p])->getOperand(0);
+   return Pointers;
+}
+
+unsigned int DfgGeneration::addIndexNodes(DfgGraph* g)
+{
+   unsigned int NumNodes = g->Nodes.size();
+   for(unsigned int n = 0; n < NumNodes; n++)
+   {
+      DfgNode* Access = g->Nodes[n];
+      std::vector<const Value*> Pointers = getAccessedPointers(Access);
+      for(unsigned int p = 0; p < Pointers.size(); p++)
+      {
+         const GetElementPtrInst* GEP = dyn_cast<GetElementPtrInst>(Pointers[p]);
+         if (!GEP) continue;
+         for(GetElementPtrInst::const_op_iterator It = GEP->idx_begin(); It != GEP->idx_end(); It++)
+         {
+            ///the operands of an index computation precede it
+            std::list<const Value*> Operations;
+            getMemoryOps(getRealValue(*It), Operations);
+            for(std::list<const Value*>::iterator op = Operations.begin(); op != Operations.end(); op++)
             {
-               DfgNode* src = graph->getNode(std::tr1::get<0>(ControlEdge[&BB]));
-               DfgNode::Control_t type = DfgNode::T_EDGE;
-               if (std::tr1::get<1>(ControlEdge[&BB]) == 0)
+               if (g->isNode(*op)) continue;
+               const Instruction* I = dyn_cast<Instruction>(*op);
+               unsigned int bb = g->bbMap[const_cast<BasicBlock*>(I->getParent())];
+               ///the node is placed in its own basic block, before the nodes of the following instructions
+               const Value* Before = NULL;
+               const std::vector<const Value*>& Values = g->bbNodes[bb];
+               for(BasicBlock::const_iterator i(I); i != I->getParent()->end() && !Before; i++)
+                  if (std::find(Values.begin(), Values.end(), &*i) != Values.end()) Before = &*i;
+               DfgNode* N = g->getNode(I, g->getWidth(I), bb);
+               g->moveNode(N, bb, Before);
+               N->Predicate = g->BlockPredicates[bb];
+               for(unsigned int o = 0; o < 2; o++)
                {
-                  type = DfgNode::F_EDGE;
+                  const Value* Operand = getRealValue(I->getOperand(o));
+                  N->UseNodes.push_back(g->getNode(Operand, g->getWidth(Operand), bb));
                }
-               dfg->ControlNodes.push_back(DfgNode::Condition_t(src, type, 0));
             }
+            const Value* Index = getRealValue(*It);
+            if (!dyn_cast<BinaryOperator>(Index) || !g->isNode(Index)) continue;
+            DfgNode* N = g->getNode(Index);
+            if (std::find(Access->UseNodes.begin(), Access->UseNodes.end(), N) == Access->UseNodes.end())
+               Access->UseNodes.push_back(N);
          }
       }
    }
+   return g->Nodes.size() - NumNodes;
+}
 
-   errs() << "##\n\n";
+void DfgGeneration::releaseMemory()
+{
+   bool Cached = false;
+   for(std::map<const Function*, DfgGraph*>::iterator c = Callees.begin(); c != Callees.end(); c++)
+      Cached |= c->second == graph;
+   if (!Cached) delete graph;
+   graph = NULL;
+}
+
+bool DfgGeneration::doFinalization(Module &M)
+{
+   for(std::map<const Function*, DfgGraph*>::iterator c = Callees.begin(); c != Callees.end(); c++)
+      if (c->second != graph) delete c->second;
+   Callees.clear();
    return false;
 }
 
+DfgGraph* DfgGeneration::getCalleeGraph(const Function* F) const
+{
+   std::map<const Function*, DfgGraph*>::const_iterator c = Callees.find(F);
+   if (c == Callees.end()) return NULL;
+   return c->second;
+}
+
+/// returns the copy of a value of the callee; the instructions synthesized by the transformations of the callee DFG are copied on demand
+static Value* getCopy(DfgGraph* g, const Value* V, std::map<const Value*, Value*>& Copies, std::vector<Instruction*>& Copied, const std::string& Prefix)
+{
+   ///the placeholders of the callee DFG stand for the values of the callee
+   V = getOriginalValue(V);
+   std::map<const Value*, Value*>::iterator c = Copies.find(V);
+   if (c != Copies.end()) return c->second;
+   const Instruction* I = dyn_cast<Instruction>(V);
+   ///constants are shared, the globals are used through the placeholders of the caller DFG
+   if (!I || I->getParent()) return g->getPlaceholder(const_cast<Value*>(V));
+   Instruction* Copy = I->clone();
+   if (I->hasName()) Copy->setName(Prefix + I->getName().str());
+   Copies[V] = Copy;
+   Copied.push_back(Copy);
+   return Copy;
+}
+
+void DfgGeneration::flattenCall(DfgGraph* g, DfgNode* Call, std::map<DfgNode*, DfgNode*>& Replacement)
+{
+   DetermineBitWidth& BW = getAnalysis<DetermineBitWidth>();
+   const CallInst* C = dyn_cast<CallInst>(Call->Op);
+   const Function* Callee = C->getCalledFunction();
+   DfgGraph* CG = Call->Callee;
+   if (!CG || CG->bbReverseMap.size() != 1 || !CG->getLoops().empty())
+   {
+      errs() << " - call to " << (Callee ? Callee->getName() : "<indirect>") << " not flattened (DFG not available or with control flow)\n";
+      return;
+   }
+   unsigned int bb = g->bbMap[const_cast<BasicBlock*>(C->getParent())];
+   std::string Prefix = Callee->getName().str() + "." + utostr(Call->Id) + ".";
+
+   ///copies of the callee instructions, where the parameters are replaced by the actual arguments; the copies are
+   ///not part of the caller, so they use placeholders and the dependences on the caller are only in the UseNodes
+   std::map<const Value*, Value*> Copies;
+   std::vector<Instruction*> Copied;
+   unsigned int a = 0;
+   for(Function::const_arg_iterator A = Callee->arg_begin(); A != Callee->arg_end(); A++, a++)
+      Copies[&*A] = g->getPlaceholder(C->getArgOperand(a));
+   const BasicBlock& Body = Callee->getEntryBlock();
+   for(BasicBlock::const_iterator i = Body.begin(); i != Body.end(); i++)
+   {
+      if (dyn_cast<ReturnInst>(&*i)) continue;
+      Instruction* Copy = i->clone();
+      if (i->hasName()) Copy->setName(Prefix + i->getName().str());
+      Copies[&*i] = Copy;
+      Copied.push_back(Copy);
+   }
+
+   ///nodes of the copies, placed before the call
+   std::map<const DfgNode*, DfgNode*> Nodes;
+   const DfgNode* Ret = NULL;
+   const std::vector<const Value*>& Values = CG->getBbNode(1);
+   for(unsigned int v = 0; v < Values.size(); v++)
+   {
+      if (!CG->isNode(Values[v])) continue;
+      const DfgNode* N = CG->getNode(Values[v]);
+      if (N->Op != Values[v] || !dyn_cast<Instruction>(N->Op)) continue;
+      if (dyn_cast<ReturnInst>(N->Op))
+      {
+         Ret = N;
+         continue;
+      }
+      Instruction* Copy = dyn_cast<Instruction>(getCopy(g, N->Op, Copies, Copied, Prefix));
+      Nodes[N] = g->createNode(Copy, N->getWidth(), bb, C);
+      Nodes[N]->Predicate = Call->Predicate;
+   }
+   for(unsigned int c = 0; c < Copied.size(); c++)
+   {
+      for(unsigned int o = 0; o < Copied[c]->getNumOperands(); o++)
+         Copied[c]->setOperand(o, getCopy(g, Copied[c]->getOperand(o), Copies, Copied, Prefix));
+      if (!g->isNode(Copied[c])) g->addSynthesized(Copied[c]);
+   }
+
+   ///the dependences of the callee DFG, where the parameters are replaced by the nodes of the arguments
+   std::map<const DfgNode*, std::vector<DfgNode*> > Translation;
+   for(std::map<const DfgNode*, DfgNode*>::iterator n = Nodes.begin(); n != Nodes.end(); n++)
+      Translation[n->first].push_back(n->second);
+   std::vector<const DfgNode*> Users;
+   for(std::map<const DfgNode*, DfgNode*>::iterator n = Nodes.begin(); n != Nodes.end(); n++)
+      Users.push_back(n->first);
+   if (Ret) Users.push_back(Ret);
+   for(unsigned int n = 0; n < Users.size(); n++)
+   {
+      const std::vector<DfgNode*>& Uses = Users[n]->UseNodes;
+      for(unsigned int u = 0; u < Uses.size(); u++)
+      {
+         if (Translation.find(Uses[u]) != Translation.end()) continue;
+         std::vector<DfgNode*>& Translated = Translation[Uses[u]];
+         const Argument* A = dyn_cast<Argument>(Uses[u]->Op);
+         if (!A)
+         {
+            Translated.push_back(g->getNode(Uses[u]->Op, Uses[u]->getWidth(), bb));
+            continue;
+         }
+         const Value* Actual = getRealValue(C->getArgOperand(A->getArgNo()));
+         std::set<const Value*> ActualUses;
+         if (Actual->getType()->isPointerTy())
+            getMemoryUses(Actual, ActualUses);
+         else
+            ActualUses.insert(Actual);
+         for(std::set<const Value*>::iterator It = ActualUses.begin(); It != ActualUses.end(); It++)
+            Translated.push_back(g->getNode(*It, getValueWidth(BW, *It), bb));
+      }
+   }
+   for(std::map<const DfgNode*, DfgNode*>::iterator n = Nodes.begin(); n != Nodes.end(); n++)
+   {
+      const std::vector<DfgNode*>& Uses = n->first->UseNodes;
+      for(unsigned int u = 0; u < Uses.size(); u++)
+         n->second->UseNodes.insert(n->second->UseNodes.end(), Translation[Uses[u]].begin(), Translation[Uses[u]].end());
+   }
+
+   ///the returned value replaces the call
+   DfgNode* Result = NULL;
+   if (Ret && !Ret->UseNodes.empty() && !Translation[Ret->UseNodes[0]].empty())
+      Result = Translation[Ret->UseNodes[0]][0];
+   Replacement[Call] = Result;
+   errs() << " - call to " << Callee->getName() << " flattened: " << Nodes.size() << " nodes\n";
+}
+
+void DfgGeneration::updateParameters(DfgGraph* g, const std::set<DfgNode*>& Parameters)
+{
+   for(std::set<DfgNode*>::const_iterator p = Parameters.begin(); p != Parameters.end(); p++)
+   {
+      bool Read = false, Write = false;
+      for(unsigned int n = 0; n < g->Nodes.size(); n++)
+      {
+         DfgNode* N = g->Nodes[n];
+         if (std::find(N->UseNodes.begin(), N->UseNodes.end(), *p) == N->UseNodes.end()) continue;
+         if (N->Type == DfgNode::LOAD) Read = true;
+         if (N->Type == DfgNode::STORE) Write = true;
+         if (N->Type != DfgNode::CALL) continue;
+         ///direction of the corresponding parameters of the callee (both if its DFG is not available)
+         const CallInst* C = dyn_cast<CallInst>(N->Op);
+         const Function* Callee = C->getCalledFunction();
+         if (!N->Callee || !Callee)
+         {
+            Read = Write = true;
+            continue;
+         }
+         unsigned int a = 0;
+         for(Function::const_arg_iterator A = Callee->arg_begin(); A != Callee->arg_end(); A++, a++)
+         {
+            std::set<const Value*> Uses;
+            getMemoryUses(getRealValue(C->getArgOperand(a)), Uses);
+            if (Uses.find((*p)->Op) == Uses.end() || !N->Callee->isNode(&*A)) continue;
+            DfgNode::Type_t Type = N->Callee->getNode(&*A)->Type;
+            Read |= Type == DfgNode::IN_PARAM || Type == DfgNode::INOUT_PARAM;
+            Write |= Type == DfgNode::OUT_PARAM || Type == DfgNode::INOUT_PARAM;
+         }
+      }
+      if (Read && Write)
+         (*p)->Type = DfgNode::INOUT_PARAM;
+      else if (Write)
+         (*p)->Type = DfgNode::OUT_PARAM;
+      else
+         (*p)->Type = DfgNode::IN_PARAM;
+   }
+}
+
+void DfgGeneration::processLoop(DfgGraph* g, const Loop* L, int Parent)
+{
+   DfgLoop DL;
+   DL.Header = g->bbMap[L->getHeader()];
+   DL.Depth = L->getLoopDepth();
+   DL.Parent = Parent;
+   DL.Innermost = L->empty();
+   for(Loop::block_iterator b = L->block_begin(); b != L->block_end(); b++)
+      DL.Blocks.push_back(g->bbMap[*b]);
+   int Idx = g->Loops.size();
+   g->Loops.push_back(DL);
+   for(Loop::iterator l = L->begin(); l != L->end(); l++)
+      processLoop(g, *l, Idx);
+}
+
+void DfgGeneration::processPhi(DfgGraph* g, PHINode* P)
+{
+   DetermineBitWidth& BW = getAnalysis<DetermineBitWidth>();
+   LoopInfo& LI = getAnalysis<LoopInfo>();
+
+   DfgNode* src = g->getNode(P);
+   for(unsigned int i = 0; i < P->getNumIncomingValues(); i++)
+   {
+      const Value* val = getRealValue(P->getIncomingValue(i));
+      if (dyn_cast<UndefValue>(val)) continue;
+      BasicBlock* From = P->getIncomingBlock(i);
+      unsigned int bbIdx = dyn_cast<Instruction>(val) ? g->bbMap[const_cast<BasicBlock*>(dyn_cast<Instruction>(val)->getParent())] : g->bbMap[From];
+      DfgNode* tgt = g->getNode(val, BW.getBitWidth(val), bbIdx);
+      if (isBackEdge(LI, From, P->getParent()))
+         src->CarriedNodes.push_back(DfgNode::Carried_t(tgt, 1));
+      else
+         src->UseNodes.push_back(tgt);
+   }
+}
+
 DfgNode* DfgGeneration::processInstruction(DfgGraph* g, Instruction* I, unsigned int bbIdx)
 {
    DetermineBitWidth& BW = getAnalysis<DetermineBitWidth>();
@@ -143,15 +659,22 @@ DfgNode* DfgGeneration::processInstruction(DfgGraph* g, Instruction* I, unsigned
       }
       case Instruction::GetElementPtr:
       {
+         ///the index computations are not nodes: their widths (and those of their operands) are recorded
+         ///for the evaluation of the addresses and for addIndexNodes
          const GetElementPtrInst* ptr = dyn_cast<GetElementPtrInst>(I);
          std::list<const Value*> Operations;
          for(GetElementPtrInst::const_op_iterator It = ptr->idx_begin(); It != ptr->idx_end(); It++)
          {
-            getMemoryOps(*It, Operations);
+            getMemoryOps(getRealValue(*It), Operations);
          }
          for(std::list<const Value*>::iterator op = Operations.begin(); op != Operations.end(); op++)
          {
             graph->bitWidth[*op] = BW.getBitWidth(*op);
+            for(unsigned int o = 0; o < 2; o++)
+            {
+               const Value* Operand = getRealValue(dyn_cast<BinaryOperator>(*op)->getOperand(o));
+               if (!graph->hasWidth(Operand)) graph->bitWidth[Operand] = getValueWidth(BW, Operand);
+            }
          }
          return 0;
       }
@@ -220,6 +743,50 @@ DfgNode* DfgGeneration::processInstruction(DfgGraph* g, Instruction* I, unsigned
          src->UseNodes.push_back(tgt);
          break;
       }
+      case Instruction::Ret:
+      {
+         const Value* val = getRealValue(dyn_cast<ReturnInst>(I)->getReturnValue());
+         tgt = g->getNode(val, BW.getBitWidth(val), bbIdx);
+         src->UseNodes.push_back(tgt);
+         break;
+      }
+      case Instruction::Call:
+      {
+         const CallInst* Call = dyn_cast<CallInst>(I);
+         if (!Call->getCalledFunction())
+            errs() << "WARNING: indirect call " << I->getName() << "\n";
+         src->Callee = getCalleeGraph(Call->getCalledFunction());
+         if (Call->getCalledFunction() && !src->Callee)
+            errs() << "WARNING: DFG of " << Call->getCalledFunction()->getName() << " not available (defined after its caller)\n";
+         for(unsigned int a = 0; a < Call->getNumArgOperands(); a++)
+         {
+            const Value* Arg = getRealValue(Call->getArgOperand(a));
+            if (!Arg->getType()->isPointerTy())
+            {
+               tgt = g->getNode(Arg, BW.getBitWidth(Arg), bbIdx);
+               src->UseNodes.push_back(tgt);
+               continue;
+            }
+            ///the memory passed to the callee
+            std::set<const Value*> Uses;
+            getMemoryUses(Arg, Uses);
+            for(std::set<const Value*>::iterator It = Uses.begin(); It != Uses.end(); It++)
+            {
+               tgt = g->getNode(*It, BW.getBitWidth(*It), bbIdx);
+               src->UseNodes.push_back(tgt);
+            }
+            if (dyn_cast<GetElementPtrInst>(Arg))
+               processInstruction(g, const_cast<Instruction*>(dyn_cast<Instruction>(Arg)), bbIdx);
+         }
+         break;
+      }
+      case Instruction::Switch:
+      {
+         const Value* val = getRealValue(dyn_cast<SwitchInst>(I)->getCondition());
+         tgt = g->getNode(val, BW.getBitWidth(val), bbIdx);
+         src->UseNodes.push_back(tgt);
+         break;
+      }
       case Instruction::Br:
       case Instruction::Trunc:
       case Instruction::ZExt:
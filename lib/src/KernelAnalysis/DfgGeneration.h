@@ -32,11 +32,17 @@
 #include "llvm/Pass.h"
 #include "llvm/Function.h"
 
+#include <map>
+#include <set>
+
 namespace llvm {
 
 class DfgGraph;
 class DfgNode;
+class DominatorTree;
 class Instruction;
+class Loop;
+class PHINode;
 
   // DfgGeneration
   struct DfgGeneration : public FunctionPass {
@@ -48,11 +54,53 @@ class Instruction;
 
     virtual bool runOnFunction(Function &F);
 
+    /// deletes the DFGs of the called functions
+    virtual bool doFinalization(Module &M);
+
+    /// deletes the DFG of the last function, unless it is called by other functions
+    virtual void releaseMemory();
+
+    /// returns the DFG of a function called by the kernels (NULL if not generated yet)
+    DfgGraph* getCalleeGraph(const Function* F) const;
+
     DfgNode* processInstruction(DfgGraph* g, Instruction *I, unsigned int bbIdx);
 
+    /// connects the phi node to its incoming values; those coming from the back edges of a loop are loop-carried
+    void processPhi(DfgGraph* g, PHINode* P);
+
+    /// records the loop and its subloops in the DFG
+    void processLoop(DfgGraph* g, const Loop* L, int Parent);
+
+    /// merges the structurally equivalent nodes (same opcode, width and operands) whose basic block
+    /// dominates the one of the duplicate, returns the number of removed nodes (Addresses counts
+    /// those computing the index of an access)
+    unsigned int mergeEquivalentNodes(DfgGraph* g, Function& F, DominatorTree& DT, unsigned int& Addresses);
+
+    /// returns true if the equivalent nodes are merged (-dfg-hash-consing)
+    bool isHashConsing() const;
+
+    /// adds the index computations of the loads, stores and calls as nodes of their basic block, used by
+    /// their accesses (only requested by the access partition); returns the number of new nodes. The
+    /// graph has to be finalized again
+    unsigned int addIndexNodes(DfgGraph* g);
+
+    /// computes the control dependences of the basic blocks (post-dominator tree) and the predicates of the nodes
+    void computePredicates(DfgGraph* g, Function& F);
+
+    /// replaces the call node with a copy of the callee DFG (with renamed values), if the callee has a single basic block
+    void flattenCall(DfgGraph* g, DfgNode* Call, std::map<DfgNode*, DfgNode*>& Replacement);
+
+    /// computes the direction of the pointer parameters, including the accesses of the called functions
+    void updateParameters(DfgGraph* g, const std::set<DfgNode*>& Parameters);
+
     // We don't modify the program, so we preserve all analyses
     virtual void getAnalysisUsage(AnalysisUsage &AU) const;
 
+    private:
+
+      ///DFGs of the functions called by the kernels, generated once and shared by all the call nodes
+      std::map<const Function*, DfgGraph*> Callees;
+
   };
 }
 
@@ -0,0 +1,270 @@
+/**
+ * The MIT License (MIT)
+ * 
+ * Copyright (c) 2013 cad-projects
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+/**
+ * Author: Christian Pilato <christian.pilato@polimi.it>
+ *
+ * Description: Implementation of the if-conversion of the DFG. A diamond is a
+ *              conditional branch whose two successors have it as the only
+ *              predecessor and jump to the same join block (a triangle when one
+ *              of the successors is the join itself). The branches are converted
+ *              if they contain neither loads nor calls and each store of a
+ *              branch writes the same address (same affine form) of a store of
+ *              the other one. The operations of the branches are moved to the
+ *              head block and executed unconditionally, each pair of stores is
+ *              replaced by a single store of a multiplexer and the phi nodes of
+ *              the join by multiplexers. A diamond is converted only if the area
+ *              of the speculated operations and of the multiplexers (from the
+ *              operator library) is at most -if-conversion-max-area.
+ */
+#include "DfgIfConversion.h"
+
+#include "cad/Config.h"
+
+#include "AffineIndex.h"
+#include "Dfg.h"
+#include "DfgGeneration.h"
+
+#define DEBUG_TYPE "dfg-if-conversion"
+#include "llvm/Constants.h"
+#include "llvm/Instructions.h"
+#include "llvm/Support/CFG.h"
+#include "llvm/Support/CommandLine.h"
+#include "llvm/Support/raw_ostream.h"
+#include "llvm/ADT/Statistic.h"
+
+STATISTIC(ConvertedDiamonds, "[CAD] Number of diamonds if-converted in the DFG");
+STATISTIC(MergedStores, "[CAD] Number of pairs of conditional stores merged by the if-conversion");
+
+using namespace llvm;
+using namespace cadlib;
+
+static cl::opt<double> ifConversionArea("if-conversion-max-area",
+  cl::desc("[CAD] Maximum area of the operations speculated and of the multiplexers added by the if-conversion of a diamond"),
+  cl::init(256));
+
+void DfgIfConversion::getAnalysisUsage(AnalysisUsage &AU) const
+{
+   AU.addRequired<DfgGeneration>();
+   AU.addRequired<AffineIndex>();
+   AU.setPreservesAll();
+}
+
+char DfgIfConversion::ID = 0;
+static const char dfg_if_conversion_name[] = "[CAD] DFG If-Conversion";
+INITIALIZE_PASS_BEGIN(DfgIfConversion, DEBUG_TYPE, dfg_if_conversion_name, false, false)
+INITIALIZE_PASS_DEPENDENCY(DfgGeneration)
+INITIALIZE_PASS_DEPENDENCY(AffineIndex)
+INITIALIZE_PASS_END(DfgIfConversion, DEBUG_TYPE, dfg_if_conversion_name, false, false)
+
+Pass* createDfgIfConversionPass() {
+   return new DfgIfConversion;
+}
+
+bool DfgIfConversion::doInitialization(Module &M)
+{
+   if (configFile.size())
+      Library.parseConfig(configFile);
+   return false;
+}
+
+/// returns the successor of a branch of the diamond: B has to be reached only from Head and end with an unconditional jump
+static BasicBlock* getBranchSuccessor(BasicBlock* B, BasicBlock* Head)
+{
+   if (B->getSinglePredecessor() != Head) return NULL;
+   const BranchInst* br = dyn_cast<BranchInst>(B->getTerminator());
+   if (!br || br->isConditional()) return NULL;
+   return br->getSuccessor(0);
+}
+
+/// returns the node of a value, created in the basic block bb for the constants
+static DfgNode* getValueNode(DfgGraph* graph, const Value* V, unsigned int bb)
+{
+   V = getRealValue(V);
+   if (graph->isNode(V)) return graph->getNode(V);
+   unsigned int Width = dyn_cast<ConstantInt>(V) ? getConstantWidth(dyn_cast<ConstantInt>(V)->getSExtValue()) : V->getType()->getPrimitiveSizeInBits();
+   return graph->getNode(V, Width, bb);
+}
+
+bool DfgIfConversion::runOnFunction(Function &F)
+{
+   if (std::find(functionNames.begin(), functionNames.end(), F.getName()) == functionNames.end())
+      return false;
+
+   errs() << "DFG If-Conversion: #" << F.getName() << "#\n";
+   DfgGeneration& DG = getAnalysis<DfgGeneration>();
+   DfgGraph* graph = DG.graph;
+   if (!graph) return false;
+
+   Replacement.clear();
+   for(Function::iterator b = F.begin(); b != F.end(); b++)
+   {
+      BasicBlock* Head = &*b;
+      const BranchInst* br = dyn_cast<BranchInst>(Head->getTerminator());
+      if (!br || !br->isConditional() || !graph->isNode(br->getCondition())) continue;
+      BasicBlock* True = br->getSuccessor(0);
+      BasicBlock* False = br->getSuccessor(1);
+      BasicBlock* TrueNext = getBranchSuccessor(True, Head);
+      BasicBlock* FalseNext = getBranchSuccessor(False, Head);
+      BasicBlock* Join = NULL;
+      if (TrueNext && TrueNext == FalseNext)
+         Join = TrueNext;
+      else if (TrueNext == False)
+         Join = False;
+      else if (FalseNext == True)
+         Join = True;
+      if (!Join || Join == Head || std::distance(pred_begin(Join), pred_end(Join)) != 2) continue;
+      if (convert(graph, Head, True, False, Join))
+         ++ConvertedDiamonds;
+   }
+
+   graph->replaceNodes(Replacement);
+   graph->finalize();
+   errs() << "##\n\n";
+   return false;
+}
+
+bool DfgIfConversion::collectBranch(DfgGraph* graph, BasicBlock* B, std::vector<DfgNode*>& Ops, std::vector<DfgNode*>& Stores) const
+{
+   const std::map<unsigned int, std::vector<const Value*> >& bbNodes = graph->getBbNodes();
+   std::map<unsigned int, std::vector<const Value*> >::const_iterator Values = bbNodes.find(graph->getBbIdx(B));
+   if (Values == bbNodes.end()) return true;
+   for(unsigned int v = 0; v < Values->second.size(); v++)
+   {
+      if (!graph->isNode(Values->second[v])) continue;
+      DfgNode* N = graph->getNode(Values->second[v]);
+      if (N->Op != Values->second[v]) continue;
+      ///the loads may access invalid addresses when speculated
+      if (N->Type == DfgNode::LOAD || N->Type == DfgNode::CALL || dyn_cast<PHINode>(N->Op) || dyn_cast<SwitchInst>(N->Op)) return false;
+      if (N->Type == DfgNode::STORE)
+         Stores.push_back(N);
+      else
+         Ops.push_back(N);
+   }
+   return true;
+}
+
+DfgNode* DfgIfConversion::createSelect(DfgGraph* graph, Value* Condition, Value* True, Value* False, const Twine& Name, unsigned int bb, unsigned int Predicate)
+{
+   DfgNode* TrueNode = getValueNode(graph, True, bb);
+   DfgNode* FalseNode = getValueNode(graph, False, bb);
+   SelectInst* Sel = SelectInst::Create(graph->getPlaceholder(Condition), graph->getPlaceholder(True), graph->getPlaceholder(False), Name);
+   DfgNode* Node = graph->createNode(Sel, std::max(TrueNode->getWidth(), FalseNode->getWidth()), bb, NULL);
+   Node->UseNodes.push_back(graph->getNode(Condition));
+   Node->UseNodes.push_back(TrueNode);
+   Node->UseNodes.push_back(FalseNode);
+   Node->Predicate = Predicate;
+   return Node;
+}
+
+bool DfgIfConversion::convert(DfgGraph* graph, BasicBlock* Head, BasicBlock* True, BasicBlock* False, BasicBlock* Join)
+{
+   AffineIndex& AI = getAnalysis<AffineIndex>();
+   Value* Condition = dyn_cast<BranchInst>(Head->getTerminator())->getCondition();
+   errs() << " - " << Head->getName() << " -> (" << True->getName() << ", " << False->getName() << ") -> " << Join->getName() << ": ";
+
+   std::vector<DfgNode*> Ops, TrueStores, FalseStores;
+   if ((True != Join && !collectBranch(graph, True, Ops, TrueStores)) || (False != Join && !collectBranch(graph, False, Ops, FalseStores)))
+   {
+      errs() << "kept (loads or calls)\n";
+      return false;
+   }
+
+   ///each store of a branch has to write the same address of a store of the other branch
+   std::vector<std::pair<DfgNode*, DfgNode*> > Pairs;
+   std::vector<bool> Matched(FalseStores.size(), false);
+   for(unsigned int t = 0; t < TrueStores.size(); t++)
+   {
+      const StoreInst* TrueStore = dyn_cast<StoreInst>(TrueStores[t]->Op);
+      for(unsigned int f = 0; f < FalseStores.size() && Pairs.size() == t; f++)
+      {
+         const StoreInst* FalseStore = dyn_cast<StoreInst>(FalseStores[f]->Op);
+         int64_t Distance = 0;
+         if (Matched[f] || TrueStore->getValueOperand()->getType() != FalseStore->getValueOperand()->getType()) continue;
+         if (!AI.getDistance(TrueStore->getPointerOperand(), FalseStore->getPointerOperand(), Distance) || Distance != 0) continue;
+         Matched[f] = true;
+         Pairs.push_back(std::make_pair(TrueStores[t], FalseStores[f]));
+      }
+   }
+   if (Pairs.size() != TrueStores.size() || Pairs.size() != FalseStores.size())
+   {
+      errs() << "kept (stores to different addresses)\n";
+      return false;
+   }
+
+   std::vector<PHINode*> Phis;
+   for(BasicBlock::iterator i = Join->begin(); dyn_cast<PHINode>(i); i++)
+      if (graph->isNode(&*i)) Phis.push_back(dyn_cast<PHINode>(i));
+
+   double Area = 0;
+   for(unsigned int o = 0; o < Ops.size(); o++)
+      Area += Library.getArea(OperatorLibrary::getOpcode(Ops[o]->Op), Ops[o]->getWidth());
+   for(unsigned int p = 0; p < Pairs.size(); p++)
+      Area += Library.getArea("select", Pairs[p].first->getWidth());
+   for(unsigned int p = 0; p < Phis.size(); p++)
+      Area += Library.getArea("select", graph->getNode(Phis[p])->getWidth());
+   if (Area > ifConversionArea)
+   {
+      errs() << "kept (area = " << Area << ")\n";
+      return false;
+   }
+
+   ///the operations of the branches are executed at the end of the head, under its execution condition
+   unsigned int bb = graph->getBbIdx(Head);
+   unsigned int Predicate = graph->getBlockPredicate(bb);
+   for(unsigned int o = 0; o < Ops.size(); o++)
+   {
+      graph->moveNode(Ops[o], bb, NULL);
+      Ops[o]->Predicate = Predicate;
+   }
+   for(unsigned int p = 0; p < Pairs.size(); p++)
+   {
+      StoreInst* TrueStore = const_cast<StoreInst*>(dyn_cast<StoreInst>(Pairs[p].first->Op));
+      StoreInst* FalseStore = const_cast<StoreInst*>(dyn_cast<StoreInst>(Pairs[p].second->Op));
+      DfgNode* Sel = createSelect(graph, Condition, TrueStore->getValueOperand(), FalseStore->getValueOperand(), "mux", bb, Predicate);
+      Instruction* Store = new StoreInst(const_cast<Value*>(Sel->Op), graph->getPlaceholder(TrueStore->getPointerOperand()));
+      DfgNode* StoreNode = graph->createNode(Store, Pairs[p].first->getWidth(), bb, NULL);
+      ///the merged store uses the same memory and index variables of the stores of the branches
+      bool ValueFound = false;
+      DfgNode* TrueValue = graph->getNode(getRealValue(TrueStore->getValueOperand()));
+      for(unsigned int u = 0; u < Pairs[p].first->UseNodes.size(); u++)
+      {
+         if (!ValueFound && Pairs[p].first->UseNodes[u] == TrueValue)
+            ValueFound = true;
+         else
+            StoreNode->UseNodes.push_back(Pairs[p].first->UseNodes[u]);
+      }
+      StoreNode->UseNodes.push_back(Sel);
+      StoreNode->Predicate = Predicate;
+      Replacement[Pairs[p].first] = StoreNode;
+      Replacement[Pairs[p].second] = StoreNode;
+      ++MergedStores;
+   }
+   for(unsigned int p = 0; p < Phis.size(); p++)
+   {
+      Value* TrueValue = Phis[p]->getIncomingValueForBlock(True == Join ? Head : True);
+      Value* FalseValue = Phis[p]->getIncomingValueForBlock(False == Join ? Head : False);
+      Replacement[graph->getNode(Phis[p])] = createSelect(graph, Condition, TrueValue, FalseValue, Phis[p]->getName() + ".mux", bb, Predicate);
+   }
+   errs() << Ops.size() << " operations speculated, " << Pairs.size() << " stores merged, " << Phis.size() << " phi nodes replaced (area = " << Area << ")\n";
+   return true;
+}
@@ -0,0 +1,80 @@
+/**
+ * The MIT License (MIT)
+ * 
+ * Copyright (c) 2013 cad-projects
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+/**
+ * Author: Christian Pilato <christian.pilato@polimi.it>
+ *
+ * Description: This class defines the DFG transformation that if-converts the
+ *              short diamonds (and triangles) of the control flow: the
+ *              operations of the branches are speculated, the stores of the
+ *              same address and the phi nodes of the join are replaced by
+ *              multiplexers (select nodes)
+ */
+#ifndef DFGIFCONVERSION_H
+#define DFGIFCONVERSION_H
+
+#include "OperatorLibrary.h"
+
+#include "llvm/Pass.h"
+#include "llvm/Function.h"
+
+#include <map>
+#include <vector>
+
+namespace llvm {
+
+class BasicBlock;
+class Twine;
+class DfgGraph;
+struct DfgNode;
+
+  // DfgIfConversion
+  struct DfgIfConversion : public FunctionPass {
+    static char ID; // Pass identification, replacement for typeid
+    DfgIfConversion() : FunctionPass(ID) {}
+
+    OperatorLibrary Library;
+
+    virtual bool doInitialization(Module &M);
+
+    virtual bool runOnFunction(Function &F);
+
+    void getAnalysisUsage(AnalysisUsage &AU) const;
+
+    private:
+
+      /// if-converts the diamond (or triangle, if one of the branches is the join) starting from Head;
+      /// returns false if the diamond is not convertible or too expensive
+      bool convert(DfgGraph* graph, BasicBlock* Head, BasicBlock* True, BasicBlock* False, BasicBlock* Join);
+
+      /// collects the operations and the stores of a branch; returns false if they cannot be speculated
+      bool collectBranch(DfgGraph* graph, BasicBlock* B, std::vector<DfgNode*>& Ops, std::vector<DfgNode*>& Stores) const;
+
+      /// creates the multiplexer selecting between the two values, at the end of the basic block bb
+      DfgNode* createSelect(DfgGraph* graph, Value* Condition, Value* True, Value* False, const Twine& Name, unsigned int bb, unsigned int Predicate);
+
+      ///nodes replaced by the transformation
+      std::map<DfgNode*, DfgNode*> Replacement;
+  };
+}
+
+#endif
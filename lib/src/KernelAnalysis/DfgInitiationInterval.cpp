@@ -0,0 +1,249 @@
+/**
+ * The MIT License (MIT)
+ * 
+ * Copyright (c) 2013 cad-projects
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+/**
+ * Author: Christian Pilato <christian.pilato@polimi.it>
+ *
+ * Description: Implementation of the initiation interval analysis. For each
+ *              innermost loop, the resource-constrained bound (ResMII) is the
+ *              maximum ratio between the operations of an opcode (accesses of a
+ *              memory) and the available units (ports). The recurrence bound
+ *              (RecMII) is the minimum II such that no dependence cycle has a
+ *              latency larger than II times its iteration distance, i.e. no
+ *              positive cycle with weights latency - II * distance: the bound
+ *              is found by binary search, checking each II with Bellman-Ford.
+ *              Loads and stores of the same memory are conservatively assumed
+ *              to depend on each other across consecutive iterations.
+ */
+#include "DfgInitiationInterval.h"
+
+#include "cad/Config.h"
+
+#include "Dfg.h"
+#include "DfgGeneration.h"
+
+#define DEBUG_TYPE "dfg-initiation-interval"
+#include "llvm/Instructions.h"
+#include "llvm/Support/raw_ostream.h"
+
+#include <set>
+
+using namespace llvm;
+using namespace cadlib;
+
+void DfgInitiationInterval::getAnalysisUsage(AnalysisUsage &AU) const
+{
+   AU.addRequired<DfgGeneration>();
+   AU.setPreservesAll();
+}
+
+char DfgInitiationInterval::ID = 0;
+static const char dfg_initiation_interval_name[] = "[CAD] DFG Initiation Interval Analysis";
+INITIALIZE_PASS_BEGIN(DfgInitiationInterval, DEBUG_TYPE, dfg_initiation_interval_name, false, false)
+INITIALIZE_PASS_DEPENDENCY(DfgGeneration)
+INITIALIZE_PASS_END(DfgInitiationInterval, DEBUG_TYPE, dfg_initiation_interval_name, false, false)
+
+Pass* createDfgInitiationIntervalPass() {
+   return new DfgInitiationInterval;
+}
+
+bool DfgInitiationInterval::doInitialization(Module &M)
+{
+   if (configFile.size())
+      Library.parseConfig(configFile);
+   return false;
+}
+
+bool DfgInitiationInterval::runOnFunction(Function &F)
+{
+   if (std::find(functionNames.begin(), functionNames.end(), F.getName()) == functionNames.end())
+      return false;
+
+   errs() << "DFG Initiation Interval: #" << F.getName() << "#\n";
+   DfgGeneration& DG = getAnalysis<DfgGeneration>();
+   DfgGraph* graph = DG.graph;
+   RecMII.clear();
+   ResMII.clear();
+   if (!graph) return false;
+
+   const std::vector<DfgLoop>& Loops = graph->getLoops();
+   for(unsigned int l = 0; l < Loops.size(); l++)
+   {
+      if (!Loops[l].Innermost) continue;
+      analyzeLoop(graph, l);
+      errs() << " - loop " << l << " (header = " << Loops[l].Header << ", depth = " << Loops[l].Depth << "): ";
+      errs() << "RecMII = " << RecMII[l] << ", ResMII = " << ResMII[l] << ", MII = " << getMII(l) << "\n";
+   }
+
+   errs() << "##\n\n";
+   return false;
+}
+
+void DfgInitiationInterval::analyzeLoop(DfgGraph* graph, unsigned int Loop)
+{
+   const DfgLoop& L = graph->getLoops()[Loop];
+
+   ///operations of the loop body
+   std::vector<DfgNode*> Ops;
+   std::map<unsigned int, unsigned int> LocalIdx;
+   const std::map<unsigned int, std::vector<const Value*> >& bbNodes = graph->getBbNodes();
+   for(unsigned int b = 0; b < L.Blocks.size(); b++)
+   {
+      if (bbNodes.find(L.Blocks[b]) == bbNodes.end()) continue;
+      const std::vector<const Value*>& Values = bbNodes.find(L.Blocks[b])->second;
+      for(unsigned int v = 0; v < Values.size(); v++)
+      {
+         if (!dyn_cast<Instruction>(Values[v]) || !graph->isNode(Values[v])) continue;
+         DfgNode* n = graph->getNode(Values[v]);
+         if (LocalIdx.find(n->Id) != LocalIdx.end()) continue;
+         LocalIdx[n->Id] = Ops.size();
+         Ops.push_back(n);
+      }
+   }
+   unsigned int NumOps = Ops.size();
+
+   std::vector<unsigned int> Lat(NumOps, 0);
+   std::vector<Dependence> Dependences;
+   std::map<std::string, unsigned int> OpCount;
+   std::map<const Value*, std::vector<unsigned int> > Loads;
+   std::map<const Value*, std::vector<unsigned int> > Stores;
+   unsigned int TotalLatency = 0;
+   for(unsigned int i = 0; i < NumOps; i++)
+   {
+      DfgNode* n = Ops[i];
+      std::string Opcode = OperatorLibrary::getOpcode(n->Op);
+      Lat[i] = Library.getLatency(Opcode, n->getWidth());
+      TotalLatency += Lat[i];
+      if (n->Type == DfgNode::LOAD)
+         Loads[getMemoryVar(dyn_cast<LoadInst>(n->Op)->getPointerOperand())].push_back(i);
+      else if (n->Type == DfgNode::STORE)
+         Stores[getMemoryVar(dyn_cast<StoreInst>(n->Op)->getPointerOperand())].push_back(i);
+      else
+         OpCount[Opcode]++;
+   }
+
+   unsigned int Carried = 0;
+   for(unsigned int i = 0; i < NumOps; i++)
+   {
+      DfgNode* n = Ops[i];
+      for(DfgGraph::node_iterator p = graph->pred_begin(n); p != graph->pred_end(n); p++)
+      {
+         std::map<unsigned int, unsigned int>::iterator l = LocalIdx.find((*p)->Id);
+         if (l == LocalIdx.end()) continue;
+         Dependence D = { l->second, i, Lat[l->second], 0 };
+         Dependences.push_back(D);
+      }
+      for(unsigned int c = 0; c < n->CarriedNodes.size(); c++)
+      {
+         std::map<unsigned int, unsigned int>::iterator l = LocalIdx.find(n->CarriedNodes[c].first->Id);
+         if (l == LocalIdx.end()) continue;
+         Dependence D = { l->second, i, Lat[l->second], n->CarriedNodes[c].second };
+         Dependences.push_back(D);
+         Carried++;
+      }
+   }
+   ///a value stored in an iteration may be loaded by the next one
+   for(std::map<const Value*, std::vector<unsigned int> >::iterator s = Stores.begin(); s != Stores.end(); s++)
+   {
+      if (Loads.find(s->first) == Loads.end()) continue;
+      const std::vector<unsigned int>& MemLoads = Loads[s->first];
+      for(unsigned int st = 0; st < s->second.size(); st++)
+      {
+         for(unsigned int ld = 0; ld < MemLoads.size(); ld++)
+         {
+            Dependence D = { s->second[st], MemLoads[ld], Lat[s->second[st]], 1 };
+            Dependences.push_back(D);
+            Carried++;
+         }
+      }
+   }
+
+   ///each iteration needs at least one cycle
+   unsigned int Resource = 1;
+   for(std::map<std::string, unsigned int>::iterator o = OpCount.begin(); o != OpCount.end(); o++)
+   {
+      unsigned int Units = Library.getUnits(o->first);
+      if (Units) Resource = std::max(Resource, (o->second + Units - 1) / Units);
+   }
+   std::set<const Value*> Memories;
+   for(std::map<const Value*, std::vector<unsigned int> >::iterator l = Loads.begin(); l != Loads.end(); l++)
+      Memories.insert(l->first);
+   for(std::map<const Value*, std::vector<unsigned int> >::iterator s = Stores.begin(); s != Stores.end(); s++)
+      Memories.insert(s->first);
+   unsigned int Ports = Library.getMemoryPorts();
+   for(std::set<const Value*>::iterator m = Memories.begin(); m != Memories.end(); m++)
+   {
+      unsigned int Accesses = Loads[*m].size() + Stores[*m].size();
+      Resource = std::max(Resource, (Accesses + Ports - 1) / Ports);
+   }
+   ResMII[Loop] = Resource;
+
+   ///any cycle has distance at least one and latency at most the sum of the latencies
+   unsigned int Low = 1, High = std::max(1U, TotalLatency);
+   if (!Carried) High = 1;
+   while (Low < High)
+   {
+      unsigned int II = (Low + High) / 2;
+      if (isFeasible(NumOps, Dependences, II))
+         High = II;
+      else
+         Low = II + 1;
+   }
+   RecMII[Loop] = Low;
+}
+
+bool DfgInitiationInterval::isFeasible(unsigned int NumOps, const std::vector<Dependence>& Dependences, unsigned int II)
+{
+   ///longest paths with weights latency - II * distance: they converge iff there is no positive cycle
+   std::vector<int64_t> Dist(NumOps, 0);
+   for(unsigned int It = 0; It <= NumOps; It++)
+   {
+      bool Changed = false;
+      for(unsigned int d = 0; d < Dependences.size(); d++)
+      {
+         const Dependence& D = Dependences[d];
+         int64_t Weight = (int64_t)D.Latency - (int64_t)II * D.Distance;
+         if (Dist[D.From] + Weight <= Dist[D.To]) continue;
+         Dist[D.To] = Dist[D.From] + Weight;
+         Changed = true;
+      }
+      if (!Changed) return true;
+   }
+   return false;
+}
+
+bool DfgInitiationInterval::isAnalyzed(unsigned int Loop) const
+{
+   return RecMII.find(Loop) != RecMII.end();
+}
+
+unsigned int DfgInitiationInterval::getRecMII(unsigned int Loop) const
+{
+   assert(isAnalyzed(Loop) && "loop not analyzed");
+   return RecMII.find(Loop)->second;
+}
+
+unsigned int DfgInitiationInterval::getResMII(unsigned int Loop) const
+{
+   assert(isAnalyzed(Loop) && "loop not analyzed");
+   return ResMII.find(Loop)->second;
+}
@@ -0,0 +1,95 @@
+/**
+ * The MIT License (MIT)
+ * 
+ * Copyright (c) 2013 cad-projects
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+/**
+ * Author: Christian Pilato <christian.pilato@polimi.it>
+ *
+ * Description: This class defines the pass for computing the minimum initiation
+ *              interval of the innermost loops of the DFG (recurrence-constrained
+ *              and resource-constrained bounds for the loop pipelining)
+ */
+#ifndef DFGINITIATIONINTERVAL_H
+#define DFGINITIATIONINTERVAL_H
+
+#include "OperatorLibrary.h"
+
+#include "llvm/Pass.h"
+#include "llvm/Function.h"
+
+#include <algorithm>
+#include <map>
+#include <vector>
+
+namespace llvm {
+
+class DfgGraph;
+struct DfgNode;
+
+  // DfgInitiationInterval
+  struct DfgInitiationInterval : public FunctionPass {
+    static char ID; // Pass identification, replacement for typeid
+    DfgInitiationInterval() : FunctionPass(ID) {}
+
+    OperatorLibrary Library;
+
+    virtual bool doInitialization(Module &M);
+
+    virtual bool runOnFunction(Function &F);
+
+    void getAnalysisUsage(AnalysisUsage &AU) const;
+
+    /// returns true if the initiation interval of the loop (position in DfgGraph::getLoops()) has been computed
+    bool isAnalyzed(unsigned int Loop) const;
+
+    /// returns the minimum initiation interval allowed by the loop-carried dependences
+    unsigned int getRecMII(unsigned int Loop) const;
+
+    /// returns the minimum initiation interval allowed by the functional units and the memory ports
+    unsigned int getResMII(unsigned int Loop) const;
+
+    unsigned int getMII(unsigned int Loop) const
+    {
+       return std::max(getRecMII(Loop), getResMII(Loop));
+    }
+
+    private:
+
+      ///dependence between two operations of the loop, from an iteration to the Distance-th next one
+      struct Dependence
+      {
+         unsigned int From;
+         unsigned int To;
+         unsigned int Latency;
+         unsigned int Distance;
+      };
+
+      void analyzeLoop(DfgGraph* graph, unsigned int Loop);
+
+      /// returns true if no recurrence requires more than II cycles per iteration
+      static bool isFeasible(unsigned int NumOps, const std::vector<Dependence>& Dependences, unsigned int II);
+
+      std::map<unsigned int, unsigned int> RecMII;
+      std::map<unsigned int, unsigned int> ResMII;
+  };
+}
+
+#endif
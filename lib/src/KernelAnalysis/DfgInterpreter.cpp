@@ -0,0 +1,349 @@
+/**
+ * The MIT License (MIT)
+ * 
+ * Copyright (c) 2013 cad-projects
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+/**
+ * Author: Christian Pilato <christian.pilato@polimi.it>
+ *
+ * Description: Implementation of the DFG interpreter. The basic blocks are
+ *              executed following the branches of the function: the phi nodes
+ *              take the value of the incoming edge, then the other nodes of the
+ *              block are evaluated in topological order. Each value is kept as
+ *              a 64-bit integer sign-extended from the width of its node; the
+ *              zero extensions, sign extensions and truncations removed from the
+ *              DFG are applied when the value is used.
+ */
+#include "DfgInterpreter.h"
+
+#include "cad/Support.h"
+
+#include "llvm/BasicBlock.h"
+#include "llvm/Constants.h"
+#include "llvm/DerivedTypes.h"
+#include "llvm/Function.h"
+#include "llvm/Instructions.h"
+#include "llvm/Support/raw_ostream.h"
+
+using namespace llvm;
+using namespace cadlib;
+
+uint64_t DfgInterpreter::getTypeBytes(Type* Ty)
+{
+   uint64_t Bytes = cadlib::getTypeBytes(Ty);
+   if (!Bytes)
+   {
+      errs() << "Type not supported by the interpreter\n";
+      assert(0);
+   }
+   return Bytes;
+}
+
+unsigned int DfgInterpreter::getTypeWidth(const Value* V)
+{
+   return V->getType()->isIntegerTy() ? V->getType()->getIntegerBitWidth() : 64;
+}
+
+int64_t DfgInterpreter::wrap(int64_t V, unsigned int Width)
+{
+   if (Width == 0 || Width >= 64) return V;
+   uint64_t Sign = 1ULL << (Width - 1);
+   return (int64_t)((mask(V, Width) ^ Sign) - Sign);
+}
+
+uint64_t DfgInterpreter::mask(int64_t V, unsigned int Width)
+{
+   if (Width == 0 || Width >= 64) return V;
+   return (uint64_t)V & ((1ULL << Width) - 1);
+}
+
+DfgInterpreter::DfgInterpreter(DfgGraph* G) : Graph(G), Values(G->getNodes().size(), 0), NumEvaluated(0), NumErrors(0)
+{
+   Graph->getEvaluationOrder(Order);
+   const std::vector<DfgNode*>& Nodes = Graph->getNodes();
+   ///the parameters are set by the caller, the constants once
+   for(unsigned int n = 0; n < Nodes.size(); n++)
+      if (dyn_cast<ConstantInt>(Nodes[n]->Op)) Values[Nodes[n]->Id] = wrap(getValue(Nodes[n]->Op), Nodes[n]->getWidth());
+}
+
+DfgInterpreter::~DfgInterpreter()
+{
+   for(std::map<DfgGraph*, DfgInterpreter*>::iterator c = Callees.begin(); c != Callees.end(); c++)
+      delete c->second;
+}
+
+void DfgInterpreter::setScalar(const Value* Param, int64_t V)
+{
+   if (!Graph->isNode(Param)) return;
+   DfgNode* N = Graph->getNode(Param);
+   Values[N->Id] = wrap(V, N->getWidth());
+}
+
+void DfgInterpreter::bindMemory(const Value* Memory, unsigned char* Data, uint64_t Size)
+{
+   Buffer B;
+   B.Data = Data;
+   B.Size = Size;
+   Memories[Memory] = B;
+}
+
+void DfgInterpreter::error(const Instruction* I, const char* Message)
+{
+   ///the first errors are reported, the others only counted
+   if (NumErrors++ < 10)
+      errs() << "ERROR: " << Message << " (" << I->getName() << " in " << Graph->getFunctionName() << ")\n";
+}
+
+int64_t DfgInterpreter::getValue(const Value* V) const
+{
+   V = getOriginalValue(V);
+   if (const ConstantInt* C = dyn_cast<ConstantInt>(V))
+      return C->getBitWidth() == 1 ? (int64_t)C->getZExtValue() : C->getSExtValue();
+   if (Graph->isNode(V)) return Values[Graph->getNode(V)->Id];
+   if (const CastInst* C = dyn_cast<CastInst>(V))
+   {
+      int64_t Op = getValue(C->getOperand(0));
+      if (dyn_cast<ZExtInst>(C)) return mask(Op, getTypeWidth(C->getOperand(0)));
+      if (dyn_cast<SExtInst>(C)) return wrap(Op, getTypeWidth(C->getOperand(0)));
+      if (dyn_cast<TruncInst>(C)) return wrap(Op, getTypeWidth(C));
+      return Op;
+   }
+   ///index computations that are not nodes (e.g., those of the instructions synthesized by the transformations)
+   ///are evaluated from their operands and truncated to their width
+   if (const BinaryOperator* B = dyn_cast<BinaryOperator>(V))
+   {
+      bool Valid = true;
+      int64_t Result = compute(B, getValue(B->getOperand(0)), getValue(B->getOperand(1)), Valid);
+      return wrap(Result, Graph->hasWidth(B) ? Graph->getWidth(B) : getTypeWidth(B));
+   }
+   ///undefined values and parameters that are not used by the DFG
+   return 0;
+}
+
+bool DfgInterpreter::getAddress(const Value* Ptr, Buffer& B, uint64_t& Offset) const
+{
+   const Value* Memory = NULL;
+   std::vector<std::pair<const Value*, uint64_t> > Terms;
+   if (!getAddressTerms(Ptr, Memory, Terms) || Memories.find(Memory) == Memories.end()) return false;
+   B = Memories.find(Memory)->second;
+   Offset = 0;
+   for(unsigned int t = 0; t < Terms.size(); t++)
+      Offset += getValue(Terms[t].first) * Terms[t].second;
+   return true;
+}
+
+int64_t DfgInterpreter::compute(const BinaryOperator* B, int64_t Op0, int64_t Op1, bool& Valid)
+{
+   unsigned int Width = getTypeWidth(B);
+   Valid = true;
+   switch(B->getOpcode())
+   {
+      case Instruction::Add: return Op0 + Op1;
+      case Instruction::Sub: return Op0 - Op1;
+      case Instruction::Mul: return Op0 * Op1;
+      case Instruction::And: return Op0 & Op1;
+      case Instruction::Or: return Op0 | Op1;
+      case Instruction::Xor: return Op0 ^ Op1;
+      case Instruction::Shl: return Op1 >= 64 ? 0 : (int64_t)((uint64_t)Op0 << Op1);
+      case Instruction::AShr: return Op1 >= 64 ? (Op0 < 0 ? -1 : 0) : Op0 >> Op1;
+      case Instruction::LShr: return Op1 >= 64 ? 0 : (int64_t)(mask(Op0, Width) >> Op1);
+      case Instruction::SDiv:
+      case Instruction::SRem:
+      case Instruction::UDiv:
+      case Instruction::URem:
+      {
+         if (Op1 == 0)
+         {
+            Valid = false;
+            return 0;
+         }
+         if (B->getOpcode() == Instruction::SDiv) return Op0 / Op1;
+         if (B->getOpcode() == Instruction::SRem) return Op0 % Op1;
+         if (B->getOpcode() == Instruction::UDiv) return mask(Op0, Width) / mask(Op1, Width);
+         return mask(Op0, Width) % mask(Op1, Width);
+      }
+      default:
+         errs() << "Operation not supported by the interpreter: " << B->getOpcodeName() << "\n";
+         assert(0);
+         return 0;
+   }
+}
+
+int64_t DfgInterpreter::evaluate(DfgNode* N)
+{
+   const Instruction* I = dyn_cast<Instruction>(N->Op);
+   if (const BinaryOperator* B = dyn_cast<BinaryOperator>(I))
+   {
+      bool Valid = true;
+      int64_t Result = compute(B, getValue(B->getOperand(0)), getValue(B->getOperand(1)), Valid);
+      if (!Valid) error(I, "division by zero");
+      return Result;
+   }
+   else if (const ICmpInst* C = dyn_cast<ICmpInst>(I))
+   {
+      int64_t Op0 = getValue(C->getOperand(0));
+      int64_t Op1 = getValue(C->getOperand(1));
+      unsigned int Width = getTypeWidth(C->getOperand(0));
+      switch(C->getPredicate())
+      {
+         case CmpInst::ICMP_EQ: return Op0 == Op1;
+         case CmpInst::ICMP_NE: return Op0 != Op1;
+         case CmpInst::ICMP_SGT: return Op0 > Op1;
+         case CmpInst::ICMP_SGE: return Op0 >= Op1;
+         case CmpInst::ICMP_SLT: return Op0 < Op1;
+         case CmpInst::ICMP_SLE: return Op0 <= Op1;
+         case CmpInst::ICMP_UGT: return mask(Op0, Width) > mask(Op1, Width);
+         case CmpInst::ICMP_UGE: return mask(Op0, Width) >= mask(Op1, Width);
+         case CmpInst::ICMP_ULT: return mask(Op0, Width) < mask(Op1, Width);
+         case CmpInst::ICMP_ULE: return mask(Op0, Width) <= mask(Op1, Width);
+         default:
+            break;
+      }
+   }
+   else if (const SelectInst* S = dyn_cast<SelectInst>(I))
+      return (getValue(S->getCondition()) & 1) ? getValue(S->getTrueValue()) : getValue(S->getFalseValue());
+   else if (const CastInst* C = dyn_cast<CastInst>(I))
+   {
+      ///extensions and truncations that are nodes of the DFG (their users refer to the original value)
+      int64_t Op = getValue(C->getOperand(0));
+      if (dyn_cast<ZExtInst>(C)) return mask(Op, getTypeWidth(C->getOperand(0)));
+      return Op;
+   }
+   else if (const LoadInst* L = dyn_cast<LoadInst>(I))
+   {
+      Buffer B;
+      uint64_t Offset = 0, Bytes = getTypeBytes(L->getType());
+      if (!getAddress(L->getPointerOperand(), B, Offset) || Offset + Bytes > B.Size)
+      {
+         error(I, "load from an unbound memory or out of bounds");
+         return 0;
+      }
+      ///little-endian host buffers
+      uint64_t V = 0;
+      for(unsigned int b = 0; b < Bytes; b++)
+         V |= (uint64_t)B.Data[Offset + b] << (8 * b);
+      return V;
+   }
+   else if (const StoreInst* St = dyn_cast<StoreInst>(I))
+   {
+      Buffer B;
+      uint64_t Offset = 0, Bytes = getTypeBytes(St->getValueOperand()->getType());
+      if (!getAddress(St->getPointerOperand(), B, Offset) || Offset + Bytes > B.Size)
+      {
+         error(I, "store to an unbound memory or out of bounds");
+         return 0;
+      }
+      uint64_t V = getValue(St->getValueOperand());
+      for(unsigned int b = 0; b < Bytes; b++)
+         B.Data[Offset + b] = (unsigned char)(V >> (8 * b));
+      return 0;
+   }
+   else if (const CallInst* Call = dyn_cast<CallInst>(I))
+   {
+      if (!N->Callee)
+      {
+         error(I, "call to a function without DFG");
+         return 0;
+      }
+      if (Callees.find(N->Callee) == Callees.end()) Callees[N->Callee] = new DfgInterpreter(N->Callee);
+      DfgInterpreter* Callee = Callees[N->Callee];
+      const Function* F = Call->getCalledFunction();
+      unsigned int a = 0;
+      for(Function::const_arg_iterator A = F->arg_begin(); A != F->arg_end(); A++, a++)
+      {
+         const Value* Arg = Call->getArgOperand(a);
+         if (!Arg->getType()->isPointerTy())
+         {
+            Callee->setScalar(&*A, getValue(Arg));
+            continue;
+         }
+         ///the callee accesses the buffer from the address passed as argument
+         Buffer B;
+         uint64_t Offset = 0;
+         if (getAddress(Arg, B, Offset) && Offset <= B.Size)
+            Callee->bindMemory(&*A, B.Data + Offset, B.Size - Offset);
+      }
+      uint64_t Evaluated = Callee->NumEvaluated;
+      unsigned int Errors = Callee->NumErrors;
+      int64_t Result = Callee->run();
+      NumEvaluated += Callee->NumEvaluated - Evaluated;
+      NumErrors += Callee->NumErrors - Errors;
+      return Result;
+   }
+   else if (dyn_cast<SwitchInst>(I) || dyn_cast<ReturnInst>(I) || dyn_cast<BranchInst>(I))
+      ///the control flow is executed by run()
+      return 0;
+
+   errs() << "Operation not supported by the interpreter: " << I->getOpcodeName() << "\n";
+   assert(0);
+   return 0;
+}
+
+int64_t DfgInterpreter::run()
+{
+   BasicBlock* BB = Graph->getBasicBlock(1);
+   BasicBlock* Prev = NULL;
+   while (BB)
+   {
+      unsigned int bbIdx = Graph->getBbIdx(BB);
+      ///the phi nodes take the values of the incoming edge at the same time
+      if (Prev)
+      {
+         std::vector<std::pair<DfgNode*, int64_t> > Phis;
+         for(BasicBlock::iterator i = BB->begin(); dyn_cast<PHINode>(&*i); i++)
+         {
+            const PHINode* P = dyn_cast<PHINode>(&*i);
+            ///phi nodes replaced by a transformation (e.g., multiplexers of the if-conversion)
+            if (!Graph->isNode(P) || Graph->getNode(P)->Op != P) continue;
+            Phis.push_back(std::make_pair(Graph->getNode(P), getValue(P->getIncomingValueForBlock(Prev))));
+         }
+         for(unsigned int p = 0; p < Phis.size(); p++)
+            Values[Phis[p].first->Id] = wrap(Phis[p].second, Phis[p].first->getWidth());
+         NumEvaluated += Phis.size();
+      }
+
+      std::vector<DfgNode*>& Nodes = Order[bbIdx];
+      for(unsigned int n = 0; n < Nodes.size(); n++)
+         Values[Nodes[n]->Id] = wrap(evaluate(Nodes[n]), Nodes[n]->getWidth());
+      NumEvaluated += Nodes.size();
+
+      Prev = BB;
+      const TerminatorInst* T = BB->getTerminator();
+      if (const BranchInst* Br = dyn_cast<BranchInst>(T))
+         BB = Br->isUnconditional() || (getValue(Br->getCondition()) & 1) ? Br->getSuccessor(0) : Br->getSuccessor(1);
+      else if (const SwitchInst* Sw = dyn_cast<SwitchInst>(T))
+      {
+         int64_t Condition = getValue(Sw->getCondition());
+         BB = Sw->getDefaultDest();
+         for(SwitchInst::ConstCaseIt c = Sw->case_begin(); c != Sw->case_end(); ++c)
+            if (c.getCaseValue()->getSExtValue() == wrap(Condition, getTypeWidth(Sw->getCondition())))
+               BB = const_cast<BasicBlock*>(c.getCaseSuccessor());
+      }
+      else if (const ReturnInst* Ret = dyn_cast<ReturnInst>(T))
+         return Ret->getReturnValue() ? getValue(Ret->getReturnValue()) : 0;
+      else
+      {
+         errs() << "Terminator not supported by the interpreter: " << T->getOpcodeName() << "\n";
+         assert(0);
+         return 0;
+      }
+   }
+   return 0;
+}
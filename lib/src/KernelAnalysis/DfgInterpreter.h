@@ -0,0 +1,137 @@
+/**
+ * The MIT License (MIT)
+ * 
+ * Copyright (c) 2013 cad-projects
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+/**
+ * Author: Christian Pilato <christian.pilato@polimi.it>
+ *
+ * Description: This file defines the interpreter of a DFG: the nodes are
+ *              evaluated with the precision computed for them (the values are
+ *              truncated to the width of each node) and the memories are host
+ *              buffers bound to the pointer parameters.
+ */
+#ifndef DFGINTERPRETER_H
+#define DFGINTERPRETER_H
+
+#include "Dfg.h"
+
+#include "llvm/Support/DataTypes.h"
+
+#include <map>
+#include <vector>
+
+namespace llvm {
+
+class BasicBlock;
+class BinaryOperator;
+class Instruction;
+class Type;
+
+class DfgInterpreter
+{
+
+   public:
+
+      ///host buffer accessed by the loads and stores of a memory
+      struct Buffer
+      {
+         unsigned char* Data;
+         uint64_t Size;
+      };
+
+   private:
+
+      DfgGraph* Graph;
+
+      ///value of each node (indexed by node id), sign-extended from the width of the node
+      std::vector<int64_t> Values;
+
+      ///non-phi nodes of each basic block in evaluation order (memory accesses in program order)
+      std::map<unsigned int, std::vector<DfgNode*> > Order;
+
+      std::map<const Value*, Buffer> Memories;
+
+      ///interpreters of the called functions
+      std::map<DfgGraph*, DfgInterpreter*> Callees;
+
+      uint64_t NumEvaluated;
+
+      unsigned int NumErrors;
+
+      /// returns the value of an operand (constant, node, extension/truncation of a node or index computation)
+      int64_t getValue(const Value* V) const;
+
+      /// returns the host buffer and the byte offset addressed by a pointer
+      bool getAddress(const Value* Ptr, Buffer& B, uint64_t& Offset) const;
+
+      /// computes the value of a node, before the truncation to its width
+      int64_t evaluate(DfgNode* N);
+
+      /// computes a binary operation on the values of its operands (Valid is false on a division by zero)
+      static int64_t compute(const BinaryOperator* B, int64_t Op0, int64_t Op1, bool& Valid);
+
+      /// reports an error of the execution (out of bounds access, division by zero, ...)
+      void error(const Instruction* I, const char* Message);
+
+   public:
+
+      DfgInterpreter(DfgGraph* G);
+
+      ~DfgInterpreter();
+
+      /// sets the value of a scalar parameter
+      void setScalar(const Value* Param, int64_t V);
+
+      /// binds the memory (pointer parameter or global) to a host buffer of Size bytes
+      void bindMemory(const Value* Memory, unsigned char* Data, uint64_t Size);
+
+      /// executes the function from the entry basic block; returns the returned value (0 if none)
+      int64_t run();
+
+      /// number of nodes evaluated by all the executions
+      uint64_t getNumEvaluated() const
+      {
+         return NumEvaluated;
+      }
+
+      /// number of errors of all the executions
+      unsigned int getNumErrors() const
+      {
+         return NumErrors;
+      }
+
+      /// returns the value represented by the low Width bits of V (two's complement)
+      static int64_t wrap(int64_t V, unsigned int Width);
+
+      /// returns the low Width bits of V (zero extension)
+      static uint64_t mask(int64_t V, unsigned int Width);
+
+      /// returns the number of bytes of a type (integers and arrays of integers)
+      static uint64_t getTypeBytes(Type* Ty);
+
+      /// returns the number of bits of an integer value, 64 for the other types
+      static unsigned int getTypeWidth(const Value* V);
+
+};
+
+}
+
+#endif
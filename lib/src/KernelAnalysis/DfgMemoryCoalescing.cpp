@@ -0,0 +1,281 @@
+/**
+ * The MIT License (MIT)
+ * 
+ * Copyright (c) 2013 cad-projects
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+/**
+ * Author: Christian Pilato <christian.pilato@polimi.it>
+ *
+ * Description: Implementation of the coalescing of the memory accesses. In each
+ *              basic block, the loads (stores) to the same memory whose affine
+ *              addresses differ only by consecutive constants are merged in a
+ *              wide access of up to -coalescing-max-width bits, if no other
+ *              access to the same memory is in between. Each loaded element is
+ *              then a slice of the wide value; the stored elements are
+ *              concatenated. Elements are packed in little-endian order.
+ */
+#include "DfgMemoryCoalescing.h"
+
+#include "cad/Config.h"
+
+#include "AffineIndex.h"
+#include "Dfg.h"
+#include "DfgGeneration.h"
+
+#define DEBUG_TYPE "dfg-memory-coalescing"
+#include "llvm/Constants.h"
+#include "llvm/Instructions.h"
+#include "llvm/Support/raw_ostream.h"
+#include "llvm/ADT/Statistic.h"
+
+STATISTIC(CoalescedAccesses, "[CAD] Number of memory accesses merged into wide accesses");
+
+using namespace llvm;
+using namespace cadlib;
+
+static cl::opt<unsigned int> coalescingWidth("coalescing-max-width",
+  cl::desc("[CAD] Maximum bitwidth of the memory accesses created by the coalescing of the DFG"),
+  cl::init(64));
+
+void DfgMemoryCoalescing::getAnalysisUsage(AnalysisUsage &AU) const
+{
+   AU.addRequired<DfgGeneration>();
+   AU.addRequired<AffineIndex>();
+   AU.setPreservesAll();
+}
+
+char DfgMemoryCoalescing::ID = 0;
+static const char dfg_memory_coalescing_name[] = "[CAD] DFG Memory Coalescing";
+INITIALIZE_PASS_BEGIN(DfgMemoryCoalescing, DEBUG_TYPE, dfg_memory_coalescing_name, false, false)
+INITIALIZE_PASS_DEPENDENCY(DfgGeneration)
+INITIALIZE_PASS_DEPENDENCY(AffineIndex)
+INITIALIZE_PASS_END(DfgMemoryCoalescing, DEBUG_TYPE, dfg_memory_coalescing_name, false, false)
+
+Pass* createDfgMemoryCoalescingPass() {
+   return new DfgMemoryCoalescing;
+}
+
+static const Value* getPointer(const Value* Access)
+{
+   if (dyn_cast<LoadInst>(Access)) return dyn_cast<LoadInst>(Access)->getPointerOperand();
+   return dyn_cast<StoreInst>(Access)->getPointerOperand();
+}
+
+static Type* getElementType(const Value* Access)
+{
+   return dyn_cast<PointerType>(getPointer(Access)->getType())->getElementType();
+}
+
+bool DfgMemoryCoalescing::runOnFunction(Function &F)
+{
+   if (std::find(functionNames.begin(), functionNames.end(), F.getName()) == functionNames.end())
+      return false;
+
+   errs() << "DFG Memory Coalescing: #" << F.getName() << "#\n";
+   DfgGeneration& DG = getAnalysis<DfgGeneration>();
+   DfgGraph* graph = DG.graph;
+   if (!graph) return false;
+   AffineIndex& AI = getAnalysis<AffineIndex>();
+
+   Replacement.clear();
+   unsigned int Before = CoalescedAccesses;
+   const std::map<unsigned int, std::vector<const Value*> >& bbNodes = graph->getBbNodes();
+   for(std::map<unsigned int, std::vector<const Value*> >::const_iterator bb = bbNodes.begin(); bb != bbNodes.end(); bb++)
+   {
+      if (bb->first == 0) continue;
+      ///the positions refer to the basic block before the transformation
+      std::vector<const Value*> Values(bb->second);
+      std::map<const Value*, std::vector<unsigned int> > Accesses;
+      for(unsigned int v = 0; v < Values.size(); v++)
+      {
+         if (!dyn_cast<LoadInst>(Values[v]) && !dyn_cast<StoreInst>(Values[v])) continue;
+         if (!graph->isNode(Values[v])) continue;
+         Accesses[getMemoryVar(getPointer(Values[v]))].push_back(v);
+      }
+      for(std::map<const Value*, std::vector<unsigned int> >::iterator a = Accesses.begin(); a != Accesses.end(); a++)
+      {
+         coalesceAccesses(graph, AI, bb->first, Values, a->second, DfgNode::LOAD);
+         coalesceAccesses(graph, AI, bb->first, Values, a->second, DfgNode::STORE);
+      }
+   }
+
+   graph->replaceNodes(Replacement);
+   graph->finalize();
+   errs() << " - " << CoalescedAccesses - Before << " accesses merged\n";
+   errs() << "##\n\n";
+   return false;
+}
+
+void DfgMemoryCoalescing::coalesceAccesses(DfgGraph* graph, AffineIndex& AI, unsigned int bb, const std::vector<const Value*>& Values, const std::vector<unsigned int>& Accesses, DfgNode::Type_t Kind)
+{
+   ///candidates grouped by the variable part of the address and the element type, sorted by offset
+   typedef std::pair<std::map<AffineForm::Monomial, int64_t>, Type*> Key_t;
+   std::map<Key_t, std::map<int64_t, unsigned int> > Candidates;
+   for(unsigned int a = 0; a < Accesses.size(); a++)
+   {
+      const Value* Access = Values[Accesses[a]];
+      if (graph->getNode(Access)->Type != Kind) continue;
+      const AffineForm* Address = AI.getAddress(getPointer(Access));
+      Type* ElementTy = getElementType(Access);
+      if (!Address || !ElementTy->isIntegerTy() || ElementTy->getIntegerBitWidth() * 2 > coalescingWidth) continue;
+      std::map<int64_t, unsigned int>& Offsets = Candidates[Key_t(Address->Terms, ElementTy)];
+      ///accesses to the same element are not merged
+      if (Offsets.find(Address->Constant) == Offsets.end()) Offsets[Address->Constant] = Accesses[a];
+   }
+
+   for(std::map<Key_t, std::map<int64_t, unsigned int> >::iterator c = Candidates.begin(); c != Candidates.end(); c++)
+   {
+      unsigned int MaxElements = coalescingWidth / c->first.second->getIntegerBitWidth();
+      std::vector<unsigned int> Group;
+      int64_t Last = 0;
+      for(std::map<int64_t, unsigned int>::iterator o = c->second.begin(); ; o++)
+      {
+         ///the stored values are extended from the element type by the concatenation, so they can have any width
+         bool Adjacent = o != c->second.end() && !Group.empty() && o->first == Last + 1 && Group.size() < MaxElements &&
+            (Kind == DfgNode::STORE || graph->getNode(Values[o->second])->getWidth() == graph->getNode(Values[Group[0]])->getWidth());
+         if (!Adjacent && Group.size() > 1)
+         {
+            ///no other access to the same memory can be between the merged ones
+            unsigned int First = *std::min_element(Group.begin(), Group.end());
+            unsigned int Final = *std::max_element(Group.begin(), Group.end());
+            bool Conflict = false;
+            for(unsigned int a = 0; a < Accesses.size() && !Conflict; a++)
+            {
+               if (Accesses[a] <= First || Accesses[a] >= Final || std::find(Group.begin(), Group.end(), Accesses[a]) != Group.end()) continue;
+               Conflict = Kind == DfgNode::STORE || graph->getNode(Values[Accesses[a]])->Type == DfgNode::STORE;
+            }
+            if (!Conflict)
+            {
+               if (Kind == DfgNode::LOAD)
+                  mergeLoads(graph, bb, Values, Group);
+               else
+                  mergeStores(graph, bb, Values, Group);
+            }
+         }
+         if (o == c->second.end()) break;
+         if (!Adjacent) Group.clear();
+         Group.push_back(o->second);
+         Last = o->first;
+      }
+   }
+}
+
+void DfgMemoryCoalescing::mergeLoads(DfgGraph* graph, unsigned int bb, const std::vector<const Value*>& Values, const std::vector<unsigned int>& Group)
+{
+   ///the wide load is placed at the position of the first merged load
+   const Value* Anchor = Values[*std::min_element(Group.begin(), Group.end())];
+   const LoadInst* First = dyn_cast<LoadInst>(Values[Group[0]]);
+   DfgNode* FirstNode = graph->getNode(First);
+   unsigned int ElementWidth = getElementType(First)->getIntegerBitWidth();
+   Value* Ptr = const_cast<Value*>(First->getPointerOperand());
+   IntegerType* WideTy = IntegerType::get(Ptr->getContext(), ElementWidth * Group.size());
+
+   Instruction* Cast = new BitCastInst(graph->getPlaceholder(Ptr), PointerType::get(WideTy, dyn_cast<PointerType>(Ptr->getType())->getAddressSpace()), First->getName() + ".wide.addr");
+   graph->addSynthesized(Cast);
+   Instruction* Wide = new LoadInst(Cast, First->getName() + ".wide");
+   DfgNode* WideNode = graph->createNode(Wide, WideTy->getBitWidth(), bb, Anchor);
+   WideNode->UseNodes = FirstNode->UseNodes;
+   WideNode->Predicate = FirstNode->Predicate;
+
+   for(unsigned int g = 0; g < Group.size(); g++)
+   {
+      DfgNode* LoadNode = graph->getNode(Values[Group[g]]);
+      Constant* Shift = ConstantInt::get(WideTy, g * ElementWidth);
+      Instruction* Slice = BinaryOperator::Create(Instruction::LShr, Wide, Shift, Values[Group[g]]->getName() + ".slice");
+      DfgNode* SliceNode = graph->createNode(Slice, LoadNode->getWidth(), bb, Anchor);
+      SliceNode->UseNodes.push_back(WideNode);
+      SliceNode->UseNodes.push_back(graph->getNode(Shift, getConstantWidth(g * ElementWidth), bb));
+      SliceNode->Predicate = LoadNode->Predicate;
+      Replacement[LoadNode] = SliceNode;
+      ++CoalescedAccesses;
+   }
+   errs() << " - " << getMemoryString(Ptr) << ": " << Group.size() << " loads merged into a " << WideTy->getBitWidth() << "-bit load\n";
+}
+
+void DfgMemoryCoalescing::mergeStores(DfgGraph* graph, unsigned int bb, const std::vector<const Value*>& Values, const std::vector<unsigned int>& Group)
+{
+   ///the wide store is placed after the last merged store
+   unsigned int Last = *std::max_element(Group.begin(), Group.end());
+   const Value* Anchor = Last + 1 < Values.size() ? Values[Last + 1] : NULL;
+   const StoreInst* First = dyn_cast<StoreInst>(Values[Group[0]]);
+   DfgNode* FirstNode = graph->getNode(First);
+   unsigned int ElementWidth = getElementType(First)->getIntegerBitWidth();
+   Value* Ptr = const_cast<Value*>(First->getPointerOperand());
+   IntegerType* WideTy = IntegerType::get(Ptr->getContext(), ElementWidth * Group.size());
+
+   ///each element is extended and shifted to its position, then the elements are concatenated
+   std::vector<std::pair<Value*, DfgNode*> > Elements;
+   for(unsigned int g = 0; g < Group.size(); g++)
+   {
+      const StoreInst* Store = dyn_cast<StoreInst>(Values[Group[g]]);
+      DfgNode* ValueNode = graph->getNode(getRealValue(Store->getValueOperand()));
+      Instruction* Ext = new ZExtInst(graph->getPlaceholder(const_cast<Value*>(Store->getValueOperand())), WideTy, "concat.ext");
+      graph->addSynthesized(Ext);
+      if (g == 0)
+      {
+         Elements.push_back(std::make_pair((Value*)Ext, ValueNode));
+         continue;
+      }
+      Constant* Shift = ConstantInt::get(WideTy, g * ElementWidth);
+      Instruction* Shl = BinaryOperator::Create(Instruction::Shl, Ext, Shift, "concat.shl");
+      ///the nodes are sign-extended to their width: a shifted element as narrow as its value would extend
+      ///its sign into the upper elements, so the concatenation is as wide as the wide store
+      unsigned int Width = WideTy->getBitWidth();
+      DfgNode* ShlNode = graph->createNode(Shl, Width, bb, Anchor);
+      ShlNode->UseNodes.push_back(ValueNode);
+      ShlNode->UseNodes.push_back(graph->getNode(Shift, getConstantWidth(g * ElementWidth), bb));
+      ShlNode->Predicate = FirstNode->Predicate;
+      Elements.push_back(std::make_pair((Value*)Shl, ShlNode));
+   }
+   for(unsigned int e = 0; e + 1 < Elements.size(); e += 2)
+   {
+      Instruction* Or = BinaryOperator::Create(Instruction::Or, Elements[e].first, Elements[e+1].first, "concat");
+      unsigned int Width = WideTy->getBitWidth();
+      DfgNode* OrNode = graph->createNode(Or, Width, bb, Anchor);
+      OrNode->UseNodes.push_back(Elements[e].second);
+      OrNode->UseNodes.push_back(Elements[e+1].second);
+      OrNode->Predicate = FirstNode->Predicate;
+      Elements.push_back(std::make_pair((Value*)Or, OrNode));
+   }
+
+   Instruction* Cast = new BitCastInst(graph->getPlaceholder(Ptr), PointerType::get(WideTy, dyn_cast<PointerType>(Ptr->getType())->getAddressSpace()), "wide.addr");
+   graph->addSynthesized(Cast);
+   Instruction* Wide = new StoreInst(Elements.back().first, Cast);
+   DfgNode* WideNode = graph->createNode(Wide, WideTy->getBitWidth(), bb, Anchor);
+   ///the wide store uses the same memory and index variables of the merged stores
+   bool ValueFound = false;
+   DfgNode* FirstValue = graph->getNode(getRealValue(First->getValueOperand()));
+   for(unsigned int u = 0; u < FirstNode->UseNodes.size(); u++)
+   {
+      if (!ValueFound && FirstNode->UseNodes[u] == FirstValue)
+         ValueFound = true;
+      else
+         WideNode->UseNodes.push_back(FirstNode->UseNodes[u]);
+   }
+   WideNode->UseNodes.push_back(Elements.back().second);
+   WideNode->Predicate = FirstNode->Predicate;
+
+   for(unsigned int g = 0; g < Group.size(); g++)
+   {
+      Replacement[graph->getNode(Values[Group[g]])] = NULL;
+      ++CoalescedAccesses;
+   }
+   errs() << " - " << getMemoryString(Ptr) << ": " << Group.size() << " stores merged into a " << WideTy->getBitWidth() << "-bit store\n";
+}
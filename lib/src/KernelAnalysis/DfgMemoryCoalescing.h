@@ -0,0 +1,70 @@
+/**
+ * The MIT License (MIT)
+ * 
+ * Copyright (c) 2013 cad-projects
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+/**
+ * Author: Christian Pilato <christian.pilato@polimi.it>
+ *
+ * Description: This class defines the DFG transformation that merges the loads
+ *              (stores) of adjacent elements of the same memory into a single
+ *              wide access, followed by slices (preceded by a concatenation)
+ */
+#ifndef DFGMEMORYCOALESCING_H
+#define DFGMEMORYCOALESCING_H
+
+#include "Dfg.h"
+
+#include "llvm/Pass.h"
+#include "llvm/Function.h"
+
+#include <map>
+#include <vector>
+
+namespace llvm {
+
+struct AffineIndex;
+
+  // DfgMemoryCoalescing
+  struct DfgMemoryCoalescing : public FunctionPass {
+    static char ID; // Pass identification, replacement for typeid
+    DfgMemoryCoalescing() : FunctionPass(ID) {}
+
+    virtual bool runOnFunction(Function &F);
+
+    void getAnalysisUsage(AnalysisUsage &AU) const;
+
+    private:
+
+      /// merges the accesses of the given kind (loads or stores) to the same memory, at positions Accesses of Values
+      void coalesceAccesses(DfgGraph* graph, AffineIndex& AI, unsigned int bb, const std::vector<const Value*>& Values, const std::vector<unsigned int>& Accesses, DfgNode::Type_t Kind);
+
+      /// merges the loads at the given positions, sorted by increasing address
+      void mergeLoads(DfgGraph* graph, unsigned int bb, const std::vector<const Value*>& Values, const std::vector<unsigned int>& Group);
+
+      /// merges the stores at the given positions, sorted by increasing address
+      void mergeStores(DfgGraph* graph, unsigned int bb, const std::vector<const Value*>& Values, const std::vector<unsigned int>& Group);
+
+      ///nodes replaced by the transformation
+      std::map<DfgNode*, DfgNode*> Replacement;
+  };
+}
+
+#endif
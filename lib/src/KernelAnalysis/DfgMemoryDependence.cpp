@@ -0,0 +1,200 @@
+/**
+ * The MIT License (MIT)
+ * 
+ * Copyright (c) 2013 cad-projects
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+/**
+ * Author: Christian Pilato <christian.pilato@polimi.it>
+ *
+ * Description: Implementation of the memory dependence analysis. In each basic
+ *              block, every pair of accesses with at least one store is ordered
+ *              by a dependence unless the accesses are provably independent:
+ *              different memories that do not alias, the same memory at
+ *              constant affine distance with disjoint elements (wide accesses
+ *              cover several elements), or addresses that the alias analysis
+ *              reports as not aliased. The scheduler uses these dependences
+ *              instead of keeping all the accesses to a memory in program order.
+ */
+#include "DfgMemoryDependence.h"
+
+#include "cad/Config.h"
+
+#include "AffineIndex.h"
+#include "Dfg.h"
+#include "DfgGeneration.h"
+
+#define DEBUG_TYPE "dfg-memory-dependence"
+#include "llvm/Analysis/AliasAnalysis.h"
+#include "llvm/Instructions.h"
+#include "llvm/Support/raw_ostream.h"
+#include "llvm/ADT/Statistic.h"
+
+STATISTIC(MemoryDependences, "[CAD] Number of dependences between memory accesses");
+
+using namespace llvm;
+using namespace cadlib;
+
+void DfgMemoryDependence::getAnalysisUsage(AnalysisUsage &AU) const
+{
+   AU.addRequired<DfgGeneration>();
+   AU.addRequired<AffineIndex>();
+   AU.addRequired<AliasAnalysis>();
+   AU.setPreservesAll();
+}
+
+char DfgMemoryDependence::ID = 0;
+static const char dfg_memory_dependence_name[] = "[CAD] DFG Memory Dependence Analysis";
+INITIALIZE_PASS_BEGIN(DfgMemoryDependence, DEBUG_TYPE, dfg_memory_dependence_name, false, false)
+INITIALIZE_PASS_DEPENDENCY(DfgGeneration)
+INITIALIZE_PASS_DEPENDENCY(AffineIndex)
+INITIALIZE_AG_DEPENDENCY(AliasAnalysis)
+INITIALIZE_PASS_END(DfgMemoryDependence, DEBUG_TYPE, dfg_memory_dependence_name, false, false)
+
+Pass* createDfgMemoryDependencePass() {
+   return new DfgMemoryDependence;
+}
+
+std::string DfgMemoryDependence::getName(Dependence_t Type)
+{
+   switch(Type)
+   {
+      case RAW:
+         return "RAW";
+      case WAR:
+         return "WAR";
+      case WAW:
+         return "WAW";
+   }
+   return "";
+}
+
+bool DfgMemoryDependence::runOnFunction(Function &F)
+{
+   if (std::find(functionNames.begin(), functionNames.end(), F.getName()) == functionNames.end())
+      return false;
+
+   errs() << "DFG Memory Dependence: #" << F.getName() << "#\n";
+   DfgGeneration& DG = getAnalysis<DfgGeneration>();
+   DfgGraph* graph = DG.graph;
+   Dependences.clear();
+   NumDependences = 0;
+   NumIndependent = 0;
+   if (!graph) return false;
+   AA = &getAnalysis<AliasAnalysis>();
+   Affine = &getAnalysis<AffineIndex>();
+
+   Dependences.resize(graph->getNodes().size());
+   const std::map<unsigned int, std::vector<const Value*> >& bbNodes = graph->getBbNodes();
+   for(std::map<unsigned int, std::vector<const Value*> >::const_iterator bb = bbNodes.begin(); bb != bbNodes.end(); bb++)
+   {
+      if (bb->first == 0) continue;
+      analyzeBasicBlock(graph, bb->first);
+   }
+
+   errs() << " - " << NumDependences << " dependences, " << NumIndependent << " pairs of independent accesses\n";
+   errs() << "##\n\n";
+   return false;
+}
+
+void DfgMemoryDependence::analyzeBasicBlock(DfgGraph* graph, unsigned int bb)
+{
+   ///accesses of the basic block, in program order
+   const std::vector<const Value*>& Values = graph->getBbNode(bb);
+   std::vector<DfgNode*> Accesses;
+   for(unsigned int v = 0; v < Values.size(); v++)
+   {
+      if (!graph->isNode(Values[v])) continue;
+      DfgNode* N = graph->getNode(Values[v]);
+      if (N->Op != Values[v] || (N->Type != DfgNode::LOAD && N->Type != DfgNode::STORE)) continue;
+      Accesses.push_back(N);
+   }
+
+   for(unsigned int j = 0; j < Accesses.size(); j++)
+   {
+      for(unsigned int i = 0; i < j; i++)
+      {
+         if (Accesses[i]->Type == DfgNode::LOAD && Accesses[j]->Type == DfgNode::LOAD) continue;
+         if (isIndependent(Accesses[i], Accesses[j]))
+         {
+            NumIndependent++;
+            continue;
+         }
+         Dependence_t Type = WAW;
+         if (Accesses[i]->Type == DfgNode::STORE && Accesses[j]->Type == DfgNode::LOAD)
+            Type = RAW;
+         else if (Accesses[i]->Type == DfgNode::LOAD)
+            Type = WAR;
+         Dependences[Accesses[j]->Id].push_back(Dependence(Accesses[i], Type));
+         NumDependences++;
+         ++MemoryDependences;
+      }
+   }
+}
+
+/// returns the address accessed by the node and the number of elements of the memory it covers
+static const Value* getAccess(const DfgNode* N, unsigned int& Elements)
+{
+   const Value* Ptr = N->Type == DfgNode::LOAD ? dyn_cast<LoadInst>(N->Op)->getPointerOperand() : dyn_cast<StoreInst>(N->Op)->getPointerOperand();
+   Elements = 1;
+   ///wide accesses of the coalescing
+   Ptr = getOriginalValue(Ptr);
+   if (dyn_cast<BitCastInst>(Ptr))
+   {
+      const Value* Base = getOriginalValue(dyn_cast<BitCastInst>(Ptr)->getOperand(0));
+      unsigned int WideWidth = dyn_cast<PointerType>(Ptr->getType())->getElementType()->getPrimitiveSizeInBits();
+      unsigned int ElementWidth = dyn_cast<PointerType>(Base->getType())->getElementType()->getPrimitiveSizeInBits();
+      Elements = WideWidth / ElementWidth;
+      return Base;
+   }
+   return Ptr;
+}
+
+bool DfgMemoryDependence::isIndependent(const DfgNode* A, const DfgNode* B) const
+{
+   unsigned int ElementsA = 0, ElementsB = 0;
+   const Value* PtrA = getAccess(A, ElementsA);
+   const Value* PtrB = getAccess(B, ElementsB);
+   const Value* VarA = getMemoryVar(PtrA);
+   const Value* VarB = getMemoryVar(PtrB);
+   if (VarA != VarB)
+   {
+      ///different parameters (e.g., noalias) or globals
+      if (AA->alias(AliasAnalysis::Location(VarA), AliasAnalysis::Location(VarB)) == AliasAnalysis::NoAlias) return true;
+   }
+   else
+   {
+      int64_t Distance = 0;
+      if (Affine->getDistance(PtrA, PtrB, Distance))
+         return Distance >= (int64_t)ElementsA || Distance + (int64_t)ElementsB <= 0;
+   }
+   ///the accesses synthesized by the DFG transformations are not in the function
+   const Instruction* IA = dyn_cast<Instruction>(A->Op);
+   const Instruction* IB = dyn_cast<Instruction>(B->Op);
+   if (!IA->getParent() || !IB->getParent()) return false;
+   AliasAnalysis::Location LocA = A->Type == DfgNode::LOAD ? AA->getLocation(dyn_cast<LoadInst>(IA)) : AA->getLocation(dyn_cast<StoreInst>(IA));
+   AliasAnalysis::Location LocB = B->Type == DfgNode::LOAD ? AA->getLocation(dyn_cast<LoadInst>(IB)) : AA->getLocation(dyn_cast<StoreInst>(IB));
+   return AA->alias(LocA, LocB) == AliasAnalysis::NoAlias;
+}
+
+const std::vector<DfgMemoryDependence::Dependence>& DfgMemoryDependence::getDependences(const DfgNode* N) const
+{
+   assert(N->Id < Dependences.size() && "node not analyzed");
+   return Dependences[N->Id];
+}
@@ -0,0 +1,90 @@
+/**
+ * The MIT License (MIT)
+ * 
+ * Copyright (c) 2013 cad-projects
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+/**
+ * Author: Christian Pilato <christian.pilato@polimi.it>
+ *
+ * Description: This class defines the analysis of the dependences between the
+ *              memory accesses of the DFG (read after write, write after read
+ *              and write after write), based on the alias analysis and on the
+ *              affine form of the addresses
+ */
+#ifndef DFGMEMORYDEPENDENCE_H
+#define DFGMEMORYDEPENDENCE_H
+
+#include "llvm/Pass.h"
+#include "llvm/Function.h"
+
+#include <string>
+#include <vector>
+
+namespace llvm {
+
+class AliasAnalysis;
+class DfgGraph;
+struct AffineIndex;
+struct DfgNode;
+
+  // DfgMemoryDependence
+  struct DfgMemoryDependence : public FunctionPass {
+    static char ID; // Pass identification, replacement for typeid
+    DfgMemoryDependence() : FunctionPass(ID), AA(NULL), Affine(NULL) {}
+
+    typedef enum
+    {
+      RAW,
+      WAR,
+      WAW
+    } Dependence_t;
+
+    ///access that has to complete before another one, with the kind of dependence
+    typedef std::pair<DfgNode*, Dependence_t> Dependence;
+
+    virtual bool runOnFunction(Function &F);
+
+    void getAnalysisUsage(AnalysisUsage &AU) const;
+
+    /// returns the accesses of the same basic block that precede the access N and may overlap with it
+    const std::vector<Dependence>& getDependences(const DfgNode* N) const;
+
+    /// returns true if the two accesses never overlap
+    bool isIndependent(const DfgNode* A, const DfgNode* B) const;
+
+    static std::string getName(Dependence_t Type);
+
+    private:
+
+      void analyzeBasicBlock(DfgGraph* graph, unsigned int bb);
+
+      AliasAnalysis* AA;
+
+      AffineIndex* Affine;
+
+      ///dependences indexed by node id
+      std::vector<std::vector<Dependence> > Dependences;
+
+      unsigned int NumDependences;
+      unsigned int NumIndependent;
+  };
+}
+
+#endif
@@ -0,0 +1,192 @@
+/**
+ * The MIT License (MIT)
+ * 
+ * Copyright (c) 2013 cad-projects
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+/**
+ * Author: Christian Pilato <christian.pilato@polimi.it>
+ *
+ * Description: Implementation of the memory port analysis. The accesses of each
+ *              basic block are grouped by memory and by step: the clock cycle
+ *              when the DFG is scheduled, the ASAP level otherwise. The number
+ *              of ports of a memory is the maximum number of accesses in the
+ *              same step, where the loads of the same address (same affine
+ *              form) in the same step share the port access. The bandwidth is
+ *              the number of bytes read and written by one execution of each
+ *              basic block, scaled by the constant trip counts of the enclosing
+ *              loops for the whole invocation.
+ */
+#include "DfgMemoryPorts.h"
+
+#include "cad/Config.h"
+
+#include "AffineIndex.h"
+#include "Dfg.h"
+#include "DfgGeneration.h"
+#include "DfgScheduling.h"
+
+#define DEBUG_TYPE "dfg-memory-ports"
+#include "llvm/Instructions.h"
+#include "llvm/Analysis/LoopInfo.h"
+#include "llvm/Support/raw_ostream.h"
+
+using namespace llvm;
+using namespace cadlib;
+
+void DfgMemoryPorts::getAnalysisUsage(AnalysisUsage &AU) const
+{
+   AU.addRequired<DfgGeneration>();
+   AU.addRequired<AffineIndex>();
+   AU.addRequired<LoopInfo>();
+   AU.setPreservesAll();
+}
+
+char DfgMemoryPorts::ID = 0;
+static const char dfg_memory_ports_name[] = "[CAD] DFG Memory Ports Analysis";
+INITIALIZE_PASS_BEGIN(DfgMemoryPorts, DEBUG_TYPE, dfg_memory_ports_name, false, false)
+INITIALIZE_PASS_DEPENDENCY(DfgGeneration)
+INITIALIZE_PASS_DEPENDENCY(AffineIndex)
+INITIALIZE_PASS_DEPENDENCY(LoopInfo)
+INITIALIZE_PASS_END(DfgMemoryPorts, DEBUG_TYPE, dfg_memory_ports_name, false, false)
+
+Pass* createDfgMemoryPortsPass() {
+   return new DfgMemoryPorts;
+}
+
+void DfgMemoryPorts::Usage::merge(const Usage& Other)
+{
+   Loads += Other.Loads;
+   Stores += Other.Stores;
+   SharedLoads += Other.SharedLoads;
+   ReadPorts = std::max(ReadPorts, Other.ReadPorts);
+   WritePorts = std::max(WritePorts, Other.WritePorts);
+   Ports = std::max(Ports, Other.Ports);
+   BytesRead += Other.BytesRead * Other.Executions;
+   BytesWritten += Other.BytesWritten * Other.Executions;
+   if (!Other.Executions) Executions = 0;
+}
+
+bool DfgMemoryPorts::runOnFunction(Function &F)
+{
+   if (std::find(functionNames.begin(), functionNames.end(), F.getName()) == functionNames.end())
+      return false;
+
+   errs() << "DFG Memory Ports: #" << F.getName() << "#\n";
+   DfgGeneration& DG = getAnalysis<DfgGeneration>();
+   DfgGraph* graph = DG.graph;
+   Total.clear();
+   BbUsage.clear();
+   if (!graph) return false;
+   Scheduled = getAnalysisIfAvailable<DfgScheduling>() != NULL;
+
+   const std::map<unsigned int, std::vector<const Value*> >& bbNodes = graph->getBbNodes();
+   for(std::map<unsigned int, std::vector<const Value*> >::const_iterator bb = bbNodes.begin(); bb != bbNodes.end(); bb++)
+   {
+      if (bb->first == 0) continue;
+      analyzeBasicBlock(graph, bb->first);
+   }
+
+   for(std::map<const Value*, Usage>::iterator t = Total.begin(); t != Total.end(); t++)
+   {
+      const Usage& U = t->second;
+      errs() << " - " << t->first->getName() << ": " << U.Loads << " loads (" << U.SharedLoads << " shared), " << U.Stores << " stores, ";
+      errs() << U.Ports << " ports (" << U.ReadPorts << " read, " << U.WritePorts << " write), ";
+      if (U.Executions)
+         errs() << U.BytesRead << " bytes read and " << U.BytesWritten << " bytes written per invocation\n";
+      else
+         errs() << "unknown bytes per invocation (loops without a constant trip count)\n";
+   }
+   errs() << "##\n\n";
+   return false;
+}
+
+void DfgMemoryPorts::analyzeBasicBlock(DfgGraph* graph, unsigned int bb)
+{
+   DfgScheduling* Scheduling = getAnalysisIfAvailable<DfgScheduling>();
+   AffineIndex& AI = getAnalysis<AffineIndex>();
+   LoopInfo& LI = getAnalysis<LoopInfo>();
+
+   ///executions of the basic block in one invocation
+   uint64_t Executions = 1;
+   for(const Loop* L = LI.getLoopFor(graph->getBasicBlock(bb)); L; L = L->getParentLoop())
+      Executions *= L->getSmallConstantTripCount();
+
+   ///accesses of each memory in each step: loads and stores
+   typedef std::pair<std::vector<const Value*>, unsigned int> Step_t;
+   std::map<const Value*, std::map<unsigned int, Step_t> > Steps;
+   const std::vector<const Value*>& Values = graph->getBbNode(bb);
+   for(unsigned int v = 0; v < Values.size(); v++)
+   {
+      if (!graph->isNode(Values[v])) continue;
+      const DfgNode* N = graph->getNode(Values[v]);
+      if (N->Op != Values[v] || (N->Type != DfgNode::LOAD && N->Type != DfgNode::STORE)) continue;
+      const Value* Ptr = N->Type == DfgNode::LOAD ? dyn_cast<LoadInst>(N->Op)->getPointerOperand() : dyn_cast<StoreInst>(N->Op)->getPointerOperand();
+      const Value* Memory = getMemoryVar(Ptr);
+      unsigned int Step = Scheduling && Scheduling->isScheduled(N) ? Scheduling->getCycle(N) : N->Level;
+      uint64_t Bytes = (dyn_cast<PointerType>(Ptr->getType())->getElementType()->getPrimitiveSizeInBits() + 7) / 8;
+      Usage& U = BbUsage[Memory][bb];
+      Step_t& S = Steps[Memory][Step];
+      if (N->Type == DfgNode::STORE)
+      {
+         U.Stores++;
+         U.BytesWritten += Bytes;
+         S.second++;
+         continue;
+      }
+      U.Loads++;
+      bool Shared = false;
+      int64_t Distance = 0;
+      for(unsigned int l = 0; l < S.first.size() && !Shared; l++)
+         Shared = AI.getDistance(S.first[l], Ptr, Distance) && Distance == 0;
+      if (Shared)
+      {
+         U.SharedLoads++;
+         continue;
+      }
+      U.BytesRead += Bytes;
+      S.first.push_back(Ptr);
+   }
+
+   for(std::map<const Value*, std::map<unsigned int, Step_t> >::iterator m = Steps.begin(); m != Steps.end(); m++)
+   {
+      Usage& U = BbUsage[m->first][bb];
+      U.Executions = Executions;
+      for(std::map<unsigned int, Step_t>::iterator s = m->second.begin(); s != m->second.end(); s++)
+      {
+         U.ReadPorts = std::max(U.ReadPorts, (unsigned int)s->second.first.size());
+         U.WritePorts = std::max(U.WritePorts, s->second.second);
+         U.Ports = std::max(U.Ports, (unsigned int)s->second.first.size() + s->second.second);
+      }
+      Total[m->first].merge(U);
+   }
+}
+
+const DfgMemoryPorts::Usage* DfgMemoryPorts::getUsage(const Value* Memory) const
+{
+   std::map<const Value*, Usage>::const_iterator t = Total.find(Memory);
+   if (t == Total.end()) return NULL;
+   return &t->second;
+}
+
+const std::map<unsigned int, DfgMemoryPorts::Usage>& DfgMemoryPorts::getBbUsage(const Value* Memory) const
+{
+   assert(BbUsage.find(Memory) != BbUsage.end() && "memory not accessed");
+   return BbUsage.find(Memory)->second;
+}
@@ -0,0 +1,99 @@
+/**
+ * The MIT License (MIT)
+ * 
+ * Copyright (c) 2013 cad-projects
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+/**
+ * Author: Christian Pilato <christian.pilato@polimi.it>
+ *
+ * Description: This class defines the analysis of the memory ports and of the
+ *              bandwidth required by each stream (array) of the function
+ */
+#ifndef DFGMEMORYPORTS_H
+#define DFGMEMORYPORTS_H
+
+#include "llvm/Pass.h"
+#include "llvm/Function.h"
+
+#include <map>
+
+namespace llvm {
+
+class DfgGraph;
+struct DfgNode;
+
+  // DfgMemoryPorts
+  struct DfgMemoryPorts : public FunctionPass {
+    static char ID; // Pass identification, replacement for typeid
+    DfgMemoryPorts() : FunctionPass(ID), Scheduled(false) {}
+
+    ///accesses to a memory and concurrent accesses (ports) in a basic block or in the whole function
+    struct Usage
+    {
+       unsigned int Loads;
+       unsigned int Stores;
+       ///loads of the same address in the same step, served by a single port access
+       unsigned int SharedLoads;
+       unsigned int ReadPorts;
+       unsigned int WritePorts;
+       unsigned int Ports;
+       ///bytes transferred by one execution of the basic block; in the whole function, by one invocation
+       ///(at most: the accesses of all the paths are counted)
+       uint64_t BytesRead;
+       uint64_t BytesWritten;
+       ///executions of the basic block in one invocation (product of the constant trip counts of the enclosing
+       ///loops), 0 if unknown; in the whole function, 0 if the bytes of some basic block cannot be scaled
+       uint64_t Executions;
+
+       Usage() : Loads(0), Stores(0), SharedLoads(0), ReadPorts(0), WritePorts(0), Ports(0), BytesRead(0), BytesWritten(0), Executions(1) {}
+
+       /// merges the usage of another basic block (ports are the maximum, accesses the sum, bytes the sum
+       /// scaled by the executions)
+       void merge(const Usage& Other);
+    };
+
+    virtual bool runOnFunction(Function &F);
+
+    void getAnalysisUsage(AnalysisUsage &AU) const;
+
+    /// returns the usage of the memory in the whole function (NULL if not accessed)
+    const Usage* getUsage(const Value* Memory) const;
+
+    /// returns the usage of the memory in each basic block
+    const std::map<unsigned int, Usage>& getBbUsage(const Value* Memory) const;
+
+    /// returns true if the concurrent accesses are computed on the schedule, false if on the DFG levels
+    bool isScheduled() const
+    {
+       return Scheduled;
+    }
+
+    private:
+
+      void analyzeBasicBlock(DfgGraph* graph, unsigned int bb);
+
+      bool Scheduled;
+
+      std::map<const Value*, Usage> Total;
+      std::map<const Value*, std::map<unsigned int, Usage> > BbUsage;
+  };
+}
+
+#endif
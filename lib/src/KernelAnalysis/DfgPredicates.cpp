@@ -0,0 +1,270 @@
+/**
+ * The MIT License (MIT)
+ * 
+ * Copyright (c) 2013 cad-projects
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+/**
+ * Author: Christian Pilato <christian.pilato@polimi.it>
+ *
+ * Description: Implementation of the predicate table. The predicates are kept in
+ *              disjunctive normal form, each conjunction is a bitset over the
+ *              literals (branch outcomes); the terms are normalized (trailing
+ *              zeros removed, sorted, redundant terms removed) before interning,
+ *              so that two nodes have the same predicate if and only if they
+ *              have the same index.
+ */
+#include "DfgPredicates.h"
+
+#include "llvm/Instructions.h"
+#include "llvm/ADT/StringExtras.h"
+
+#include <algorithm>
+
+using namespace llvm;
+
+const unsigned int DfgPredicates::Always;
+
+/// returns true if the literal is part of the conjunction
+static bool hasLiteral(const DfgPredicates::Term_t& T, unsigned int Literal)
+{
+   return Literal < T.size() && T[Literal];
+}
+
+/// returns true if the conjunction A contains all the literals of B
+static bool isImplied(const DfgPredicates::Term_t& A, const DfgPredicates::Term_t& B)
+{
+   for(unsigned int l = 0; l < B.size(); l++)
+      if (B[l] && !hasLiteral(A, l)) return false;
+   return true;
+}
+
+static void trim(DfgPredicates::Term_t& T)
+{
+   while (!T.empty() && !T.back()) T.pop_back();
+}
+
+DfgPredicates::DfgPredicates()
+{
+   ///the predicate always executed is the empty conjunction
+   getPredicate(Predicate_t(1, Term_t()));
+}
+
+unsigned int DfgPredicates::getLiteral(DfgNode* Condition, DfgNode::Control_t Type, unsigned int Case)
+{
+   DfgNode::Condition_t L(Condition, Type, Case);
+   std::map<DfgNode::Condition_t, unsigned int>::iterator It = LiteralMap.find(L);
+   if (It != LiteralMap.end()) return It->second;
+   unsigned int Index = Literals.size();
+   Literals.push_back(L);
+   LiteralMap[L] = Index;
+   return Index;
+}
+
+unsigned int DfgPredicates::getComplement(unsigned int Literal) const
+{
+   const DfgNode::Condition_t& L = Literals[Literal];
+   if (std::tr1::get<1>(L) != DfgNode::T_EDGE && std::tr1::get<1>(L) != DfgNode::F_EDGE) return ~0U;
+   DfgNode::Control_t Type = std::tr1::get<1>(L) == DfgNode::T_EDGE ? DfgNode::F_EDGE : DfgNode::T_EDGE;
+   std::map<DfgNode::Condition_t, unsigned int>::const_iterator It = LiteralMap.find(DfgNode::Condition_t(std::tr1::get<0>(L), Type, std::tr1::get<2>(L)));
+   if (It == LiteralMap.end()) return ~0U;
+   return It->second;
+}
+
+void DfgPredicates::simplify(Predicate_t& P) const
+{
+   bool Changed = true;
+   while (Changed)
+   {
+      Changed = false;
+      for(unsigned int t = 0; t < P.size(); t++)
+      {
+         trim(P[t]);
+         if (P[t].empty())
+         {
+            P = Predicate_t(1, Term_t());
+            return;
+         }
+      }
+      std::sort(P.begin(), P.end());
+      P.erase(std::unique(P.begin(), P.end()), P.end());
+
+      ///a term implied by another one is redundant
+      Predicate_t Kept;
+      for(unsigned int t = 0; t < P.size(); t++)
+      {
+         bool Redundant = false;
+         for(unsigned int u = 0; u < P.size() && !Redundant; u++)
+            Redundant = u != t && isImplied(P[t], P[u]);
+         if (!Redundant) Kept.push_back(P[t]);
+      }
+      P.swap(Kept);
+
+      ///(X & c) | (X & !c) = X
+      for(unsigned int t = 0; t < P.size() && !Changed; t++)
+      {
+         for(unsigned int u = t + 1; u < P.size() && !Changed; u++)
+         {
+            unsigned int Size = std::max(P[t].size(), P[u].size());
+            std::vector<unsigned int> Different;
+            for(unsigned int l = 0; l < Size && Different.size() <= 2; l++)
+               if (hasLiteral(P[t], l) != hasLiteral(P[u], l)) Different.push_back(l);
+            if (Different.size() != 2 || getComplement(Different[0]) != Different[1]) continue;
+            P[t].resize(Size, false);
+            P[t][Different[0]] = P[t][Different[1]] = false;
+            P.erase(P.begin() + u);
+            Changed = true;
+         }
+      }
+   }
+}
+
+unsigned int DfgPredicates::getPredicate(Predicate_t P)
+{
+   simplify(P);
+   std::map<Predicate_t, unsigned int>::iterator It = PredicateMap.find(P);
+   if (It != PredicateMap.end()) return It->second;
+   unsigned int Index = Predicates.size();
+   Predicates.push_back(P);
+   PredicateMap[P] = Index;
+   return Index;
+}
+
+unsigned int DfgPredicates::getAnd(unsigned int P, unsigned int Literal)
+{
+   Predicate_t Result = Predicates[P];
+   for(unsigned int t = 0; t < Result.size(); t++)
+   {
+      if (Result[t].size() <= Literal) Result[t].resize(Literal + 1, false);
+      Result[t][Literal] = true;
+   }
+   return getPredicate(Result);
+}
+
+unsigned int DfgPredicates::getOr(unsigned int P, unsigned int Q)
+{
+   if (P == Q) return P;
+   Predicate_t Result = Predicates[P];
+   Result.insert(Result.end(), Predicates[Q].begin(), Predicates[Q].end());
+   return getPredicate(Result);
+}
+
+std::vector<unsigned int> DfgPredicates::getLiterals(unsigned int Predicate) const
+{
+   std::vector<unsigned int> Result;
+   const Predicate_t& P = Predicates[Predicate];
+   for(unsigned int l = 0; l < Literals.size(); l++)
+   {
+      bool Used = false;
+      for(unsigned int t = 0; t < P.size() && !Used; t++)
+         Used = hasLiteral(P[t], l);
+      if (Used) Result.push_back(l);
+   }
+   return Result;
+}
+
+std::vector<unsigned int> DfgPredicates::replaceConditions(const std::map<DfgNode*, DfgNode*>& Replacement)
+{
+   ///the literals are added again, so that the literals of two conditions replaced by the same node are merged
+   std::vector<DfgNode::Condition_t> OldLiterals;
+   OldLiterals.swap(Literals);
+   LiteralMap.clear();
+   std::vector<unsigned int> LiteralIndex(OldLiterals.size());
+   for(unsigned int l = 0; l < OldLiterals.size(); l++)
+   {
+      DfgNode* Condition = std::tr1::get<0>(OldLiterals[l]);
+      std::map<DfgNode*, DfgNode*>::const_iterator r = Replacement.find(Condition);
+      if (r != Replacement.end())
+      {
+         assert(r->second && "removing a condition");
+         Condition = r->second;
+      }
+      LiteralIndex[l] = getLiteral(Condition, std::tr1::get<1>(OldLiterals[l]), std::tr1::get<2>(OldLiterals[l]));
+   }
+
+   ///the predicates are rewritten on the merged literals and simplified again (Always is the first one)
+   std::vector<Predicate_t> OldPredicates;
+   OldPredicates.swap(Predicates);
+   PredicateMap.clear();
+   std::vector<unsigned int> PredicateIndex(OldPredicates.size());
+   for(unsigned int p = 0; p < OldPredicates.size(); p++)
+   {
+      Predicate_t P(OldPredicates[p].size());
+      for(unsigned int t = 0; t < P.size(); t++)
+      {
+         const Term_t& T = OldPredicates[p][t];
+         for(unsigned int l = 0; l < T.size(); l++)
+         {
+            if (!T[l]) continue;
+            if (P[t].size() <= LiteralIndex[l]) P[t].resize(LiteralIndex[l] + 1, false);
+            P[t][LiteralIndex[l]] = true;
+         }
+      }
+      PredicateIndex[p] = getPredicate(P);
+   }
+   return PredicateIndex;
+}
+
+std::string DfgPredicates::toString(unsigned int Predicate) const
+{
+   if (Predicate == Always) return "true";
+   std::string Result;
+   const Predicate_t& P = Predicates[Predicate];
+   for(unsigned int t = 0; t < P.size(); t++)
+   {
+      if (t) Result += " | ";
+      if (P.size() > 1) Result += "(";
+      bool First = true;
+      for(unsigned int l = 0; l < P[t].size(); l++)
+      {
+         if (!P[t][l]) continue;
+         if (!First) Result += " & ";
+         First = false;
+         const DfgNode::Condition_t& L = Literals[l];
+         std::string Name = std::tr1::get<0>(L)->Op->getName().str();
+         ///the outcomes of a switch are the bits of the one-hot encoding of its condition
+         if (dyn_cast<SwitchInst>(std::tr1::get<0>(L)->Op))
+            Name = dyn_cast<SwitchInst>(std::tr1::get<0>(L)->Op)->getCondition()->getName().str();
+         switch (std::tr1::get<1>(L))
+         {
+            case DfgNode::T_EDGE:
+               Result += Name;
+               break;
+            case DfgNode::F_EDGE:
+               Result += "!" + Name;
+               break;
+            case DfgNode::SWITCH_CASE_EDGE:
+            case DfgNode::SWITCH_DEF_EDGE:
+               Result += Name + "[" + utostr(std::tr1::get<2>(L)) + "]";
+               break;
+         }
+      }
+      if (P.size() > 1) Result += ")";
+   }
+   return Result;
+}
+
+unsigned long long DfgPredicates::getMemoryUsage() const
+{
+   unsigned long long Size = Literals.size() * sizeof(DfgNode::Condition_t);
+   for(unsigned int p = 0; p < Predicates.size(); p++)
+      for(unsigned int t = 0; t < Predicates[p].size(); t++)
+         Size += (Predicates[p][t].size() + 7) / 8;
+   return Size;
+}
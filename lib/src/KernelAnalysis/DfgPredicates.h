@@ -0,0 +1,123 @@
+/**
+ * The MIT License (MIT)
+ * 
+ * Copyright (c) 2013 cad-projects
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+/**
+ * Author: Christian Pilato <christian.pilato@polimi.it>
+ *
+ * Description: This file defines the predicate table of a DFG: the execution
+ *              conditions of the nodes, interned so that each node stores only
+ *              the index of its predicate.
+ */
+#ifndef DFGPREDICATES_H
+#define DFGPREDICATES_H
+
+#include "Dfg.h"
+
+#include <map>
+#include <string>
+#include <vector>
+
+namespace llvm {
+
+class DfgPredicates
+{
+
+   public:
+
+      ///conjunction of literals (bit l is set if the literal l is part of the conjunction)
+      typedef std::vector<bool> Term_t;
+      ///disjunction of conjunctions, sorted and without redundant terms
+      typedef std::vector<Term_t> Predicate_t;
+
+      ///predicate of the nodes that are always executed
+      static const unsigned int Always = 0;
+
+   private:
+
+      ///outcomes of the branches: condition node (switch node for switches), edge and bit of the one-hot encoding of the switch
+      std::vector<DfgNode::Condition_t> Literals;
+      std::map<DfgNode::Condition_t, unsigned int> LiteralMap;
+
+      std::vector<Predicate_t> Predicates;
+      std::map<Predicate_t, unsigned int> PredicateMap;
+
+      /// returns the index of the opposite outcome of a two-way branch (~0U if not available)
+      unsigned int getComplement(unsigned int Literal) const;
+
+      /// removes the redundant terms: the supersets of other terms and the pairs that differ by complementary literals
+      void simplify(Predicate_t& P) const;
+
+   public:
+
+      DfgPredicates();
+
+      /// returns the index of the literal, added to the table if not yet available
+      unsigned int getLiteral(DfgNode* Condition, DfgNode::Control_t Type, unsigned int Case);
+
+      const DfgNode::Condition_t& getCondition(unsigned int Literal) const
+      {
+         return Literals[Literal];
+      }
+
+      unsigned int getNumLiterals() const
+      {
+         return Literals.size();
+      }
+
+      /// returns the index of the predicate, added to the table if not yet available
+      unsigned int getPredicate(Predicate_t P);
+
+      const Predicate_t& getTerms(unsigned int Predicate) const
+      {
+         return Predicates[Predicate];
+      }
+
+      unsigned int getNumPredicates() const
+      {
+         return Predicates.size();
+      }
+
+      /// returns the predicate P and Literal
+      unsigned int getAnd(unsigned int P, unsigned int Literal);
+
+      /// returns the predicate P or Q
+      unsigned int getOr(unsigned int P, unsigned int Q);
+
+      /// returns the literals used by the predicate
+      std::vector<unsigned int> getLiterals(unsigned int Predicate) const;
+
+      /// replaces the condition nodes of the literals (see DfgGraph::replaceNodes): the literals that become equal are
+      /// merged and the predicates are interned again, so that equal predicates keep having the same index; returns
+      /// the new index of each predicate
+      std::vector<unsigned int> replaceConditions(const std::map<DfgNode*, DfgNode*>& Replacement);
+
+      /// returns the predicate in readable form, e.g. "(cmp & !cmp1) | cmp2", where c[i] is the bit i of the one-hot outcome of a switch on c
+      std::string toString(unsigned int Predicate) const;
+
+      /// approximated memory footprint of the table (in bytes)
+      unsigned long long getMemoryUsage() const;
+
+};
+
+}
+
+#endif
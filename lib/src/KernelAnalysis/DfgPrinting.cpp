@@ -29,8 +29,18 @@
 
 #include "cad/Config.h"
 
+#include "AffineIndex.h"
 #include "Dfg.h"
+#include "DfgCppWriter.h"
 #include "DfgGeneration.h"
+#include "DfgInitiationInterval.h"
+#include "DfgMemoryDependence.h"
+#include "DfgMemoryPorts.h"
+#include "DfgPredicates.h"
+#include "DfgPruning.h"
+#include "DfgScheduling.h"
+#include "DfgStencil.h"
+#include "DfgVerilogWriter.h"
 
 #define DEBUG_TYPE "dfg-printing"
 #include "llvm/Constants.h"
@@ -50,12 +60,17 @@ using namespace cadlib;
 
 static cl::list<std::string> formats("format",
   cl::desc("[CAD] Specify the output format for the DFG printing"),
-  cl::value_desc("\"xml\",\"dot\""));
+  cl::value_desc("\"xml\",\"dot\",\"cpp\",\"verilog\""));
+
+static cl::opt<unsigned int> verilogStages("verilog-stages",
+  cl::desc("[CAD] Number of pipeline stages of the Verilog datapath (0 = one stage per cycle of the schedule)"),
+  cl::init(0));
 
 
 void DfgPrinting::getAnalysisUsage(AnalysisUsage &AU) const
 {
    AU.addRequired<DfgGeneration>();
+   AU.addRequired<AffineIndex>();
    AU.setPreservesAll();
 }
 
@@ -63,6 +78,7 @@ char DfgPrinting::ID = 0;
 static const char dfg_printing_name[] = "[CAD] DFG Printing";
 INITIALIZE_PASS_BEGIN(DfgPrinting, DEBUG_TYPE, dfg_printing_name, false, false)
 INITIALIZE_PASS_DEPENDENCY(DfgGeneration)
+INITIALIZE_PASS_DEPENDENCY(AffineIndex)
 INITIALIZE_PASS_END(DfgPrinting, DEBUG_TYPE, dfg_printing_name, false, false)
 
 Pass* createDfgPrintingPass() {
@@ -75,16 +91,31 @@ bool DfgPrinting::runOnFunction(Function &F)
       return false;
 
    errs() << "DFG Printing: #" << F.getName() << "#\n";
+   Affine = &getAnalysis<AffineIndex>();
+   Scheduling = getAnalysisIfAvailable<DfgScheduling>();
+   Stencil = getAnalysisIfAvailable<DfgStencil>();
+   Ports = getAnalysisIfAvailable<DfgMemoryPorts>();
+   Interval = getAnalysisIfAvailable<DfgInitiationInterval>();
+   Dependences = getAnalysisIfAvailable<DfgMemoryDependence>();
+   Pruning = getAnalysisIfAvailable<DfgPruning>();
    if (formats.size() == 0 or std::find(formats.begin(), formats.end(), "dot") != formats.end())
       printDot(F);
    if (std::find(formats.begin(), formats.end(), "xml") != formats.end())
       printXML(F);
+   if (std::find(formats.begin(), formats.end(), "cpp") != formats.end())
+      printCpp(F);
+   if (std::find(formats.begin(), formats.end(), "verilog") != formats.end())
+      printVerilog(F);
    errs() << "##\n\n";
    return false;
 }
 
 void DfgPrinting::printXmlOp(DfgGraph* graph, const Value* Op, TiXmlElement& opNode, bool depth)
 {
+   ///values replaced by the DFG transformations are printed through their current node
+   Op = getOriginalValue(Op);
+   if (graph->isNode(Op)) Op = graph->getNode(Op)->Op;
+
    if (dyn_cast<ConstantInt>(Op))
    {
       opNode.SetValue("constant");
@@ -112,7 +143,12 @@ void DfgPrinting::printXmlOp(DfgGraph* graph, const Value* Op, TiXmlElement& opN
       TiXmlElement address("address");
       const Value* op = getMemoryVar(dyn_cast<LoadInst>(Op)->getPointerOperand());
       printXmlOp(graph, op, address, false);
-      printXmlOp(graph, dyn_cast<LoadInst>(Op)->getPointerOperand(), address, true);
+      printXmlAddress(dyn_cast<LoadInst>(Op)->getPointerOperand(), address);
+      ///the address generation is printed in the access partition
+      if (Pruning && Pruning->getAddressId(graph->getNode(Op)) != ~0U)
+         address.SetAttribute("id", Pruning->getAddressId(graph->getNode(Op)));
+      else
+         printXmlOp(graph, dyn_cast<LoadInst>(Op)->getPointerOperand(), address, true);
       opNode.InsertEndChild(address);
    }
    else if (dyn_cast<StoreInst>(Op))
@@ -120,7 +156,12 @@ void DfgPrinting::printXmlOp(DfgGraph* graph, const Value* Op, TiXmlElement& opN
       TiXmlElement address("address");
       const Value* op = getMemoryVar(dyn_cast<StoreInst>(Op)->getPointerOperand());
       printXmlOp(graph, op, address, false);
-      printXmlOp(graph, dyn_cast<StoreInst>(Op)->getPointerOperand(), address, true);
+      printXmlAddress(dyn_cast<StoreInst>(Op)->getPointerOperand(), address);
+      ///the address generation is printed in the access partition
+      if (Pruning && Pruning->getAddressId(graph->getNode(Op)) != ~0U)
+         address.SetAttribute("id", Pruning->getAddressId(graph->getNode(Op)));
+      else
+         printXmlOp(graph, dyn_cast<StoreInst>(Op)->getPointerOperand(), address, true);
       opNode.InsertEndChild(address);
       TiXmlElement value("value");
       const Value* val = getRealValue(dyn_cast<StoreInst>(Op)->getValueOperand());
@@ -133,11 +174,20 @@ void DfgPrinting::printXmlOp(DfgGraph* graph, const Value* Op, TiXmlElement& opN
       const GetElementPtrInst* ptr = dyn_cast<GetElementPtrInst>(Op);
       for(GetElementPtrInst::const_op_iterator It = ptr->idx_begin(); It != ptr->idx_end(); It++)
       {
-         getMemoryOps(*It, Operations);
+         getMemoryOps(getRealValue(*It), Operations);
       }
       for(std::list<const Value*>::iterator Op = Operations.begin(); Op != Operations.end(); Op++)
       {
          TiXmlElement node("op");
+         ///the index computations that are nodes (access partition) are printed in their basic block
+         if (graph->isNode(*Op))
+         {
+            if (*Op != Operations.back()) continue;
+            node.SetAttribute("name", "offset");
+            node.SetAttribute("node", graph->getNode(*Op)->Op->getName().data());
+            opNode.InsertEndChild(node);
+            continue;
+         }
          if (*Op != Operations.back())
             node.SetAttribute("name", dyn_cast<Instruction>(*Op)->getName().data());
          else
@@ -165,6 +215,26 @@ void DfgPrinting::printXmlOp(DfgGraph* graph, const Value* Op, TiXmlElement& opN
             opNode.SetAttribute("type", "cmp_slt");
             break;
          }
+         case CmpInst::ICMP_SGE:
+         {
+            opNode.SetAttribute("type", "cmp_sge");
+            break;
+         }
+         case CmpInst::ICMP_SLE:
+         {
+            opNode.SetAttribute("type", "cmp_sle");
+            break;
+         }
+         case CmpInst::ICMP_EQ:
+         {
+            opNode.SetAttribute("type", "cmp_eq");
+            break;
+         }
+         case CmpInst::ICMP_NE:
+         {
+            opNode.SetAttribute("type", "cmp_ne");
+            break;
+         }
          default:
          {
             assert(0 && "UNSUPPORTED PREDICATE!\n");
@@ -185,6 +255,80 @@ void DfgPrinting::printXmlOp(DfgGraph* graph, const Value* Op, TiXmlElement& opN
          opNode.SetAttribute("false_edge", graph->getBbIdx(br->getSuccessor(1)));
       }
    }
+   else if (dyn_cast<PHINode>(Op))
+   {
+      const PHINode* P = dyn_cast<PHINode>(Op);
+      const DfgNode* N = graph->getNode(P);
+      for(unsigned int i = 0; i < P->getNumIncomingValues(); i++)
+      {
+         const Value* val = getRealValue(P->getIncomingValue(i));
+         if (dyn_cast<UndefValue>(val)) continue;
+         TiXmlElement op("op");
+         printXmlOp(graph, val, op, false);
+         op.SetAttribute("bb", graph->getBbIdx(P->getIncomingBlock(i)));
+         ///values of the previous iterations
+         for(unsigned int c = 0; c < N->CarriedNodes.size(); c++)
+            if (graph->isNode(val) && N->CarriedNodes[c].first == graph->getNode(val))
+               op.SetAttribute("distance", N->CarriedNodes[c].second);
+         opNode.InsertEndChild(op);
+      }
+   }
+   else if (dyn_cast<BitCastInst>(Op))
+   {
+      printXmlOp(graph, dyn_cast<BitCastInst>(Op)->getOperand(0), opNode, true);
+   }
+   else if (dyn_cast<CallInst>(Op))
+   {
+      const CallInst* C = dyn_cast<CallInst>(Op);
+      if (C->getCalledFunction())
+         opNode.SetAttribute("function", C->getCalledFunction()->getName().data());
+      for(unsigned int a = 0; a < C->getNumArgOperands(); a++)
+      {
+         TiXmlElement op("op");
+         printXmlOp(graph, getRealValue(C->getArgOperand(a)), op, false);
+         opNode.InsertEndChild(op);
+      }
+   }
+   else if (dyn_cast<SelectInst>(Op))
+   {
+      const SelectInst* Sel = dyn_cast<SelectInst>(Op);
+      TiXmlElement cond("condition");
+      TiXmlElement op0("op");
+      TiXmlElement op1("op");
+      printXmlOp(graph, getRealValue(Sel->getCondition()), cond, false);
+      printXmlOp(graph, getRealValue(Sel->getTrueValue()), op0, false);
+      printXmlOp(graph, getRealValue(Sel->getFalseValue()), op1, false);
+      opNode.InsertEndChild(cond);
+      opNode.InsertEndChild(op0);
+      opNode.InsertEndChild(op1);
+   }
+   else if (dyn_cast<SwitchInst>(Op))
+   {
+      ///the outcome is one-hot encoded: bit i selects the case i, the last bit the default
+      const SwitchInst* sw = dyn_cast<SwitchInst>(Op);
+      TiXmlElement op("op");
+      printXmlOp(graph, getRealValue(sw->getCondition()), op, false);
+      opNode.InsertEndChild(op);
+      opNode.SetAttribute("one_hot", sw->getNumCases() + 1);
+      for(SwitchInst::ConstCaseIt c = sw->case_begin(); c != sw->case_end(); ++c)
+      {
+         TiXmlElement Case("case");
+         Case.SetAttribute("bit", c.getCaseIndex());
+         Case.SetAttribute("value", c.getCaseValue()->getValue().toString(10, true).c_str());
+         Case.SetAttribute("bb", graph->getBbIdx(const_cast<BasicBlock*>(c.getCaseSuccessor())));
+         opNode.InsertEndChild(Case);
+      }
+      TiXmlElement Default("default");
+      Default.SetAttribute("bit", sw->getNumCases());
+      Default.SetAttribute("bb", graph->getBbIdx(sw->getDefaultDest()));
+      opNode.InsertEndChild(Default);
+   }
+   else if (dyn_cast<ReturnInst>(Op))
+   {
+      TiXmlElement op("op");
+      printXmlOp(graph, getRealValue(dyn_cast<ReturnInst>(Op)->getReturnValue()), op, false);
+      opNode.InsertEndChild(op);
+   }
    else
    {
       errs() << "Type not supported: " << dyn_cast<Instruction>(Op)->getOpcodeName() << "\n";
@@ -192,11 +336,12 @@ void DfgPrinting::printXmlOp(DfgGraph* graph, const Value* Op, TiXmlElement& opN
    }
 }
 
-void DfgPrinting::printXmlBB(DfgGraph* graph, const std::vector<const Value*>& bbInstruction, TiXmlElement& bbNode)
+void DfgPrinting::printXmlBB(DfgGraph* graph, const std::vector<const Value*>& bbInstruction, TiXmlElement& bbNode, bool access)
 {
    for(unsigned int i = 0; i < bbInstruction.size(); i++)
    {
       if (!graph->isNode(bbInstruction[i]) || !dyn_cast<Instruction>(bbInstruction[i])) continue;
+      if ((Pruning && Pruning->isAccess(graph->getNode(bbInstruction[i]))) != access) continue;
       ///information about operation
       TiXmlElement node("op");
       if (!dyn_cast<StoreInst>(bbInstruction[i]))
@@ -206,10 +351,169 @@ void DfgPrinting::printXmlBB(DfgGraph* graph, const std::vector<const Value*>& b
       printXmlOp(graph, bbInstruction[i], node, true);
       ///information about precision
       node.SetAttribute("precision", graph->getWidth(bbInstruction[i]));
+      ///information about the execution condition
+      if (graph->getNode(bbInstruction[i])->Predicate != DfgPredicates::Always)
+         node.SetAttribute("predicate", graph->getPredicates().toString(graph->getNode(bbInstruction[i])->Predicate).c_str());
+      ///information about scheduling
+      if (Scheduling && Scheduling->isScheduled(graph->getNode(bbInstruction[i])))
+         node.SetAttribute("cycle", Scheduling->getCycle(graph->getNode(bbInstruction[i])));
+      ///accesses that have to complete before this one
+      const DfgNode* N = graph->getNode(bbInstruction[i]);
+      if (Dependences && (N->Type == DfgNode::LOAD || N->Type == DfgNode::STORE))
+      {
+         const std::vector<DfgMemoryDependence::Dependence>& Deps = Dependences->getDependences(N);
+         for(unsigned int d = 0; d < Deps.size(); d++)
+         {
+            TiXmlElement dependence("memory_dependence");
+            dependence.SetAttribute("type", DfgMemoryDependence::getName(Deps[d].second).c_str());
+            if (Deps[d].first->Type == DfgNode::LOAD)
+               dependence.SetAttribute("name", Deps[d].first->Op->getName().data());
+            else
+               dependence.SetAttribute("address", getMemoryString(dyn_cast<StoreInst>(Deps[d].first->Op)->getPointerOperand()).c_str());
+            node.InsertEndChild(dependence);
+         }
+      }
       bbNode.InsertEndChild(node);
    }
 }
 
+void DfgPrinting::printXmlAccessPartition(DfgGraph* graph, TiXmlElement& functionNode)
+{
+   TiXmlElement partition("access_partition");
+   ///distinct addresses referenced by the loads and stores of the datapath
+   const std::vector<const Value*>& Addresses = Pruning->getAddresses();
+   for(unsigned int a = 0; a < Addresses.size(); a++)
+   {
+      TiXmlElement address("address");
+      address.SetAttribute("id", a);
+      printXmlOp(graph, getMemoryVar(Addresses[a]), address, false);
+      printXmlAddress(Addresses[a], address);
+      printXmlOp(graph, Addresses[a], address, true);
+      partition.InsertEndChild(address);
+   }
+   ///operations that only compute addresses
+   const std::map<unsigned int, std::vector<const Value*> >& bbNodes = graph->getBbNodes();
+   for(std::map<unsigned int, std::vector<const Value*> >::const_iterator bb = bbNodes.begin(); bb != bbNodes.end(); bb++)
+   {
+      if (bb->first == 0) continue;
+      TiXmlElement bbNode("basic_block");
+      bbNode.SetAttribute("id", bb->first);
+      printXmlBB(graph, bb->second, bbNode, true);
+      if (bbNode.FirstChild()) partition.InsertEndChild(bbNode);
+   }
+   functionNode.InsertEndChild(partition);
+}
+
+void DfgPrinting::printXmlAddress(const Value* Ptr, TiXmlElement& addressNode)
+{
+   ///wide accesses (memory coalescing) transfer consecutive elements starting from the address
+   Ptr = getOriginalValue(Ptr);
+   if (dyn_cast<BitCastInst>(Ptr))
+   {
+      const Value* Base = getOriginalValue(dyn_cast<BitCastInst>(Ptr)->getOperand(0));
+      unsigned int WideWidth = dyn_cast<PointerType>(Ptr->getType())->getElementType()->getIntegerBitWidth();
+      unsigned int ElementWidth = dyn_cast<PointerType>(Base->getType())->getElementType()->getIntegerBitWidth();
+      addressNode.SetAttribute("elements", WideWidth / ElementWidth);
+      addressNode.SetAttribute("element_precision", ElementWidth);
+      Ptr = Base;
+   }
+   const AffineForm* Form = Affine->getAddress(Ptr);
+   if (Form)
+      addressNode.SetAttribute("affine", Form->toString().c_str());
+}
+
+void DfgPrinting::printXmlWindow(const Value* Stream, TiXmlElement& streamNode)
+{
+   if (!Stencil || !Stencil->getWindow(Stream)) return;
+   const DfgStencil::Window* W = Stencil->getWindow(Stream);
+   TiXmlElement window("window");
+   window.SetAttribute("rows", W->getRows());
+   window.SetAttribute("columns", W->getColumns());
+   if (!W->RowStride.empty())
+   {
+      window.SetAttribute("row_stride", AffineForm::getString(W->RowStride).c_str());
+      window.SetAttribute("line_buffers", W->getRows() - 1);
+   }
+   if (W->RowIndex)
+      window.SetAttribute("row_index", W->RowIndex->getName().data());
+   if (W->ColumnIndex)
+   {
+      window.SetAttribute("column_index", W->ColumnIndex->getName().data());
+      window.SetAttribute("step", (int)W->Step);
+   }
+   window.SetAttribute("index", W->Index.toString().c_str());
+   window.SetAttribute("loads", (int)W->Accesses.size());
+   window.SetAttribute("reads", W->getNewElements());
+   for(unsigned int a = 0; a < W->Accesses.size(); a++)
+   {
+      TiXmlElement access("access");
+      access.SetAttribute("name", W->Accesses[a].first->Op->getName().data());
+      access.SetAttribute("row", (int)W->Accesses[a].second.first);
+      access.SetAttribute("column", (int)W->Accesses[a].second.second);
+      window.InsertEndChild(access);
+   }
+   streamNode.InsertEndChild(window);
+}
+
+void DfgPrinting::printXmlPorts(const Value* Stream, TiXmlElement& streamNode)
+{
+   if (!Ports || !Ports->getUsage(Stream)) return;
+   const DfgMemoryPorts::Usage* U = Ports->getUsage(Stream);
+   streamNode.SetAttribute("ports", U->Ports);
+   streamNode.SetAttribute("read_ports", U->ReadPorts);
+   streamNode.SetAttribute("write_ports", U->WritePorts);
+   ///bytes per invocation, only if every basic block has a known number of executions
+   if (U->Executions)
+   {
+      streamNode.SetAttribute("bytes_read", utostr(U->BytesRead).c_str());
+      streamNode.SetAttribute("bytes_written", utostr(U->BytesWritten).c_str());
+   }
+   const std::map<unsigned int, DfgMemoryPorts::Usage>& BbUsage = Ports->getBbUsage(Stream);
+   for(std::map<unsigned int, DfgMemoryPorts::Usage>::const_iterator bb = BbUsage.begin(); bb != BbUsage.end(); bb++)
+   {
+      TiXmlElement access("memory_access");
+      access.SetAttribute("bb", bb->first);
+      access.SetAttribute("loads", bb->second.Loads);
+      access.SetAttribute("shared_loads", bb->second.SharedLoads);
+      access.SetAttribute("stores", bb->second.Stores);
+      access.SetAttribute("ports", bb->second.Ports);
+      access.SetAttribute("read_ports", bb->second.ReadPorts);
+      access.SetAttribute("write_ports", bb->second.WritePorts);
+      access.SetAttribute("bytes_read", utostr(bb->second.BytesRead).c_str());
+      access.SetAttribute("bytes_written", utostr(bb->second.BytesWritten).c_str());
+      if (bb->second.Executions) access.SetAttribute("executions", utostr(bb->second.Executions).c_str());
+      streamNode.InsertEndChild(access);
+   }
+}
+
+void DfgPrinting::printXmlLoops(DfgGraph* graph, TiXmlElement& functionNode)
+{
+   const std::vector<DfgLoop>& Loops = graph->getLoops();
+   if (Loops.empty()) return;
+   TiXmlElement loops("loops");
+   for(unsigned int l = 0; l < Loops.size(); l++)
+   {
+      TiXmlElement loop("loop");
+      loop.SetAttribute("id", l);
+      loop.SetAttribute("header", Loops[l].Header);
+      loop.SetAttribute("depth", Loops[l].Depth);
+      if (Loops[l].Parent >= 0)
+         loop.SetAttribute("parent", Loops[l].Parent);
+      std::ostringstream Blocks;
+      for(unsigned int b = 0; b < Loops[l].Blocks.size(); b++)
+         Blocks << (b ? " " : "") << Loops[l].Blocks[b];
+      loop.SetAttribute("basic_blocks", Blocks.str().c_str());
+      if (Interval && Interval->isAnalyzed(l))
+      {
+         loop.SetAttribute("rec_mii", Interval->getRecMII(l));
+         loop.SetAttribute("res_mii", Interval->getResMII(l));
+         loop.SetAttribute("mii", Interval->getMII(l));
+      }
+      loops.InsertEndChild(loop);
+   }
+   functionNode.InsertEndChild(loops);
+}
+
 void DfgPrinting::printXML(Function &F)
 {
    errs() << " - xml format\n";
@@ -244,6 +548,10 @@ void DfgPrinting::printXML(Function &F)
             Parameter.SetAttribute("direction", "IN");
          else if (graph->getNode(par)->Type == DfgNode::OUT_PARAM)
             Parameter.SetAttribute("direction", "OUT");
+         else if (graph->getNode(par)->Type == DfgNode::INOUT_PARAM)
+            Parameter.SetAttribute("direction", "INOUT");
+         printXmlPorts(par, Parameter);
+         printXmlWindow(par, Parameter);
          if (firstParameter)
             Interface.InsertBeforeChild(firstParameter, Parameter);
          else
@@ -259,18 +567,25 @@ void DfgPrinting::printXML(Function &F)
    }
    function.InsertEndChild(Interface);
 
+   printXmlLoops(graph, function);
+
    TiXmlElement dfg("dfg");
    for(std::map<unsigned int, std::vector<const Value*> >::const_iterator bb = bbNodes.begin(); bb != bbNodes.end(); bb++)
    {
       if (bb->first == 0) continue;
       TiXmlElement bbNode("basic_block");
       bbNode.SetAttribute("id", bb->first);
+      if (Scheduling)
+         bbNode.SetAttribute("latency", Scheduling->getBbLatency(bb->first));
       printXmlBB(graph, bb->second, bbNode);
       dfg.InsertEndChild(bbNode);
    }
 
    function.InsertEndChild(dfg);
 
+   if (Pruning)
+      printXmlAccessPartition(graph, function);
+
    application.InsertEndChild(function);
    root.InsertEndChild(application);
    doc.InsertEndChild(root);
@@ -307,6 +622,7 @@ void DfgPrinting::printDot(Function &F)
          DfgNode* dNode = graph->getNode(b->second[i]);
          oss << cnt << "[style=filled,color=white,label=\"" << dNode->getName();
          if (!dyn_cast<CmpInst>(dNode->Op)) oss << "\\nwidth = " + utostr(graph->getWidth(dNode->Op));
+         if (Scheduling && Scheduling->isScheduled(dNode)) oss << "\\ncycle = " + utostr(Scheduling->getCycle(dNode));
          oss << "\"";
          if (dNode->Type == DfgNode::IN_PARAM)
             oss << ", shape=\"invhouse\", color=\"gray\"";
@@ -316,6 +632,10 @@ void DfgPrinting::printDot(Function &F)
             oss << ", shape=\"box\", color=\"green\"";
          if (dNode->Type == DfgNode::STORE)
             oss << ", shape=\"box\", color=\"yellow\"";
+         if (dNode->Type == DfgNode::CALL)
+            oss << ", shape=\"component\", color=\"orange\"";
+         if (Pruning && Pruning->isAccess(dNode))
+            oss << ", color=\"lightblue\"";
          oss << "];\n";
          reverseMap[dNode] = cnt;
       }
@@ -342,7 +662,7 @@ void DfgPrinting::printDot(Function &F)
       const std::vector<DfgNode*>& Uses = Nodes[i]->UseNodes;
       for(unsigned int u = 0; u < Uses.size(); u++)
       {
-         if (Uses[u]->Type == DfgNode::OUT_PARAM && Nodes[i]->Type == DfgNode::STORE)
+         if (DfgGraph::isOutputUse(Nodes[i], Uses[u]))
             oss << reverseMap[Nodes[i]] << "->" << reverseMap[Uses[u]];
          else
             oss << reverseMap[Uses[u]] << "->" << reverseMap[Nodes[i]];
@@ -350,18 +670,45 @@ void DfgPrinting::printDot(Function &F)
          oss << ";\n";
       }
 
-      const std::vector<DfgNode::Condition_t>& ControlNodes = Nodes[i]->ControlNodes;
-      for(unsigned int u = 0; u < ControlNodes.size(); u++)
+      const std::vector<DfgNode::Carried_t>& CarriedNodes = Nodes[i]->CarriedNodes;
+      for(unsigned int c = 0; c < CarriedNodes.size(); c++)
       {
-         DfgNode* src = std::tr1::get<0>(ControlNodes[u]);
+         oss << reverseMap[CarriedNodes[c].first] << "->" << reverseMap[Nodes[i]];
+         oss << "[label=\"" << CarriedNodes[c].first->Op->getName().str() << " (d = " << CarriedNodes[c].second << ")\", style=\"dashed\"]";
+         oss << ";\n";
+      }
+
+      if (Dependences && (Nodes[i]->Type == DfgNode::LOAD || Nodes[i]->Type == DfgNode::STORE))
+      {
+         const std::vector<DfgMemoryDependence::Dependence>& Deps = Dependences->getDependences(Nodes[i]);
+         for(unsigned int d = 0; d < Deps.size(); d++)
+         {
+            oss << reverseMap[Deps[d].first] << "->" << reverseMap[Nodes[i]];
+            oss << "[label=\"" << DfgMemoryDependence::getName(Deps[d].second) << "\", style=\"dotted\", color=\"gray\"]";
+            oss << ";\n";
+         }
+      }
+
+      ///branch outcomes of the predicate of the node
+      const DfgPredicates& Predicates = graph->getPredicates();
+      std::vector<unsigned int> Literals = Predicates.getLiterals(Nodes[i]->Predicate);
+      for(unsigned int l = 0; l < Literals.size(); l++)
+      {
+         const DfgNode::Condition_t& Condition = Predicates.getCondition(Literals[l]);
+         DfgNode* src = std::tr1::get<0>(Condition);
          oss << reverseMap[src] << "->" << reverseMap[Nodes[i]];
          oss << "[";
-         if(std::tr1::get<1>(ControlNodes[u]) == DfgNode::T_EDGE)
+         if(std::tr1::get<1>(Condition) == DfgNode::T_EDGE)
             oss << "label=\"T\", color=\"blue\"";
-         else if(std::tr1::get<1>(ControlNodes[u]) == DfgNode::F_EDGE)
+         else if(std::tr1::get<1>(Condition) == DfgNode::F_EDGE)
             oss << "label=\"F\", color=\"red\"";
+         else if(std::tr1::get<1>(Condition) == DfgNode::SWITCH_CASE_EDGE)
+         {
+            SwitchInst::ConstCaseIt c(dyn_cast<SwitchInst>(src->Op), std::tr1::get<2>(Condition));
+            oss << "label=\"case " << c.getCaseValue()->getValue().toString(10, true) << "\", color=\"darkgreen\"";
+         }
          else
-            assert(0 && "Condition not yet supported");
+            oss << "label=\"default\", color=\"gray\"";
          oss << "];\n";
       }
    }
@@ -371,3 +718,35 @@ void DfgPrinting::printDot(Function &F)
    file << oss.str();
    file.close();
 }
+
+void DfgPrinting::printCpp(Function &F)
+{
+   errs() << " - cpp format\n";
+   DfgGeneration& DG = getAnalysis<DfgGeneration>();
+   DfgGraph* graph =  DG.graph;
+   if (!graph) return;
+
+   DfgCppWriter Writer(graph, &F);
+   std::ofstream file((graph->getFunctionName() + ".cpp").c_str());
+   file << Writer.write();
+   file.close();
+}
+
+void DfgPrinting::printVerilog(Function &F)
+{
+   errs() << " - verilog format\n";
+   DfgGeneration& DG = getAnalysis<DfgGeneration>();
+   DfgGraph* graph =  DG.graph;
+   if (!graph) return;
+
+   DfgVerilogWriter Writer(graph, &F, Scheduling, verilogStages);
+   if (!Writer.isSupported())
+   {
+      errs() << "WARNING: the Verilog datapath requires an acyclic control flow without calls\n";
+      return;
+   }
+   std::ofstream file((graph->getFunctionName() + ".v").c_str());
+   file << Writer.write();
+   file.close();
+   errs() << "pipeline depth = " << Writer.getDepth() << "\n";
+}
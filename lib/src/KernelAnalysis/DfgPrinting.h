@@ -37,23 +37,68 @@
 namespace llvm {
 
 class DfgGraph;
+struct AffineIndex;
+struct DfgInitiationInterval;
+struct DfgMemoryDependence;
+struct DfgMemoryPorts;
+struct DfgPruning;
+struct DfgScheduling;
+struct DfgStencil;
 
   // DfgPrinting
   struct DfgPrinting : public FunctionPass {
     static char ID; // Pass identification, replacement for typeid
-    DfgPrinting() : FunctionPass(ID) {}
+    DfgPrinting() : FunctionPass(ID), Affine(NULL), Scheduling(NULL), Stencil(NULL), Ports(NULL), Interval(NULL), Dependences(NULL), Pruning(NULL) {}
+
+    ///affine forms of the addresses
+    AffineIndex* Affine;
+
+    ///schedule of the operations, if the scheduling pass has been executed
+    DfgScheduling* Scheduling;
+
+    ///sliding windows of the streams, if the stencil analysis has been executed
+    DfgStencil* Stencil;
+
+    ///memory ports and bandwidth of the streams, if the memory port analysis has been executed
+    DfgMemoryPorts* Ports;
+
+    ///initiation intervals of the innermost loops, if the analysis has been executed
+    DfgInitiationInterval* Interval;
+
+    ///dependences between the memory accesses, if the analysis has been executed
+    DfgMemoryDependence* Dependences;
+
+    ///dead nodes removed and access partition, if the pruning has been executed
+    DfgPruning* Pruning;
 
     void printDot(Function &F);
 
     void printXML(Function &F);
 
+    /// prints the bit-accurate C++ model of the DFG
+    void printCpp(Function &F);
+
+    /// prints the pipelined datapath of the DFG, with the registers placed by the schedule
+    void printVerilog(Function &F);
+
     virtual bool runOnFunction(Function &F);
 
     void getAnalysisUsage(AnalysisUsage &AU) const;
 
-    void printXmlBB(DfgGraph* graph, const std::vector<const Value*>& bbInstruction, TiXmlElement& bbNode);
+    /// prints the operations of the datapath (or of the access partition) of the basic block
+    void printXmlBB(DfgGraph* graph, const std::vector<const Value*>& bbInstruction, TiXmlElement& bbNode, bool access = false);
 
     void printXmlOp(DfgGraph* graph, const Value* Op, TiXmlElement& opNode, bool depth);
+
+    void printXmlAddress(const Value* Ptr, TiXmlElement& addressNode);
+
+    void printXmlAccessPartition(DfgGraph* graph, TiXmlElement& functionNode);
+
+    void printXmlWindow(const Value* Stream, TiXmlElement& streamNode);
+
+    void printXmlPorts(const Value* Stream, TiXmlElement& streamNode);
+
+    void printXmlLoops(DfgGraph* graph, TiXmlElement& functionNode);
   };
 }
 
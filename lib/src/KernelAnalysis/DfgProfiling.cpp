@@ -0,0 +1,169 @@
+/**
+ * The MIT License (MIT)
+ * 
+ * Copyright (c) 2013 cad-projects
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+/**
+ * Author: Christian Pilato <christian.pilato@polimi.it>
+ *
+ * Description: Implementation of the instrumentation for the profiling of the
+ *              values. A call to cad_profile_value(name, value) is inserted
+ *              after each integer instruction (after the phi nodes of the basic
+ *              block for a phi node) and at the entry of the function for each
+ *              integer parameter, where name is "<function>.<value>" as in the
+ *              DATASIZE entries of the configuration file and value is the
+ *              extension to 64 bits: zero extension for the values used as
+ *              unsigned (e.g., the pixels of an unsigned char image), sign
+ *              extension otherwise. The comparisons are not recorded (1 bit).
+ *              The instrumented module has to be linked with the runtime:
+ *                $opt -load=cad-lib.so obj.opt.s -dfg-profiling -function=<name> -S -o obj.prof.s
+ *                $clang obj.prof.s runtime/cad_profile.c -o obj.prof && ./obj.prof
+ */
+#include "DfgProfiling.h"
+
+#include "cad/Config.h"
+
+#define DEBUG_TYPE "dfg-profiling"
+#include "llvm/Constants.h"
+#include "llvm/DerivedTypes.h"
+#include "llvm/Instructions.h"
+#include "llvm/IRBuilder.h"
+#include "llvm/Support/raw_ostream.h"
+#include "llvm/ADT/Statistic.h"
+
+#include <vector>
+
+STATISTIC(InstrumentedCounter, "[CAD] Number of values recorded by the profiling");
+
+using namespace llvm;
+using namespace cadlib;
+
+void DfgProfiling::getAnalysisUsage(AnalysisUsage &AU) const
+{
+
+}
+
+char DfgProfiling::ID = 0;
+static const char dfg_profiling_name[] = "[CAD] DFG Profiling";
+INITIALIZE_PASS(DfgProfiling, DEBUG_TYPE, dfg_profiling_name, false, false)
+
+Pass* createDfgProfilingPass() {
+   return new DfgProfiling;
+}
+
+bool DfgProfiling::runOnModule(Module &M)
+{
+   LLVMContext& Context = M.getContext();
+   Constant* Record = M.getOrInsertFunction("cad_profile_value", Type::getVoidTy(Context), Type::getInt8PtrTy(Context), Type::getInt64Ty(Context), NULL);
+
+   bool Modified = false;
+   for(Module::iterator f = M.begin(); f != M.end(); f++)
+   {
+      Function& F = *f;
+      if (F.isDeclaration() || !isCalledByKernel(F)) continue;
+      errs() << "DFG Profiling: #" << F.getName() << "#\n";
+      unsigned int Num = instrumentFunction(F, Record);
+      errs() << "instrumented values = " << Num << "\n";
+      errs() << "##\n\n";
+      Modified |= Num > 0;
+   }
+   return Modified;
+}
+
+/// returns true if the value has to be recorded
+static bool isProfiled(const Value* V)
+{
+   IntegerType* Ty = dyn_cast<IntegerType>(V->getType());
+   return Ty && Ty->getBitWidth() > 1 && Ty->getBitWidth() <= 64 && V->hasName();
+}
+
+/// returns true if the uses of the value interpret it as unsigned (zero extensions, unsigned divisions,
+/// shifts and comparisons) and none as signed
+static bool isUnsigned(const Value* V)
+{
+   bool Unsigned = false;
+   for(Value::const_use_iterator u = V->use_begin(); u != V->use_end(); u++)
+   {
+      const User* U = *u;
+      if (dyn_cast<ZExtInst>(U) || dyn_cast<UIToFPInst>(U))
+         Unsigned = true;
+      else if (dyn_cast<SExtInst>(U) || dyn_cast<SIToFPInst>(U))
+         return false;
+      else if (const ICmpInst* C = dyn_cast<ICmpInst>(U))
+      {
+         if (C->isUnsigned()) Unsigned = true;
+         else if (C->isSigned()) return false;
+      }
+      else if (const BinaryOperator* B = dyn_cast<BinaryOperator>(U))
+      {
+         ///the shifts interpret only the shifted value, not the amount
+         if ((B->getOpcode() == Instruction::LShr || B->getOpcode() == Instruction::AShr) && B->getOperand(0) != V) continue;
+         switch(B->getOpcode())
+         {
+            case Instruction::UDiv:
+            case Instruction::URem:
+            case Instruction::LShr:
+               Unsigned = true;
+               break;
+            case Instruction::SDiv:
+            case Instruction::SRem:
+            case Instruction::AShr:
+               return false;
+            default:
+               break;
+         }
+      }
+   }
+   return Unsigned;
+}
+
+unsigned int DfgProfiling::instrumentFunction(Function& F, Constant* Record)
+{
+   ///values to be recorded with their insertion point (collected first, the inserted instructions are not recorded)
+   std::vector<std::pair<Value*, Instruction*> > Values;
+   Instruction* Entry = &*F.getEntryBlock().getFirstInsertionPt();
+   for(Function::arg_iterator A = F.arg_begin(); A != F.arg_end(); A++)
+      if (isProfiled(&*A)) Values.push_back(std::make_pair(&*A, Entry));
+   for(Function::iterator b = F.begin(); b != F.end(); b++)
+   {
+      for(BasicBlock::iterator i = b->begin(); i != b->end(); i++)
+      {
+         if (!isProfiled(&*i) || dyn_cast<TerminatorInst>(&*i)) continue;
+         if (dyn_cast<PHINode>(&*i))
+            Values.push_back(std::make_pair(&*i, &*b->getFirstInsertionPt()));
+         else
+         {
+            BasicBlock::iterator Next = i;
+            Next++;
+            Values.push_back(std::make_pair(&*i, &*Next));
+         }
+      }
+   }
+
+   for(unsigned int v = 0; v < Values.size(); v++)
+   {
+      IRBuilder<> Builder(Values[v].second);
+      Value* Name = Builder.CreateGlobalStringPtr(F.getName().str() + "." + Values[v].first->getName().str(), "cad.profile.name");
+      Value* Extended = isUnsigned(Values[v].first) ? Builder.CreateZExt(Values[v].first, Builder.getInt64Ty()) : Builder.CreateSExt(Values[v].first, Builder.getInt64Ty());
+      Builder.CreateCall2(Record, Name, Extended);
+      InstrumentedCounter++;
+   }
+   return Values.size();
+}
@@ -0,0 +1,58 @@
+/**
+ * The MIT License (MIT)
+ * 
+ * Copyright (c) 2013 cad-projects
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+/**
+ * Author: Christian Pilato <christian.pilato@polimi.it>
+ *
+ * Description: This class defines the instrumentation of the kernels for the
+ *              profiling of the values: each integer parameter and instruction
+ *              of the functions selected with -function (and of their callees)
+ *              is recorded by the runtime (runtime/cad_profile.c), which writes
+ *              the observed range of each value at the exit of the program
+ */
+#ifndef DFGPROFILING_H
+#define DFGPROFILING_H
+
+#include "llvm/Pass.h"
+#include "llvm/Module.h"
+
+namespace llvm {
+
+class Constant;
+
+  // DfgProfiling
+  struct DfgProfiling : public ModulePass {
+    static char ID; // Pass identification, replacement for typeid
+    DfgProfiling() : ModulePass(ID) {}
+
+    virtual bool runOnModule(Module &M);
+
+    void getAnalysisUsage(AnalysisUsage &AU) const;
+
+    private:
+
+      /// inserts the recording of the values of the function, returns the number of instrumented values
+      unsigned int instrumentFunction(Function& F, Constant* Record);
+  };
+}
+
+#endif
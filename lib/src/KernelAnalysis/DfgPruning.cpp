@@ -0,0 +1,255 @@
+/**
+ * The MIT License (MIT)
+ * 
+ * Copyright (c) 2013 cad-projects
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+/**
+ * Author: Christian Pilato <christian.pilato@polimi.it>
+ *
+ * Description: Implementation of the pruning of the DFG. The observable outputs
+ *              are the stores, the calls, the returns, the parameters and the
+ *              conditions of the branches and switches: the nodes from which
+ *              none of them can be reached (through data, loop-carried and
+ *              predicate dependences) are removed. The index computations of
+ *              the accesses are added to the DFG first. A node belongs to the
+ *              access partition if all its users are loads, stores and calls
+ *              that use it to compute an address, or nodes of the access
+ *              partition. The
+ *              loads and stores of the same address (same affine form) share
+ *              the same address generation.
+ */
+#include "DfgPruning.h"
+
+#include "cad/Config.h"
+#include "cad/Support.h"
+
+#include "AffineIndex.h"
+#include "Dfg.h"
+#include "DfgGeneration.h"
+#include "DfgPredicates.h"
+
+#define DEBUG_TYPE "dfg-pruning"
+#include "llvm/Instructions.h"
+#include "llvm/Analysis/Dominators.h"
+#include "llvm/Support/raw_ostream.h"
+#include "llvm/ADT/Statistic.h"
+
+#include <algorithm>
+
+STATISTIC(DeadNodes, "[CAD] Number of DFG nodes removed by the pruning");
+STATISTIC(AccessNodes, "[CAD] Number of DFG nodes of the access partition");
+
+using namespace llvm;
+using namespace cadlib;
+
+void DfgPruning::getAnalysisUsage(AnalysisUsage &AU) const
+{
+   AU.addRequired<DfgGeneration>();
+   AU.addRequired<AffineIndex>();
+   AU.addRequired<DominatorTree>();
+   AU.setPreservesAll();
+}
+
+char DfgPruning::ID = 0;
+static const char dfg_pruning_name[] = "[CAD] DFG Pruning";
+INITIALIZE_PASS_BEGIN(DfgPruning, DEBUG_TYPE, dfg_pruning_name, false, false)
+INITIALIZE_PASS_DEPENDENCY(DfgGeneration)
+INITIALIZE_PASS_DEPENDENCY(AffineIndex)
+INITIALIZE_PASS_DEPENDENCY(DominatorTree)
+INITIALIZE_PASS_END(DfgPruning, DEBUG_TYPE, dfg_pruning_name, false, false)
+
+Pass* createDfgPruningPass() {
+   return new DfgPruning;
+}
+
+/// returns the pointer accessed by a load or a store (NULL for the other nodes)
+static const Value* getPointer(const DfgNode* N)
+{
+   if (N->Type == DfgNode::LOAD) return dyn_cast<LoadInst>(N->Op)->getPointerOperand();
+   if (N->Type == DfgNode::STORE) return dyn_cast<StoreInst>(N->Op)->getPointerOperand();
+   return NULL;
+}
+
+bool DfgPruning::runOnFunction(Function &F)
+{
+   if (std::find(functionNames.begin(), functionNames.end(), F.getName()) == functionNames.end())
+      return false;
+
+   errs() << "DFG Pruning: #" << F.getName() << "#\n";
+   DfgGeneration& DG = getAnalysis<DfgGeneration>();
+   DfgGraph* graph = DG.graph;
+   Access.clear();
+   AddressId.clear();
+   Addresses.clear();
+   if (!graph) return false;
+
+   ///the address generation is split from the datapath: the index computations become nodes
+   unsigned int Indexes = DG.addIndexNodes(graph);
+   errs() << " - " << Indexes << " index computations added\n";
+   if (DG.isHashConsing())
+   {
+      unsigned int Addresses = 0;
+      unsigned int Merged = DG.mergeEquivalentNodes(graph, F, getAnalysis<DominatorTree>(), Addresses);
+      errs() << " - hash-consing: " << Merged << " nodes merged, " << Addresses << " of them computing addresses\n";
+   }
+   graph->finalize();
+
+   unsigned int Removed = removeDeadNodes(graph, F);
+   computeAccessPartition(graph);
+   computeAddresses(graph);
+
+   unsigned int NumAccess = std::count(Access.begin(), Access.end(), true);
+   unsigned int NumMemory = graph->getNodes().size() - std::count(AddressId.begin(), AddressId.end(), ~0U);
+   errs() << " - " << Removed << " dead nodes removed\n";
+   errs() << " - " << NumAccess << " nodes in the access partition, " << graph->getNodes().size() - NumAccess << " in the datapath\n";
+   errs() << " - " << Addresses.size() << " distinct addresses for " << NumMemory << " loads and stores\n";
+   errs() << "##\n\n";
+   return false;
+}
+
+unsigned int DfgPruning::removeDeadNodes(DfgGraph* graph, Function& F)
+{
+   const std::vector<DfgNode*>& Nodes = graph->getNodes();
+   const DfgPredicates& Predicates = graph->getPredicates();
+   std::vector<bool> Live(Nodes.size(), false);
+   std::vector<DfgNode*> Worklist;
+   for(unsigned int n = 0; n < Nodes.size(); n++)
+   {
+      const DfgNode* N = Nodes[n];
+      if (N->Type == DfgNode::STORE || N->Type == DfgNode::CALL || dyn_cast<ReturnInst>(N->Op) || dyn_cast<Argument>(N->Op))
+         Worklist.push_back(Nodes[n]);
+   }
+   ///the control decisions
+   for(Function::iterator b = F.begin(); b != F.end(); b++)
+   {
+      const BranchInst* br = dyn_cast<BranchInst>(b->getTerminator());
+      if (br && br->isConditional() && graph->isNode(br->getCondition()))
+         Worklist.push_back(graph->getNode(br->getCondition()));
+      if (dyn_cast<SwitchInst>(b->getTerminator()) && graph->isNode(b->getTerminator()))
+         Worklist.push_back(graph->getNode(b->getTerminator()));
+   }
+
+   while (!Worklist.empty())
+   {
+      DfgNode* N = Worklist.back();
+      Worklist.pop_back();
+      if (Live[N->Id]) continue;
+      Live[N->Id] = true;
+      Worklist.insert(Worklist.end(), N->UseNodes.begin(), N->UseNodes.end());
+      for(unsigned int c = 0; c < N->CarriedNodes.size(); c++)
+         Worklist.push_back(N->CarriedNodes[c].first);
+      std::vector<unsigned int> Literals = Predicates.getLiterals(N->Predicate);
+      for(unsigned int l = 0; l < Literals.size(); l++)
+         Worklist.push_back(std::tr1::get<0>(Predicates.getCondition(Literals[l])));
+   }
+
+   std::map<DfgNode*, DfgNode*> Replacement;
+   for(unsigned int n = 0; n < Nodes.size(); n++)
+      if (!Live[n]) Replacement[Nodes[n]] = NULL;
+   DeadNodes += Replacement.size();
+   graph->replaceNodes(Replacement);
+   graph->finalize();
+   return Replacement.size();
+}
+
+void DfgPruning::computeAccessPartition(DfgGraph* graph)
+{
+   const std::vector<DfgNode*>& Nodes = graph->getNodes();
+   const DfgPredicates& Predicates = graph->getPredicates();
+   Access.assign(Nodes.size(), false);
+
+   ///the conditions of the predicates and the loop-carried values are used by the datapath
+   std::vector<bool> Datapath(Nodes.size(), false);
+   for(unsigned int n = 0; n < Nodes.size(); n++)
+   {
+      for(unsigned int c = 0; c < Nodes[n]->CarriedNodes.size(); c++)
+         Datapath[Nodes[n]->CarriedNodes[c].first->Id] = true;
+   }
+   for(unsigned int l = 0; l < Predicates.getNumLiterals(); l++)
+      Datapath[std::tr1::get<0>(Predicates.getCondition(l))->Id] = true;
+
+   ///users are visited before the nodes they use
+   const std::vector<DfgNode*>& Order = graph->getTopologicalOrder();
+   for(unsigned int o = Order.size(); o > 0; o--)
+   {
+      const DfgNode* N = Order[o-1];
+      if (Datapath[N->Id] || N->Type != DfgNode::INSTRUCTION || dyn_cast<PHINode>(N->Op) || graph->getFanOut(N) == 0) continue;
+      bool Address = true;
+      for(DfgGraph::node_iterator s = graph->succ_begin(N); s != graph->succ_end(N) && Address; s++)
+      {
+         const DfgNode* User = *s;
+         if (Access[User->Id]) continue;
+         if (User->Type == DfgNode::LOAD) continue;
+         ///the value of a store is not an address
+         if (User->Type == DfgNode::STORE)
+         {
+            const Value* Stored = getRealValue(dyn_cast<StoreInst>(User->Op)->getValueOperand());
+            if (!graph->isNode(Stored) || graph->getNode(Stored) != N) continue;
+         }
+         ///neither are the scalar arguments of a call
+         if (User->Type == DfgNode::CALL)
+         {
+            const CallInst* C = dyn_cast<CallInst>(User->Op);
+            bool Scalar = false;
+            for(unsigned int a = 0; a < C->getNumArgOperands(); a++)
+            {
+               const Value* Arg = getRealValue(C->getArgOperand(a));
+               Scalar |= !Arg->getType()->isPointerTy() && graph->isNode(Arg) && graph->getNode(Arg) == N;
+            }
+            if (!Scalar) continue;
+         }
+         Address = false;
+      }
+      Access[N->Id] = Address;
+      if (Address) ++AccessNodes;
+   }
+}
+
+void DfgPruning::computeAddresses(DfgGraph* graph)
+{
+   AffineIndex& AI = getAnalysis<AffineIndex>();
+   const std::vector<DfgNode*>& Nodes = graph->getNodes();
+   AddressId.assign(Nodes.size(), ~0U);
+   for(unsigned int n = 0; n < Nodes.size(); n++)
+   {
+      const Value* Ptr = getPointer(Nodes[n]);
+      if (!Ptr) continue;
+      for(unsigned int a = 0; a < Addresses.size() && AddressId[n] == ~0U; a++)
+      {
+         int64_t Distance = 0;
+         if (Addresses[a] == Ptr || (Addresses[a]->getType() == Ptr->getType() && AI.getDistance(Addresses[a], Ptr, Distance) && Distance == 0))
+            AddressId[n] = a;
+      }
+      if (AddressId[n] != ~0U) continue;
+      AddressId[n] = Addresses.size();
+      Addresses.push_back(Ptr);
+   }
+}
+
+bool DfgPruning::isAccess(const DfgNode* N) const
+{
+   return N->Id < Access.size() && Access[N->Id];
+}
+
+unsigned int DfgPruning::getAddressId(const DfgNode* N) const
+{
+   if (N->Id >= AddressId.size()) return ~0U;
+   return AddressId[N->Id];
+}
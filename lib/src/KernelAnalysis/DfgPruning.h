@@ -0,0 +1,81 @@
+/**
+ * The MIT License (MIT)
+ * 
+ * Copyright (c) 2013 cad-projects
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+/**
+ * Author: Christian Pilato <christian.pilato@polimi.it>
+ *
+ * Description: This class defines the DFG transformation that removes the nodes
+ *              that do not contribute to any observable output and splits the
+ *              address generation into a decoupled access partition
+ */
+#ifndef DFGPRUNING_H
+#define DFGPRUNING_H
+
+#include "llvm/Pass.h"
+#include "llvm/Function.h"
+
+#include <vector>
+
+namespace llvm {
+
+class DfgGraph;
+struct DfgNode;
+
+  // DfgPruning
+  struct DfgPruning : public FunctionPass {
+    static char ID; // Pass identification, replacement for typeid
+    DfgPruning() : FunctionPass(ID) {}
+
+    virtual bool runOnFunction(Function &F);
+
+    void getAnalysisUsage(AnalysisUsage &AU) const;
+
+    /// returns true if the node only computes addresses (access partition)
+    bool isAccess(const DfgNode* N) const;
+
+    /// returns the index in getAddresses() of the address of a load or store (~0U for the other nodes)
+    unsigned int getAddressId(const DfgNode* N) const;
+
+    /// returns the distinct addresses accessed by the loads and stores (one pointer for each address)
+    const std::vector<const Value*>& getAddresses() const
+    {
+       return Addresses;
+    }
+
+    private:
+
+      /// removes the nodes that reach neither a store, a call, a return nor a control decision
+      unsigned int removeDeadNodes(DfgGraph* graph, Function& F);
+
+      void computeAccessPartition(DfgGraph* graph);
+
+      void computeAddresses(DfgGraph* graph);
+
+      ///values indexed by node id
+      std::vector<bool> Access;
+      std::vector<unsigned int> AddressId;
+
+      std::vector<const Value*> Addresses;
+  };
+}
+
+#endif
@@ -0,0 +1,228 @@
+/**
+ * The MIT License (MIT)
+ * 
+ * Copyright (c) 2013 cad-projects
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+/**
+ * Author: Christian Pilato <christian.pilato@polimi.it>
+ *
+ * Description: Implementation of the transitive-dependence index of the DFG.
+ *              Small graphs store the complete transitive closure as bitsets,
+ *              while larger ones are labeled with the intervals of randomized
+ *              post-order traversals; together with the topological levels
+ *              computed by DfgGraph::finalize(), the labels reject most of the
+ *              negative queries in constant time and prune the search for the
+ *              remaining ones.
+ */
+#include "cad/Config.h"
+
+#include "DfgReachability.h"
+
+#include "Dfg.h"
+
+#include "llvm/Support/Format.h"
+#include "llvm/Support/raw_ostream.h"
+#include "llvm/Support/Timer.h"
+
+#include <algorithm>
+
+using namespace llvm;
+
+static cl::opt<unsigned int> closureLimit("dfg-reachability-closure",
+  cl::desc("[CAD] Maximum number of DFG nodes indexed with the full transitive closure"),
+  cl::init(4096));
+
+DfgReachability::DfgReachability(const DfgGraph& G) :
+   Graph(G), NumNodes(G.getNodes().size()), RowWords(0), NumLabels(0), Stamp(0)
+{
+   Visited.resize(NumNodes, 0);
+   if (!Graph.isAcyclic()) return;
+
+   if (NumNodes <= closureLimit)
+      computeClosure();
+   else
+      computeIntervals();
+}
+
+void DfgReachability::computeClosure()
+{
+   const std::vector<DfgNode*>& Order = Graph.getTopologicalOrder();
+   RowWords = (NumNodes + 63) / 64;
+   Closure.assign((unsigned long long)NumNodes * RowWords, 0);
+   ///successors are always completed before their predecessors
+   for(std::vector<DfgNode*>::const_reverse_iterator o = Order.rbegin(); o != Order.rend(); o++)
+   {
+      unsigned long long* Row = &Closure[(unsigned long long)(*o)->Id * RowWords];
+      for(DfgGraph::node_iterator s = Graph.succ_begin(*o); s != Graph.succ_end(*o); s++)
+      {
+         unsigned int Id = (*s)->Id;
+         const unsigned long long* SuccRow = &Closure[(unsigned long long)Id * RowWords];
+         for(unsigned int w = 0; w < RowWords; w++)
+            Row[w] |= SuccRow[w];
+         Row[Id / 64] |= 1ULL << (Id % 64);
+      }
+   }
+}
+
+void DfgReachability::computeIntervals()
+{
+   const std::vector<DfgNode*>& Roots = Graph.getTopologicalOrder();
+   NumLabels = 2;
+   Low.assign(NumLabels * NumNodes, 0);
+   Post.assign(NumLabels * NumNodes, 0);
+
+   std::vector<std::pair<const DfgNode*, unsigned int> > Stack;
+   for(unsigned int k = 0; k < NumLabels; k++)
+   {
+      unsigned int* L = &Low[k * NumNodes];
+      unsigned int* P = &Post[k * NumNodes];
+      unsigned int Rank = 0;
+      ///the second traversal visits roots and successors in reverse order
+      bool Reverse = (k % 2) == 1;
+      for(unsigned int r = 0; r < Roots.size(); r++)
+      {
+         const DfgNode* Root = Reverse ? Roots[Roots.size() - r - 1] : Roots[r];
+         if (P[Root->Id]) continue;
+         P[Root->Id] = ~0U;
+         L[Root->Id] = ~0U;
+         Stack.push_back(std::make_pair(Root, 0U));
+         while(!Stack.empty())
+         {
+            const DfgNode* n = Stack.back().first;
+            unsigned int Degree = Graph.getFanOut(n);
+            if (Stack.back().second < Degree)
+            {
+               unsigned int c = Stack.back().second++;
+               const DfgNode* s = *(Graph.succ_begin(n) + (Reverse ? Degree - c - 1 : c));
+               if (!P[s->Id])
+               {
+                  P[s->Id] = ~0U;
+                  L[s->Id] = ~0U;
+                  Stack.push_back(std::make_pair(s, 0U));
+               }
+               continue;
+            }
+            P[n->Id] = ++Rank;
+            L[n->Id] = std::min(L[n->Id], P[n->Id]);
+            for(DfgGraph::node_iterator s = Graph.succ_begin(n); s != Graph.succ_end(n); s++)
+               L[n->Id] = std::min(L[n->Id], L[(*s)->Id]);
+            Stack.pop_back();
+         }
+      }
+   }
+}
+
+bool DfgReachability::contains(unsigned int From, unsigned int To) const
+{
+   for(unsigned int k = 0; k < NumLabels; k++)
+   {
+      unsigned int f = k * NumNodes + From;
+      unsigned int t = k * NumNodes + To;
+      if (Low[t] < Low[f] || Post[t] > Post[f]) return false;
+   }
+   return true;
+}
+
+bool DfgReachability::search(unsigned int From, unsigned int To, bool Pruned) const
+{
+   if (++Stamp == 0)
+   {
+      std::fill(Visited.begin(), Visited.end(), 0);
+      Stamp = 1;
+   }
+   const std::vector<DfgNode*>& Nodes = Graph.getNodes();
+   unsigned int ToLevel = Nodes[To]->Level;
+   std::vector<const DfgNode*> Stack(1, Nodes[From]);
+   Visited[From] = Stamp;
+   while(!Stack.empty())
+   {
+      const DfgNode* n = Stack.back();
+      Stack.pop_back();
+      for(DfgGraph::node_iterator s = Graph.succ_begin(n); s != Graph.succ_end(n); s++)
+      {
+         unsigned int Id = (*s)->Id;
+         if (Id == To) return true;
+         if (Visited[Id] == Stamp) continue;
+         Visited[Id] = Stamp;
+         if (Pruned && ((*s)->Level >= ToLevel || !contains(Id, To))) continue;
+         Stack.push_back(*s);
+      }
+   }
+   return false;
+}
+
+bool DfgReachability::reaches(unsigned int From, unsigned int To) const
+{
+   assert(From < NumNodes && To < NumNodes && "node not indexed");
+   if (!Graph.isAcyclic()) return search(From, To, false);
+   const std::vector<DfgNode*>& Nodes = Graph.getNodes();
+   if (Nodes[From]->Level >= Nodes[To]->Level) return false;
+   if (!Closure.empty())
+      return (Closure[(unsigned long long)From * RowWords + To / 64] >> (To % 64)) & 1ULL;
+   if (!contains(From, To)) return false;
+   return search(From, To, true);
+}
+
+bool DfgReachability::reaches(const DfgNode* From, const DfgNode* To) const
+{
+   return reaches(From->Id, To->Id);
+}
+
+unsigned long long DfgReachability::getMemoryUsage() const
+{
+   unsigned long long Size = 0;
+   Size += (Low.size() + Post.size() + Visited.size()) * sizeof(unsigned int);
+   Size += Closure.size() * sizeof(unsigned long long);
+   return Size;
+}
+
+void DfgReachability::benchmark(unsigned int Queries) const
+{
+   if (!NumNodes || !Queries) return;
+
+   ///deterministic pseudo-random pairs, so that different runs are comparable
+   std::vector<std::pair<unsigned int, unsigned int> > Pairs(Queries);
+   unsigned long long Seed = 0x2545F4914F6CDD1DULL;
+   for(unsigned int q = 0; q < Queries; q++)
+   {
+      Seed = Seed * 6364136223846793005ULL + 1442695040888963407ULL;
+      Pairs[q].first = (unsigned int)((Seed >> 33) % NumNodes);
+      Seed = Seed * 6364136223846793005ULL + 1442695040888963407ULL;
+      Pairs[q].second = (unsigned int)((Seed >> 33) % NumNodes);
+   }
+
+   double Start = TimeRecord::getCurrentTime(true).getWallTime();
+   unsigned int Positive = 0;
+   for(unsigned int q = 0; q < Queries; q++)
+      if (reaches(Pairs[q].first, Pairs[q].second)) Positive++;
+   double Elapsed = TimeRecord::getCurrentTime(false).getWallTime() - Start;
+
+   ///cross-check a sample of the answers against an unpruned search
+   unsigned int Mismatches = 0;
+   for(unsigned int q = 0; q < std::min(Queries, 1000U); q++)
+      if (reaches(Pairs[q].first, Pairs[q].second) != search(Pairs[q].first, Pairs[q].second, false)) Mismatches++;
+
+   errs() << "DFG reachability: " << NumNodes << " nodes, " << (Graph.isAcyclic() ? (Closure.empty() ? "interval labels" : "transitive closure") : "not indexed");
+   errs() << ", " << getMemoryUsage() << " bytes\n";
+   errs() << " - " << Queries << " queries (" << Positive << " positive) in " << format("%.6f", Elapsed) << " s";
+   if (Elapsed > 0) errs() << " = " << format("%.0f", Queries / Elapsed) << " queries/s";
+   errs() << "\n";
+   if (Mismatches) errs() << "ERROR: " << Mismatches << " wrong answers from the reachability index\n";
+}
@@ -0,0 +1,95 @@
+/**
+ * The MIT License (MIT)
+ * 
+ * Copyright (c) 2013 cad-projects
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+/**
+ * Author: Christian Pilato <christian.pilato@polimi.it>
+ *
+ * Description: This file defines the transitive-dependence index used to answer
+ *              reachability queries between the nodes of a DFG.
+ */
+#ifndef DFGREACHABILITY_H
+#define DFGREACHABILITY_H
+
+#include <vector>
+
+namespace llvm {
+
+class DfgGraph;
+struct DfgNode;
+
+class DfgReachability
+{
+
+   private:
+
+      ///indexed graph (adjacency, levels and topological order come from DfgGraph::finalize())
+      const DfgGraph& Graph;
+
+      ///number of nodes in the indexed graph
+      unsigned int NumNodes;
+
+      ///full transitive closure, one bit row per node (small graphs only)
+      std::vector<unsigned long long> Closure;
+      unsigned int RowWords;
+
+      ///interval labels [Low, Post] of the randomized post-order traversals (large graphs)
+      std::vector<unsigned int> Low;
+      std::vector<unsigned int> Post;
+      unsigned int NumLabels;
+
+      ///visit marks of the guided searches (a query stamps the nodes it visits)
+      mutable std::vector<unsigned int> Visited;
+      mutable unsigned int Stamp;
+
+      void computeClosure();
+
+      void computeIntervals();
+
+      bool contains(unsigned int From, unsigned int To) const;
+
+      bool search(unsigned int From, unsigned int To, bool Pruned) const;
+
+   public:
+
+      DfgReachability(const DfgGraph& Graph);
+
+      /// returns true if there is a (non-empty) dependence path from From to To
+      bool reaches(const DfgNode* From, const DfgNode* To) const;
+
+      bool reaches(unsigned int From, unsigned int To) const;
+
+      /// approximated memory footprint of the index (in bytes)
+      unsigned long long getMemoryUsage() const;
+
+      bool isClosure() const
+      {
+         return !Closure.empty();
+      }
+
+      /// runs the given number of random queries and reports the throughput
+      void benchmark(unsigned int Queries) const;
+
+};
+
+}
+
+#endif
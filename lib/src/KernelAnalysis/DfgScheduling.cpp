@@ -0,0 +1,344 @@
+/**
+ * The MIT License (MIT)
+ * 
+ * Copyright (c) 2013 cad-projects
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+/**
+ * Author: Christian Pilato <christian.pilato@polimi.it>
+ *
+ * Description: Implementation of the scheduling of the DFG. Each basic block is
+ *              scheduled independently: ASAP and ALAP times are computed on the
+ *              dependences, then a list scheduler (ALAP-based priority) assigns
+ *              the operations to the clock cycles, limiting the number of units
+ *              per opcode and the number of ports of each memory.
+ */
+#include "DfgScheduling.h"
+
+#include "cad/Config.h"
+
+#include "Dfg.h"
+#include "DfgGeneration.h"
+#include "DfgMemoryDependence.h"
+
+#define DEBUG_TYPE "dfg-scheduling"
+#include "llvm/Instructions.h"
+#include "llvm/Support/raw_ostream.h"
+#include "llvm/ADT/Statistic.h"
+
+#include <functional>
+#include <queue>
+
+STATISTIC(ScheduledOps, "[CAD] Number of scheduled DFG operations");
+
+using namespace llvm;
+using namespace cadlib;
+
+void DfgScheduling::getAnalysisUsage(AnalysisUsage &AU) const
+{
+   AU.addRequired<DfgGeneration>();
+   AU.setPreservesAll();
+}
+
+char DfgScheduling::ID = 0;
+static const char dfg_scheduling_name[] = "[CAD] DFG Scheduling";
+INITIALIZE_PASS_BEGIN(DfgScheduling, DEBUG_TYPE, dfg_scheduling_name, false, false)
+INITIALIZE_PASS_DEPENDENCY(DfgGeneration)
+INITIALIZE_PASS_END(DfgScheduling, DEBUG_TYPE, dfg_scheduling_name, false, false)
+
+Pass* createDfgSchedulingPass() {
+   return new DfgScheduling;
+}
+
+bool DfgScheduling::doInitialization(Module &M)
+{
+   if (configFile.size())
+      Library.parseConfig(configFile);
+   return false;
+}
+
+bool DfgScheduling::runOnFunction(Function &F)
+{
+   if (std::find(functionNames.begin(), functionNames.end(), F.getName()) == functionNames.end())
+      return false;
+
+   errs() << "DFG Scheduling: #" << F.getName() << "#\n";
+   DfgGeneration& DG = getAnalysis<DfgGeneration>();
+   DfgGraph* graph = DG.graph;
+   if (!graph) return false;
+
+   unsigned int NumNodes = graph->getNodes().size();
+   Cycle.assign(NumNodes, ~0U);
+   Asap.assign(NumNodes, ~0U);
+   Alap.assign(NumNodes, ~0U);
+   Latency.assign(NumNodes, 0);
+   BbLatency.clear();
+
+   const std::map<unsigned int, std::vector<const Value*> >& bbNodes = graph->getBbNodes();
+   for(std::map<unsigned int, std::vector<const Value*> >::const_iterator bb = bbNodes.begin(); bb != bbNodes.end(); bb++)
+   {
+      if (bb->first == 0) continue;
+      scheduleBasicBlock(graph, bb->first);
+   }
+
+   errs() << "##\n\n";
+   return false;
+}
+
+void DfgScheduling::scheduleBasicBlock(DfgGraph* graph, unsigned int bb)
+{
+   ///operations of the basic block, in program order
+   const std::vector<const Value*>& Values = graph->getBbNode(bb);
+   std::vector<DfgNode*> Ops;
+   std::map<unsigned int, unsigned int> LocalIdx;
+   for(unsigned int i = 0; i < Values.size(); i++)
+   {
+      if (!dyn_cast<Instruction>(Values[i]) || !graph->isNode(Values[i])) continue;
+      DfgNode* n = graph->getNode(Values[i]);
+      if (LocalIdx.find(n->Id) != LocalIdx.end()) continue;
+      LocalIdx[n->Id] = Ops.size();
+      Ops.push_back(n);
+   }
+   unsigned int NumOps = Ops.size();
+   BbLatency[bb] = 0;
+   if (!NumOps) return;
+
+   ///resource classes: 0 is unlimited, then one class for each constrained opcode and memory
+   std::vector<unsigned int> Class(NumOps, 0);
+   std::vector<unsigned int> Capacity(1, 0);
+   std::map<std::string, unsigned int> OpClass;
+   std::map<const Value*, unsigned int> MemClass;
+   std::vector<unsigned int> Lat(NumOps, 0);
+   std::vector<std::pair<unsigned int, unsigned int> > Edges;
+   std::map<const Value*, unsigned int> LastStore;
+   std::map<const Value*, std::vector<unsigned int> > LoadsSinceStore;
+   DfgMemoryDependence* Dependences = getAnalysisIfAvailable<DfgMemoryDependence>();
+   for(unsigned int i = 0; i < NumOps; i++)
+   {
+      DfgNode* n = Ops[i];
+      std::string Opcode = OperatorLibrary::getOpcode(n->Op);
+      Lat[i] = Library.getLatency(Opcode, n->getWidth());
+
+      for(DfgGraph::node_iterator p = graph->pred_begin(n); p != graph->pred_end(n); p++)
+      {
+         std::map<unsigned int, unsigned int>::iterator l = LocalIdx.find((*p)->Id);
+         if (l != LocalIdx.end()) Edges.push_back(std::make_pair(l->second, i));
+      }
+
+      if (n->Type == DfgNode::LOAD || n->Type == DfgNode::STORE)
+      {
+         const Value* Ptr = n->Type == DfgNode::LOAD ? dyn_cast<LoadInst>(n->Op)->getPointerOperand() : dyn_cast<StoreInst>(n->Op)->getPointerOperand();
+         const Value* Var = getMemoryVar(Ptr);
+         if (MemClass.find(Var) == MemClass.end())
+         {
+            MemClass[Var] = Capacity.size();
+            Capacity.push_back(Library.getMemoryPorts());
+         }
+         Class[i] = MemClass[Var];
+
+         if (Dependences)
+         {
+            ///only the accesses that may overlap are ordered
+            const std::vector<DfgMemoryDependence::Dependence>& Deps = Dependences->getDependences(n);
+            for(unsigned int d = 0; d < Deps.size(); d++)
+            {
+               std::map<unsigned int, unsigned int>::iterator l = LocalIdx.find(Deps[d].first->Id);
+               if (l != LocalIdx.end()) Edges.push_back(std::make_pair(l->second, i));
+            }
+         }
+         else
+         {
+            ///without the memory dependence analysis, accesses to the same memory are kept in program order (RAW, WAR and WAW)
+            if (LastStore.find(Var) != LastStore.end())
+               Edges.push_back(std::make_pair(LastStore[Var], i));
+            if (n->Type == DfgNode::LOAD)
+            {
+               LoadsSinceStore[Var].push_back(i);
+            }
+            else
+            {
+               std::vector<unsigned int>& Loads = LoadsSinceStore[Var];
+               for(unsigned int l = 0; l < Loads.size(); l++)
+                  Edges.push_back(std::make_pair(Loads[l], i));
+               Loads.clear();
+               LastStore[Var] = i;
+            }
+         }
+      }
+      else if (unsigned int Units = Library.getUnits(Opcode))
+      {
+         if (OpClass.find(Opcode) == OpClass.end())
+         {
+            OpClass[Opcode] = Capacity.size();
+            Capacity.push_back(Units);
+         }
+         Class[i] = OpClass[Opcode];
+      }
+   }
+
+   ///local dependences in compressed form
+   std::vector<unsigned int> SuccBegin(NumOps + 1, 0);
+   std::vector<unsigned int> InDegree(NumOps, 0);
+   for(unsigned int e = 0; e < Edges.size(); e++)
+   {
+      SuccBegin[Edges[e].first + 1]++;
+      InDegree[Edges[e].second]++;
+   }
+   for(unsigned int i = 0; i < NumOps; i++)
+      SuccBegin[i+1] += SuccBegin[i];
+   std::vector<unsigned int> Succ(Edges.size());
+   std::vector<unsigned int> Next(SuccBegin.begin(), SuccBegin.end() - 1);
+   for(unsigned int e = 0; e < Edges.size(); e++)
+      Succ[Next[Edges[e].first]++] = Edges[e].second;
+
+   ///ASAP on a topological order of the local dependences
+   std::vector<unsigned int> Order;
+   std::vector<unsigned int> Remaining(InDegree);
+   std::vector<unsigned int> LocalAsap(NumOps, 0);
+   Order.reserve(NumOps);
+   for(unsigned int i = 0; i < NumOps; i++)
+      if (InDegree[i] == 0) Order.push_back(i);
+   for(unsigned int o = 0; o < Order.size(); o++)
+   {
+      unsigned int i = Order[o];
+      for(unsigned int e = SuccBegin[i]; e < SuccBegin[i+1]; e++)
+      {
+         LocalAsap[Succ[e]] = std::max(LocalAsap[Succ[e]], LocalAsap[i] + Lat[i]);
+         if (--Remaining[Succ[e]] == 0) Order.push_back(Succ[e]);
+      }
+   }
+   assert(Order.size() == NumOps && "Cyclic dependences in the basic block");
+
+   ///ALAP with respect to the critical path
+   unsigned int Length = 0;
+   for(unsigned int i = 0; i < NumOps; i++)
+      Length = std::max(Length, LocalAsap[i] + Lat[i]);
+   std::vector<unsigned int> LocalAlap(NumOps, 0);
+   for(std::vector<unsigned int>::reverse_iterator o = Order.rbegin(); o != Order.rend(); o++)
+   {
+      unsigned int i = *o;
+      unsigned int Deadline = Length;
+      for(unsigned int e = SuccBegin[i]; e < SuccBegin[i+1]; e++)
+         Deadline = std::min(Deadline, LocalAlap[Succ[e]]);
+      LocalAlap[i] = Deadline - Lat[i];
+   }
+
+   ///list scheduling: operations whose predecessors are scheduled wait in Pending until their
+   ///operands are available, then compete for the units of their class by ALAP (mobility)
+   typedef std::pair<unsigned int, unsigned int> Pending_t;
+   typedef std::pair<std::pair<unsigned int, unsigned int>, unsigned int> Ready_t;
+   std::priority_queue<Pending_t, std::vector<Pending_t>, std::greater<Pending_t> > Pending;
+   std::vector<std::priority_queue<Ready_t, std::vector<Ready_t>, std::greater<Ready_t> > > Ready(Capacity.size());
+   std::vector<unsigned int> Earliest(NumOps, 0);
+   std::vector<unsigned int> Start(NumOps, 0);
+   Remaining = InDegree;
+   for(unsigned int i = 0; i < NumOps; i++)
+      if (InDegree[i] == 0) Pending.push(Pending_t(0, i));
+
+   unsigned int Scheduled = 0;
+   unsigned int Current = 0;
+   unsigned int NumReady = 0;
+   Length = 0;
+   while(Scheduled < NumOps)
+   {
+      if (!NumReady && Pending.top().first > Current)
+         Current = Pending.top().first;
+      ///operations with zero latency (e.g., wires) are chained with their successors in the same cycle
+      std::vector<unsigned int> Used(Ready.size(), 0);
+      for(bool Chained = true; Chained; )
+      {
+         Chained = false;
+         while(!Pending.empty() && Pending.top().first <= Current)
+         {
+            unsigned int i = Pending.top().second;
+            Pending.pop();
+            Ready[Class[i]].push(Ready_t(std::make_pair(LocalAlap[i], LocalAsap[i]), i));
+            NumReady++;
+         }
+         for(unsigned int c = 0; c < Ready.size(); c++)
+         {
+            for(; !Ready[c].empty() && (Capacity[c] == 0 || Used[c] < Capacity[c]); Used[c]++)
+            {
+               unsigned int i = Ready[c].top().second;
+               Ready[c].pop();
+               NumReady--;
+               Scheduled++;
+               Start[i] = Current;
+               Length = std::max(Length, Current + Lat[i]);
+               for(unsigned int e = SuccBegin[i]; e < SuccBegin[i+1]; e++)
+               {
+                  unsigned int s = Succ[e];
+                  Earliest[s] = std::max(Earliest[s], Current + Lat[i]);
+                  if (--Remaining[s] == 0) Pending.push(Pending_t(Earliest[s], s));
+               }
+               if (Lat[i] == 0) Chained = true;
+            }
+         }
+      }
+      Current++;
+   }
+
+   for(unsigned int i = 0; i < NumOps; i++)
+   {
+      unsigned int Id = Ops[i]->Id;
+      Cycle[Id] = Start[i];
+      Asap[Id] = LocalAsap[i];
+      Alap[Id] = LocalAlap[i];
+      Latency[Id] = Lat[i];
+   }
+   ScheduledOps += NumOps;
+   BbLatency[bb] = Length;
+   errs() << " - bb " << bb << ": " << NumOps << " operations, latency = " << Length << " cycles\n";
+}
+
+bool DfgScheduling::isScheduled(const DfgNode* N) const
+{
+   return N->Id < Cycle.size() && Cycle[N->Id] != ~0U;
+}
+
+unsigned int DfgScheduling::getCycle(const DfgNode* N) const
+{
+   assert(isScheduled(N) && "operation not scheduled");
+   return Cycle[N->Id];
+}
+
+unsigned int DfgScheduling::getAsap(const DfgNode* N) const
+{
+   assert(isScheduled(N) && "operation not scheduled");
+   return Asap[N->Id];
+}
+
+unsigned int DfgScheduling::getAlap(const DfgNode* N) const
+{
+   assert(isScheduled(N) && "operation not scheduled");
+   return Alap[N->Id];
+}
+
+unsigned int DfgScheduling::getLatency(const DfgNode* N) const
+{
+   assert(isScheduled(N) && "operation not scheduled");
+   return Latency[N->Id];
+}
+
+unsigned int DfgScheduling::getBbLatency(unsigned int bb) const
+{
+   std::map<unsigned int, unsigned int>::const_iterator It = BbLatency.find(bb);
+   if (It == BbLatency.end()) return 0;
+   return It->second;
+}
@@ -0,0 +1,88 @@
+/**
+ * The MIT License (MIT)
+ * 
+ * Copyright (c) 2013 cad-projects
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+/**
+ * Author: Christian Pilato <christian.pilato@polimi.it>
+ *
+ * Description: This class defines the pass for scheduling the operations of the
+ *              DFG (ASAP, ALAP and resource-constrained list scheduling of each
+ *              basic block)
+ */
+#ifndef DFGSCHEDULING_H
+#define DFGSCHEDULING_H
+
+#include "OperatorLibrary.h"
+
+#include "llvm/Pass.h"
+#include "llvm/Function.h"
+
+#include <map>
+#include <vector>
+
+namespace llvm {
+
+class DfgGraph;
+struct DfgNode;
+
+  // DfgScheduling
+  struct DfgScheduling : public FunctionPass {
+    static char ID; // Pass identification, replacement for typeid
+    DfgScheduling() : FunctionPass(ID) {}
+
+    OperatorLibrary Library;
+
+    virtual bool doInitialization(Module &M);
+
+    virtual bool runOnFunction(Function &F);
+
+    void getAnalysisUsage(AnalysisUsage &AU) const;
+
+    bool isScheduled(const DfgNode* N) const;
+
+    /// returns the cycle (relative to the start of the basic block) when the operation starts
+    unsigned int getCycle(const DfgNode* N) const;
+
+    unsigned int getAsap(const DfgNode* N) const;
+
+    unsigned int getAlap(const DfgNode* N) const;
+
+    /// returns the latency of the operation (in cycles)
+    unsigned int getLatency(const DfgNode* N) const;
+
+    /// returns the latency of the basic block (in cycles)
+    unsigned int getBbLatency(unsigned int bb) const;
+
+    private:
+
+      void scheduleBasicBlock(DfgGraph* graph, unsigned int bb);
+
+      ///values indexed by node id (~0U for operations that are not scheduled)
+      std::vector<unsigned int> Cycle;
+      std::vector<unsigned int> Asap;
+      std::vector<unsigned int> Alap;
+      std::vector<unsigned int> Latency;
+
+      std::map<unsigned int, unsigned int> BbLatency;
+  };
+}
+
+#endif
@@ -0,0 +1,200 @@
+/**
+ * The MIT License (MIT)
+ * 
+ * Copyright (c) 2013 cad-projects
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+/**
+ * Author: Christian Pilato <christian.pilato@polimi.it>
+ *
+ * Description: Implementation of the stencil analysis. The address of each load
+ *              is taken in its affine form (AffineIndex): the loads of a stream form
+ *              a window when their addresses differ only by a constant (the
+ *              column) and by a multiple of a single symbolic stride (the row,
+ *              e.g. the image width dimh). Since the window slides along the
+ *              row, rows-1 line buffers of RowStride elements plus the window
+ *              registers are enough to read each element once.
+ */
+#include "DfgStencil.h"
+
+#include "cad/Config.h"
+
+#include "AffineIndex.h"
+#include "Dfg.h"
+#include "DfgGeneration.h"
+
+#define DEBUG_TYPE "dfg-stencil"
+#include "llvm/Instructions.h"
+#include "llvm/Support/raw_ostream.h"
+
+using namespace llvm;
+using namespace cadlib;
+
+void DfgStencil::getAnalysisUsage(AnalysisUsage &AU) const
+{
+   AU.addRequired<DfgGeneration>();
+   AU.addRequired<AffineIndex>();
+   AU.setPreservesAll();
+}
+
+char DfgStencil::ID = 0;
+static const char dfg_stencil_name[] = "[CAD] DFG Stencil Analysis";
+INITIALIZE_PASS_BEGIN(DfgStencil, DEBUG_TYPE, dfg_stencil_name, false, false)
+INITIALIZE_PASS_DEPENDENCY(DfgGeneration)
+INITIALIZE_PASS_DEPENDENCY(AffineIndex)
+INITIALIZE_PASS_END(DfgStencil, DEBUG_TYPE, dfg_stencil_name, false, false)
+
+Pass* createDfgStencilPass() {
+   return new DfgStencil;
+}
+
+bool DfgStencil::runOnFunction(Function &F)
+{
+   if (std::find(functionNames.begin(), functionNames.end(), F.getName()) == functionNames.end())
+      return false;
+
+   errs() << "DFG Stencil Analysis: #" << F.getName() << "#\n";
+   DfgGeneration& DG = getAnalysis<DfgGeneration>();
+   DfgGraph* graph = DG.graph;
+   AffineIndex& AI = getAnalysis<AffineIndex>();
+   Windows.clear();
+   if (!graph) return false;
+
+   ///loads of each stream, with the offset of the accessed element
+   std::map<const Value*, std::vector<std::pair<const DfgNode*, AffineForm> > > Loads;
+   std::set<const Value*> Unsupported;
+   const std::vector<DfgNode*>& Nodes = graph->getNodes();
+   for(unsigned int i = 0; i < Nodes.size(); i++)
+   {
+      if (Nodes[i]->Type != DfgNode::LOAD) continue;
+      const Value* Ptr = dyn_cast<LoadInst>(Nodes[i]->Op)->getPointerOperand();
+      const Value* Stream = getMemoryVar(Ptr);
+      const AffineForm* Offset = AI.getAddress(Ptr);
+      ///the accesses to this stream cannot be described by a window
+      if (!Offset)
+      {
+         Unsupported.insert(Stream);
+         continue;
+      }
+      Loads[Stream].push_back(std::make_pair(Nodes[i], *Offset));
+   }
+
+   for(std::map<const Value*, std::vector<std::pair<const DfgNode*, AffineForm> > >::iterator l = Loads.begin(); l != Loads.end(); l++)
+   {
+      Window W;
+      if (Unsupported.find(l->first) != Unsupported.end() || !analyzeStream(l->second, W)) continue;
+      Windows[l->first] = W;
+      errs() << " - " << l->first->getName() << ": " << W.getRows() << "x" << W.getColumns() << " window";
+      if (!W.RowStride.empty())
+         errs() << ", " << W.getRows() - 1 << " line buffers of " << AffineForm::getString(W.RowStride) << " elements";
+      errs() << ", " << W.Accesses.size() << " loads -> " << W.getNewElements() << " elements read per invocation\n";
+   }
+   errs() << "##\n\n";
+   return false;
+}
+
+bool DfgStencil::analyzeStream(const std::vector<std::pair<const DfgNode*, AffineForm> >& Loads, Window& W)
+{
+   if (Loads.size() < 2) return false;
+
+   ///the differences with the first access may only contain a constant and a single stride
+   const AffineForm& Ref = Loads[0].second;
+   bool HasStride = false;
+   for(unsigned int l = 1; l < Loads.size(); l++)
+   {
+      AffineForm Diff = Loads[l].second;
+      Diff.add(Ref, -1);
+      for(std::map<AffineForm::Monomial, int64_t>::const_iterator t = Diff.Terms.begin(); t != Diff.Terms.end(); t++)
+      {
+         if (HasStride && t->first != W.RowStride) return false;
+         HasStride = true;
+         W.RowStride = t->first;
+      }
+   }
+
+   ///the index is the offset without the displacement of the access in the window
+   W.Index = Ref;
+   W.Index.Constant = 0;
+   if (HasStride) W.Index.Terms.erase(W.RowStride);
+   for(unsigned int l = 0; l < Loads.size(); l++)
+   {
+      int64_t Row = HasStride ? Loads[l].second.getCoefficient(W.RowStride) : 0;
+      int64_t Column = Loads[l].second.Constant;
+      W.Accesses.push_back(std::make_pair(Loads[l].first, std::make_pair(Row, Column)));
+      W.MinRow = l ? std::min(W.MinRow, Row) : Row;
+      W.MaxRow = l ? std::max(W.MaxRow, Row) : Row;
+      W.MinColumn = l ? std::min(W.MinColumn, Column) : Column;
+      W.MaxColumn = l ? std::max(W.MaxColumn, Column) : Column;
+   }
+
+   ///the column index appears alone in the index, the row index multiplied by the stride. The terms are ordered by
+   ///pointer, so the column index is chosen by its kind (the parameters of the kernel before the computed values) and
+   ///then by the smallest step; the indexes are unknown if the choice is ambiguous
+   W.RowIndex = 0;
+   W.ColumnIndex = 0;
+   W.Step = 0;
+   bool AmbiguousColumn = false, AmbiguousRow = false;
+   for(std::map<AffineForm::Monomial, int64_t>::const_iterator t = W.Index.Terms.begin(); t != W.Index.Terms.end(); t++)
+   {
+      if (t->first.size() == 1)
+      {
+         bool Parameter = dyn_cast<Argument>(t->first[0]) != NULL;
+         bool Current = W.ColumnIndex && dyn_cast<Argument>(W.ColumnIndex) != NULL;
+         uint64_t Step = t->second < 0 ? 0 - (uint64_t)t->second : (uint64_t)t->second;
+         uint64_t CurrentStep = W.Step < 0 ? 0 - (uint64_t)W.Step : (uint64_t)W.Step;
+         if (!W.ColumnIndex || (Parameter && !Current) || (Parameter == Current && Step < CurrentStep))
+         {
+            W.ColumnIndex = t->first[0];
+            W.Step = t->second;
+            AmbiguousColumn = false;
+         }
+         else if (Parameter == Current && Step == CurrentStep)
+            AmbiguousColumn = true;
+      }
+      else if (HasStride && t->first.size() == 2 && std::find(t->first.begin(), t->first.end(), W.RowStride[0]) != t->first.end() && W.RowStride.size() == 1)
+      {
+         AmbiguousRow = W.RowIndex != 0;
+         W.RowIndex = t->first[0] == W.RowStride[0] ? t->first[1] : t->first[0];
+      }
+   }
+   if (AmbiguousColumn)
+   {
+      W.ColumnIndex = 0;
+      W.Step = 0;
+   }
+   if (AmbiguousRow) W.RowIndex = 0;
+
+   ///there is reuse only if consecutive invocations access the same elements
+   return W.Accesses.size() > W.getNewElements();
+}
+
+unsigned int DfgStencil::Window::getNewElements() const
+{
+   ///when the column index is unknown, the window does not slide and all the elements are read
+   if (Step <= 0) return Accesses.size();
+   ///otherwise, only the elements entering the last row of the window are read, the others are in the line buffers
+   return std::min((uint64_t)Step, (uint64_t)getColumns());
+}
+
+const DfgStencil::Window* DfgStencil::getWindow(const Value* Stream) const
+{
+   std::map<const Value*, Window>::const_iterator w = Windows.find(Stream);
+   if (w == Windows.end()) return NULL;
+   return &w->second;
+}
@@ -0,0 +1,100 @@
+/**
+ * The MIT License (MIT)
+ * 
+ * Copyright (c) 2013 cad-projects
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+/**
+ * Author: Christian Pilato <christian.pilato@polimi.it>
+ *
+ * Description: This class defines the analysis of the stencil accesses (e.g.,
+ *              the 3x3 neighbourhood of a pixel) to the input streams, used to
+ *              describe the line buffers and the sliding window that let the
+ *              hardware read each element of the stream only once
+ */
+#ifndef DFGSTENCIL_H
+#define DFGSTENCIL_H
+
+#include "cad/Support.h"
+
+#include "llvm/Pass.h"
+#include "llvm/Function.h"
+
+#include <map>
+#include <string>
+#include <vector>
+
+namespace llvm {
+
+class DfgGraph;
+struct DfgNode;
+
+  // DfgStencil
+  struct DfgStencil : public FunctionPass {
+    static char ID; // Pass identification, replacement for typeid
+    DfgStencil() : FunctionPass(ID) {}
+
+    ///sliding window of the accesses to a stream: each access is at (row, column) with respect to the
+    ///index of the invocation, i.e., at offset Index + row * RowStride + column
+    struct Window
+    {
+       ///offset of the accesses without the window displacement
+       cadlib::AffineForm Index;
+       ///distance between two consecutive rows (empty monomial for one-dimensional windows)
+       cadlib::AffineForm::Monomial RowStride;
+       ///variables that select the row and the column of the window (NULL if not identified)
+       const Value* RowIndex;
+       const Value* ColumnIndex;
+       ///displacement of the window when the column index is incremented by one
+       int64_t Step;
+       int64_t MinRow, MaxRow, MinColumn, MaxColumn;
+       ///load operations with their position in the window
+       std::vector<std::pair<const DfgNode*, std::pair<int64_t, int64_t> > > Accesses;
+
+       unsigned int getRows() const
+       {
+          return MaxRow - MinRow + 1;
+       }
+
+       unsigned int getColumns() const
+       {
+          return MaxColumn - MinColumn + 1;
+       }
+
+       /// returns the number of elements read from the stream by each invocation
+       unsigned int getNewElements() const;
+    };
+
+    virtual bool runOnFunction(Function &F);
+
+    void getAnalysisUsage(AnalysisUsage &AU) const;
+
+    /// returns the window of the accesses to the stream (NULL if the accesses do not form a window with reuse)
+    const Window* getWindow(const Value* Stream) const;
+
+    private:
+
+      /// checks if the accesses to a stream form a window
+      bool analyzeStream(const std::vector<std::pair<const DfgNode*, cadlib::AffineForm> >& Loads, Window& W);
+
+      std::map<const Value*, Window> Windows;
+  };
+}
+
+#endif
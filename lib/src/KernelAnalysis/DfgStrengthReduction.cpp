@@ -0,0 +1,228 @@
+/**
+ * The MIT License (MIT)
+ * 
+ * Copyright (c) 2013 cad-projects
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+/**
+ * Author: Christian Pilato <christian.pilato@polimi.it>
+ *
+ * Description: Implementation of the strength reduction of the multiplications
+ *              by constants. Multiplications by 0 and 1 are removed, those by
+ *              powers of two become shifts; otherwise, the constant is recoded
+ *              in canonical signed digits and the multiplication is replaced by
+ *              the corresponding shifts and additions/subtractions when their
+ *              area (from the operator library) is lower than the multiplier.
+ */
+#include "DfgStrengthReduction.h"
+
+#include "cad/Config.h"
+
+#include "Dfg.h"
+#include "DfgGeneration.h"
+
+#define DEBUG_TYPE "dfg-strength-reduction"
+#include "llvm/Constants.h"
+#include "llvm/Instructions.h"
+#include "llvm/Support/raw_ostream.h"
+#include "llvm/ADT/Statistic.h"
+
+STATISTIC(ReducedMuls, "[CAD] Number of multiplications by constants replaced by shifts and additions");
+
+using namespace llvm;
+using namespace cadlib;
+
+void DfgStrengthReduction::getAnalysisUsage(AnalysisUsage &AU) const
+{
+   AU.addRequired<DfgGeneration>();
+   AU.setPreservesAll();
+}
+
+char DfgStrengthReduction::ID = 0;
+static const char dfg_strength_reduction_name[] = "[CAD] DFG Strength Reduction";
+INITIALIZE_PASS_BEGIN(DfgStrengthReduction, DEBUG_TYPE, dfg_strength_reduction_name, false, false)
+INITIALIZE_PASS_DEPENDENCY(DfgGeneration)
+INITIALIZE_PASS_END(DfgStrengthReduction, DEBUG_TYPE, dfg_strength_reduction_name, false, false)
+
+Pass* createDfgStrengthReductionPass() {
+   return new DfgStrengthReduction;
+}
+
+bool DfgStrengthReduction::doInitialization(Module &M)
+{
+   if (configFile.size())
+      Library.parseConfig(configFile);
+   return false;
+}
+
+std::vector<std::pair<unsigned int, int> > DfgStrengthReduction::getCSD(int64_t C)
+{
+   std::vector<std::pair<unsigned int, int> > Digits;
+   int Sign = C < 0 ? -1 : 1;
+   uint64_t M = C < 0 ? -(uint64_t)C : (uint64_t)C;
+   for(unsigned int Shift = 0; M; Shift++, M >>= 1)
+   {
+      if (!(M & 1)) continue;
+      ///...01 gives digit +1, ...11 gives digit -1 (and a carry)
+      if (M & 2)
+      {
+         Digits.push_back(std::make_pair(Shift, -Sign));
+         M++;
+      }
+      else
+      {
+         Digits.push_back(std::make_pair(Shift, Sign));
+         M--;
+      }
+   }
+   return Digits;
+}
+
+bool DfgStrengthReduction::runOnFunction(Function &F)
+{
+   if (std::find(functionNames.begin(), functionNames.end(), F.getName()) == functionNames.end())
+      return false;
+
+   errs() << "DFG Strength Reduction: #" << F.getName() << "#\n";
+   DfgGeneration& DG = getAnalysis<DfgGeneration>();
+   DfgGraph* graph = DG.graph;
+   if (!graph) return false;
+
+   Replacement.clear();
+   std::vector<DfgNode*> Order = graph->getTopologicalOrder();
+   for(unsigned int o = 0; o < Order.size(); o++)
+   {
+      DfgNode* MulNode = Order[o];
+      const Instruction* Mul = dyn_cast<Instruction>(MulNode->Op);
+      if (!Mul || Mul->getOpcode() != Instruction::Mul) continue;
+      unsigned int ConstIdx = dyn_cast<ConstantInt>(Mul->getOperand(1)) ? 1 : 0;
+      const ConstantInt* Const = dyn_cast<ConstantInt>(Mul->getOperand(ConstIdx));
+      if (!Const || Const->getBitWidth() > 64 || dyn_cast<Constant>(Mul->getOperand(1 - ConstIdx))) continue;
+
+      int64_t C = Const->getSExtValue();
+      Term X;
+      X.V = Mul->getOperand(1 - ConstIdx);
+      X.Node = getReplacement(graph->getNode(getRealValue(X.V)));
+      X.Width = X.Node->getWidth();
+      TypeWidth = Mul->getType()->getIntegerBitWidth();
+      unsigned int bb = graph->getBbIdx(const_cast<BasicBlock*>(Mul->getParent()));
+
+      if (C == 0 || C == 1)
+      {
+         Replacement[MulNode] = C == 0 ? getConstant(graph, Mul->getType(), 0, bb).Node : X.Node;
+         ++ReducedMuls;
+         errs() << " - " << Mul->getName() << " = " << getMemoryString(Mul) << ": removed\n";
+         continue;
+      }
+
+      std::vector<std::pair<unsigned int, int> > Digits = getCSD(C);
+      unsigned int NumPositive = 0;
+      for(unsigned int d = 0; d < Digits.size(); d++)
+         if (Digits[d].second > 0) NumPositive++;
+
+      ///shifts by constants are wires: only the additions and subtractions are implemented
+      unsigned int NumSubs = NumPositive < Digits.size() ? 1 : 0;
+      unsigned int NumAdds = Digits.size() - 1 + (NumPositive == 0 ? 1 : 0) - NumSubs;
+      double Area = NumAdds * Library.getArea("add", MulNode->getWidth()) + NumSubs * Library.getArea("sub", MulNode->getWidth());
+      if (Digits.size() > 1 && Area >= Library.getArea("mul", MulNode->getWidth()))
+      {
+         errs() << " - " << Mul->getName() << " = " << getMemoryString(Mul) << ": kept (" << Digits.size() << " signed digits)\n";
+         continue;
+      }
+
+      std::vector<Term> Positive, Negative;
+      for(unsigned int d = 0; d < Digits.size(); d++)
+      {
+         Term T = X;
+         if (Digits[d].first > 0)
+         {
+            Term Shift = getConstant(graph, X.V->getType(), Digits[d].first, bb);
+            unsigned int Width = std::min(X.Width + Digits[d].first, TypeWidth);
+            T = createOperation(graph, Instruction::Shl, X, Shift, Width, MulNode, Digits.size() == 1 && Digits[d].second > 0);
+         }
+         if (Digits[d].second > 0)
+            Positive.push_back(T);
+         else
+            Negative.push_back(T);
+      }
+
+      Term Result;
+      if (Negative.empty())
+      {
+         Result = createSum(graph, Positive, MulNode, true);
+      }
+      else
+      {
+         Term Minuend = Positive.empty() ? getConstant(graph, Mul->getType(), 0, bb) : createSum(graph, Positive, MulNode, false);
+         Result = createOperation(graph, Instruction::Sub, Minuend, createSum(graph, Negative, MulNode, false), MulNode->getWidth(), MulNode, true);
+      }
+      Replacement[MulNode] = Result.Node;
+      ++ReducedMuls;
+      errs() << " - " << Mul->getName() << " = " << getMemoryString(Mul) << ": " << NumAdds + NumSubs << " additions/subtractions\n";
+   }
+
+   graph->replaceNodes(Replacement);
+   graph->finalize();
+   errs() << "##\n\n";
+   return false;
+}
+
+DfgStrengthReduction::Term DfgStrengthReduction::createOperation(DfgGraph* graph, unsigned int Opcode, const Term& Op0, const Term& Op1, unsigned int Width, const DfgNode* Mul, bool Root)
+{
+   const Instruction* MulInst = dyn_cast<Instruction>(Mul->Op);
+   Term T;
+   T.V = BinaryOperator::Create((Instruction::BinaryOps)Opcode, graph->getPlaceholder(Op0.V), graph->getPlaceholder(Op1.V), Root ? MulInst->getName() : MulInst->getName() + ".csd");
+   T.Width = Root ? Mul->getWidth() : Width;
+   T.Node = graph->createNode(dyn_cast<Instruction>(T.V), T.Width, graph->getBbIdx(const_cast<BasicBlock*>(MulInst->getParent())), MulInst);
+   T.Node->UseNodes.push_back(Op0.Node);
+   T.Node->UseNodes.push_back(Op1.Node);
+   T.Node->Predicate = Mul->Predicate;
+   return T;
+}
+
+DfgStrengthReduction::Term DfgStrengthReduction::createSum(DfgGraph* graph, std::vector<Term> Terms, const DfgNode* Mul, bool Root)
+{
+   ///pairwise additions, level by level: the last one computes the sum
+   for(unsigned int t = 0; t + 1 < Terms.size(); t += 2)
+   {
+      unsigned int Width = std::min(std::max(Terms[t].Width, Terms[t+1].Width) + 1, TypeWidth);
+      Terms.push_back(createOperation(graph, Instruction::Add, Terms[t], Terms[t+1], Width, Mul, Root && t + 2 == Terms.size()));
+   }
+   return Terms.back();
+}
+
+DfgStrengthReduction::Term DfgStrengthReduction::getConstant(DfgGraph* graph, Type* Ty, int64_t C, unsigned int bb)
+{
+   Term T;
+   T.V = ConstantInt::get(Ty, C, true);
+   T.Width = getConstantWidth(C);
+   T.Node = graph->getNode(T.V, T.Width, bb);
+   return T;
+}
+
+DfgNode* DfgStrengthReduction::getReplacement(DfgNode* N) const
+{
+   std::map<DfgNode*, DfgNode*>::const_iterator r = Replacement.find(N);
+   while (r != Replacement.end())
+   {
+      N = r->second;
+      r = Replacement.find(N);
+   }
+   return N;
+}
@@ -0,0 +1,94 @@
+/**
+ * The MIT License (MIT)
+ * 
+ * Copyright (c) 2013 cad-projects
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+/**
+ * Author: Christian Pilato <christian.pilato@polimi.it>
+ *
+ * Description: This class defines the DFG transformation that replaces the
+ *              multiplications by constants with networks of shifts and
+ *              additions/subtractions (canonical signed digit recoding)
+ */
+#ifndef DFGSTRENGTHREDUCTION_H
+#define DFGSTRENGTHREDUCTION_H
+
+#include "OperatorLibrary.h"
+
+#include "llvm/Pass.h"
+#include "llvm/Function.h"
+
+#include <map>
+#include <vector>
+
+namespace llvm {
+
+class DfgGraph;
+struct DfgNode;
+class Instruction;
+class Value;
+
+  // DfgStrengthReduction
+  struct DfgStrengthReduction : public FunctionPass {
+    static char ID; // Pass identification, replacement for typeid
+    DfgStrengthReduction() : FunctionPass(ID) {}
+
+    OperatorLibrary Library;
+
+    virtual bool doInitialization(Module &M);
+
+    virtual bool runOnFunction(Function &F);
+
+    void getAnalysisUsage(AnalysisUsage &AU) const;
+
+    ///value computed by a node of the shift-add network
+    struct Term
+    {
+       Value* V;
+       DfgNode* Node;
+       unsigned int Width;
+    };
+
+    /// returns the canonical signed digit representation of C as pairs (shift, digit), with digit = +1 or -1
+    static std::vector<std::pair<unsigned int, int> > getCSD(int64_t C);
+
+    private:
+
+      /// creates the node of a synthesized binary operation placed before the multiplication Mul
+      Term createOperation(DfgGraph* graph, unsigned int Opcode, const Term& Op0, const Term& Op1, unsigned int Width, const DfgNode* Mul, bool Root);
+
+      /// adds the terms with a balanced tree of additions, whose last one replaces Mul if Root is set
+      Term createSum(DfgGraph* graph, std::vector<Term> Terms, const DfgNode* Mul, bool Root);
+
+      /// returns the node of a constant of the given type
+      Term getConstant(DfgGraph* graph, Type* Ty, int64_t C, unsigned int bb);
+
+      /// returns the node replacing N, if any
+      DfgNode* getReplacement(DfgNode* N) const;
+
+      ///nodes replaced by the transformation
+      std::map<DfgNode*, DfgNode*> Replacement;
+
+      ///bitwidth of the type of the multiplication under transformation
+      unsigned int TypeWidth;
+  };
+}
+
+#endif
@@ -0,0 +1,267 @@
+/**
+ * The MIT License (MIT)
+ * 
+ * Copyright (c) 2013 cad-projects
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+/**
+ * Author: Christian Pilato <christian.pilato@polimi.it>
+ *
+ * Description: Implementation of the task graph analysis. The driver functions
+ *              are the functions that call the kernels selected with -function.
+ *              Their calls are visited in program order; each pointer argument
+ *              is traced back to its buffer (the allocation, global or local
+ *              variable holding the pointer) and the memory port analysis of the
+ *              callee tells whether the kernel reads and/or writes it. A kernel
+ *              reading a buffer consumes the data of its last writer. The volume
+ *              of each stream is the number of bytes transferred per invocation,
+ *              multiplied by the invocations when the trip counts are constant.
+ */
+#include "DfgTaskGraph.h"
+
+#include "cad/Config.h"
+
+#include "TinyXML/tinyxml.h"
+
+#define DEBUG_TYPE "dfg-task-graph"
+#include "llvm/Instructions.h"
+#include "llvm/Analysis/LoopInfo.h"
+#include "llvm/Analysis/ValueTracking.h"
+#include "llvm/Support/raw_ostream.h"
+#include "llvm/ADT/Statistic.h"
+#include "llvm/ADT/StringExtras.h"
+
+STATISTIC(TaskCounter, "[CAD] Number of kernel calls in the task graphs");
+STATISTIC(StreamCounter, "[CAD] Number of streams between kernels");
+
+using namespace llvm;
+using namespace cadlib;
+
+void DfgTaskGraph::getAnalysisUsage(AnalysisUsage &AU) const
+{
+   AU.addRequired<LoopInfo>();
+   AU.addRequired<DfgMemoryPorts>();
+   AU.setPreservesAll();
+}
+
+char DfgTaskGraph::ID = 0;
+static const char dfg_task_graph_name[] = "[CAD] DFG Task Graph Analysis";
+INITIALIZE_PASS_BEGIN(DfgTaskGraph, DEBUG_TYPE, dfg_task_graph_name, false, false)
+INITIALIZE_PASS_DEPENDENCY(LoopInfo)
+INITIALIZE_PASS_DEPENDENCY(DfgMemoryPorts)
+INITIALIZE_PASS_END(DfgTaskGraph, DEBUG_TYPE, dfg_task_graph_name, false, false)
+
+Pass* createDfgTaskGraphPass() {
+   return new DfgTaskGraph;
+}
+
+/// returns true if the function is a kernel selected with -function
+static bool isKernel(const Function* F)
+{
+   return F && std::find(functionNames.begin(), functionNames.end(), F->getName()) != functionNames.end();
+}
+
+/// returns the buffer addressed by the pointer: the allocation or, for pointers stored in memory, the variable that holds it
+static const Value* getBuffer(const Value* Ptr)
+{
+   const Value* Object = GetUnderlyingObject(Ptr);
+   if (dyn_cast<LoadInst>(Object))
+      return GetUnderlyingObject(dyn_cast<LoadInst>(Object)->getPointerOperand());
+   return Object;
+}
+
+/// returns the name of the buffer for the reports
+static std::string getBufferName(const Value* Buffer)
+{
+   if (Buffer->hasName()) return Buffer->getName().str();
+   return "<unnamed>";
+}
+
+bool DfgTaskGraph::runOnModule(Module &M)
+{
+   for(Module::iterator F = M.begin(); F != M.end(); F++)
+   {
+      if (F->isDeclaration() || isKernel(&*F)) continue;
+      bool Driver = false;
+      for(Function::iterator b = F->begin(); b != F->end() && !Driver; b++)
+         for(BasicBlock::iterator i = b->begin(); i != b->end() && !Driver; i++)
+            Driver = dyn_cast<CallInst>(i) && isKernel(dyn_cast<CallInst>(i)->getCalledFunction());
+      if (Driver) analyzeDriver(*F);
+   }
+   return false;
+}
+
+const std::map<unsigned int, DfgMemoryPorts::Usage>& DfgTaskGraph::getKernelUsage(Function* Kernel)
+{
+   if (KernelUsage.find(Kernel) != KernelUsage.end()) return KernelUsage[Kernel];
+   std::map<unsigned int, DfgMemoryPorts::Usage>& Usage = KernelUsage[Kernel];
+   DfgMemoryPorts& Ports = getAnalysis<DfgMemoryPorts>(*Kernel);
+   unsigned int a = 0;
+   for(Function::arg_iterator A = Kernel->arg_begin(); A != Kernel->arg_end(); A++, a++)
+   {
+      if (!A->getType()->isPointerTy() || !Ports.getUsage(A)) continue;
+      Usage[a] = *Ports.getUsage(A);
+   }
+   return Usage;
+}
+
+void DfgTaskGraph::analyzeDriver(Function& F)
+{
+   errs() << "DFG Task Graph: #" << F.getName() << "#\n";
+   LoopInfo& LI = getAnalysis<LoopInfo>(F);
+   std::vector<Task>& T = Tasks[&F];
+   std::vector<Stream>& S = Streams[&F];
+   T.clear();
+   S.clear();
+
+   ///last task writing each buffer and bytes written per invocation
+   std::map<const Value*, std::pair<int, uint64_t> > LastWriter;
+   ///buffers consumed after their last write
+   std::set<const Value*> Consumed;
+   for(Function::iterator b = F.begin(); b != F.end(); b++)
+   {
+      for(BasicBlock::iterator i = b->begin(); i != b->end(); i++)
+      {
+         CallInst* Call = dyn_cast<CallInst>(i);
+         if (!Call || !isKernel(Call->getCalledFunction())) continue;
+         Task Current;
+         Current.Call = Call;
+         Current.Kernel = Call->getCalledFunction();
+         Current.Invocations = 1;
+         Current.LoopDepth = LI.getLoopDepth(&*b);
+         for(const Loop* L = LI.getLoopFor(&*b); L; L = L->getParentLoop())
+            Current.Invocations *= L->getSmallConstantTripCount();
+         int Id = T.size();
+         T.push_back(Current);
+         TaskCounter++;
+         errs() << " - task " << Id << ": " << Current.Kernel->getName() << " (";
+         if (Current.Invocations) errs() << Current.Invocations;
+         else errs() << "unknown";
+         errs() << " invocations, loop depth " << Current.LoopDepth << ")\n";
+
+         const std::map<unsigned int, DfgMemoryPorts::Usage>& Usage = getKernelUsage(Call->getCalledFunction());
+         ///the buffers are read before being written by the same task
+         std::vector<std::pair<const Value*, uint64_t> > Written;
+         for(std::map<unsigned int, DfgMemoryPorts::Usage>::const_iterator u = Usage.begin(); u != Usage.end(); u++)
+         {
+            const Value* Buffer = getBuffer(Call->getArgOperand(u->first));
+            if (u->second.Stores) Written.push_back(std::make_pair(Buffer, u->second.Executions ? u->second.BytesWritten : 0));
+            if (!u->second.Loads) continue;
+            Stream Current;
+            Current.Producer = -1;
+            Current.Consumer = Id;
+            Current.Buffer = Buffer;
+            Current.BytesWritten = 0;
+            Current.BytesRead = u->second.Executions ? u->second.BytesRead : 0;
+            if (LastWriter.find(Buffer) != LastWriter.end())
+            {
+               Current.Producer = LastWriter[Buffer].first;
+               Current.BytesWritten = LastWriter[Buffer].second;
+               Consumed.insert(Buffer);
+               StreamCounter++;
+            }
+            S.push_back(Current);
+         }
+         for(unsigned int w = 0; w < Written.size(); w++)
+         {
+            LastWriter[Written[w].first] = std::make_pair(Id, Written[w].second);
+            Consumed.erase(Written[w].first);
+         }
+      }
+   }
+   ///the buffers written and not consumed by another task are the outputs of the driver
+   for(std::map<const Value*, std::pair<int, uint64_t> >::iterator w = LastWriter.begin(); w != LastWriter.end(); w++)
+   {
+      if (Consumed.find(w->first) != Consumed.end()) continue;
+      Stream Output;
+      Output.Producer = w->second.first;
+      Output.Consumer = -1;
+      Output.Buffer = w->first;
+      Output.BytesWritten = w->second.second;
+      Output.BytesRead = 0;
+      S.push_back(Output);
+   }
+
+   for(unsigned int s = 0; s < S.size(); s++)
+   {
+      errs() << " - " << (S[s].Producer < 0 ? "input" : T[S[s].Producer].Kernel->getName().str());
+      errs() << " -> " << (S[s].Consumer < 0 ? "output" : T[S[s].Consumer].Kernel->getName().str());
+      errs() << " through " << getBufferName(S[s].Buffer) << ": ";
+      if (S[s].Producer >= 0) errs() << (S[s].BytesWritten ? utostr(S[s].BytesWritten) : std::string("unknown")) << " bytes written";
+      if (S[s].Producer >= 0 && S[s].Consumer >= 0) errs() << " and ";
+      if (S[s].Consumer >= 0) errs() << (S[s].BytesRead ? utostr(S[s].BytesRead) : std::string("unknown")) << " bytes read";
+      errs() << " per invocation";
+      uint64_t Volume = S[s].Producer >= 0 ? S[s].BytesWritten * T[S[s].Producer].Invocations : S[s].BytesRead * T[S[s].Consumer].Invocations;
+      if (Volume) errs() << ", " << Volume << " bytes in total";
+      errs() << "\n";
+   }
+   errs() << "##\n\n";
+   printXml(F);
+}
+
+void DfgTaskGraph::printXml(const Function& F) const
+{
+   const std::vector<Task>& T = getTasks(&F);
+   const std::vector<Stream>& S = getStreams(&F);
+   std::string fileName = F.getName().str() + ".tasks.xml";
+   TiXmlDocument doc(fileName.c_str());
+   TiXmlElement root("FASTER_XML");
+   TiXmlElement graph("task_graph");
+   graph.SetAttribute("function", F.getName().data());
+   for(unsigned int t = 0; t < T.size(); t++)
+   {
+      TiXmlElement task("task");
+      task.SetAttribute("id", t);
+      task.SetAttribute("kernel", T[t].Kernel->getName().data());
+      task.SetAttribute("invocations", utostr(T[t].Invocations).c_str());
+      task.SetAttribute("loop_depth", T[t].LoopDepth);
+      graph.InsertEndChild(task);
+   }
+   for(unsigned int s = 0; s < S.size(); s++)
+   {
+      TiXmlElement stream("stream");
+      stream.SetAttribute("buffer", getBufferName(S[s].Buffer).c_str());
+      if (S[s].Producer >= 0)
+      {
+         stream.SetAttribute("producer", S[s].Producer);
+         if (S[s].BytesWritten) stream.SetAttribute("bytes_written", utostr(S[s].BytesWritten).c_str());
+      }
+      if (S[s].Consumer >= 0)
+      {
+         stream.SetAttribute("consumer", S[s].Consumer);
+         if (S[s].BytesRead) stream.SetAttribute("bytes_read", utostr(S[s].BytesRead).c_str());
+      }
+      graph.InsertEndChild(stream);
+   }
+   root.InsertEndChild(graph);
+   doc.InsertEndChild(root);
+   doc.SaveFile();
+}
+
+const std::vector<DfgTaskGraph::Task>& DfgTaskGraph::getTasks(const Function* Driver) const
+{
+   assert(Tasks.find(Driver) != Tasks.end() && "function not analyzed");
+   return Tasks.find(Driver)->second;
+}
+
+const std::vector<DfgTaskGraph::Stream>& DfgTaskGraph::getStreams(const Function* Driver) const
+{
+   assert(Streams.find(Driver) != Streams.end() && "function not analyzed");
+   return Streams.find(Driver)->second;
+}
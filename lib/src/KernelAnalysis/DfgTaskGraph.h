@@ -0,0 +1,101 @@
+/**
+ * The MIT License (MIT)
+ * 
+ * Copyright (c) 2013 cad-projects
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+/**
+ * Author: Christian Pilato <christian.pilato@polimi.it>
+ *
+ * Description: This class defines the analysis of the task graph of the module:
+ *              the calls to the kernels performed by the driver functions (e.g.,
+ *              main) are the tasks, linked by the buffers that they produce and
+ *              consume
+ */
+#ifndef DFGTASKGRAPH_H
+#define DFGTASKGRAPH_H
+
+#include "DfgMemoryPorts.h"
+
+#include "llvm/Pass.h"
+#include "llvm/Module.h"
+
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+
+namespace llvm {
+
+class CallInst;
+
+  // DfgTaskGraph
+  struct DfgTaskGraph : public ModulePass {
+    static char ID; // Pass identification, replacement for typeid
+    DfgTaskGraph() : ModulePass(ID) {}
+
+    ///call to a kernel in a driver function
+    struct Task
+    {
+       const CallInst* Call;
+       const Function* Kernel;
+       ///number of executions (product of the constant trip counts of the enclosing loops), 0 if unknown
+       uint64_t Invocations;
+       unsigned int LoopDepth;
+    };
+
+    ///buffer produced by a task and consumed by another one (Producer or Consumer is -1 for the inputs and outputs of the driver)
+    struct Stream
+    {
+       int Producer;
+       int Consumer;
+       const Value* Buffer;
+       ///bytes written by the producer and read by the consumer in each invocation, 0 if unknown (loops of the
+       ///kernel without a constant trip count)
+       uint64_t BytesWritten;
+       uint64_t BytesRead;
+    };
+
+    virtual bool runOnModule(Module &M);
+
+    void getAnalysisUsage(AnalysisUsage &AU) const;
+
+    /// returns the tasks of the driver function
+    const std::vector<Task>& getTasks(const Function* Driver) const;
+
+    /// returns the streams between the tasks of the driver function
+    const std::vector<Stream>& getStreams(const Function* Driver) const;
+
+    private:
+
+      void analyzeDriver(Function& F);
+
+      /// returns the usage of the memory parameters of the kernel, computed once per kernel
+      const std::map<unsigned int, DfgMemoryPorts::Usage>& getKernelUsage(Function* Kernel);
+
+      void printXml(const Function& F) const;
+
+      std::map<const Function*, std::map<unsigned int, DfgMemoryPorts::Usage> > KernelUsage;
+
+      std::map<const Function*, std::vector<Task> > Tasks;
+      std::map<const Function*, std::vector<Stream> > Streams;
+  };
+}
+
+#endif
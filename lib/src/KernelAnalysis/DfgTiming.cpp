@@ -0,0 +1,227 @@
+/**
+ * The MIT License (MIT)
+ * 
+ * Copyright (c) 2013 cad-projects
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+/**
+ * Author: Christian Pilato <christian.pilato@polimi.it>
+ *
+ * Description: Implementation of the timing analysis of the DFG. The delay of
+ *              each operation depends on its opcode and on the bitwidth computed
+ *              by DetermineBitWidth. Operations of the same basic block are
+ *              chained into the same clock cycle as long as the accumulated
+ *              delay fits the target clock period; slower operations span
+ *              multiple cycles. The results are written in <function>.timing
+ */
+#include "DfgTiming.h"
+
+#include "cad/Config.h"
+
+#include "Dfg.h"
+#include "DfgGeneration.h"
+
+#define DEBUG_TYPE "dfg-timing"
+#include "llvm/Instructions.h"
+#include "llvm/Support/Format.h"
+#include "llvm/Support/raw_ostream.h"
+
+#include <cmath>
+#include <fstream>
+#include <iomanip>
+
+using namespace llvm;
+using namespace cadlib;
+
+static cl::opt<double> clockPeriod("clock-period",
+  cl::desc("[CAD] Target clock period (in ns) for the chaining of the DFG operations"),
+  cl::init(10.0));
+
+void DfgTiming::getAnalysisUsage(AnalysisUsage &AU) const
+{
+   AU.addRequired<DfgGeneration>();
+   AU.setPreservesAll();
+}
+
+char DfgTiming::ID = 0;
+static const char dfg_timing_name[] = "[CAD] DFG Timing Analysis";
+INITIALIZE_PASS_BEGIN(DfgTiming, DEBUG_TYPE, dfg_timing_name, false, false)
+INITIALIZE_PASS_DEPENDENCY(DfgGeneration)
+INITIALIZE_PASS_END(DfgTiming, DEBUG_TYPE, dfg_timing_name, false, false)
+
+Pass* createDfgTimingPass() {
+   return new DfgTiming;
+}
+
+bool DfgTiming::doInitialization(Module &M)
+{
+   if (configFile.size())
+      Library.parseConfig(configFile);
+   return false;
+}
+
+bool DfgTiming::runOnFunction(Function &F)
+{
+   if (std::find(functionNames.begin(), functionNames.end(), F.getName()) == functionNames.end())
+      return false;
+
+   errs() << "DFG Timing: #" << F.getName() << "#\n";
+   DfgGeneration& DG = getAnalysis<DfgGeneration>();
+   DfgGraph* graph = DG.graph;
+   if (!graph) return false;
+
+   unsigned int NumNodes = graph->getNodes().size();
+   Delay.assign(NumNodes, 0);
+   StartCycle.assign(NumNodes, 0);
+   Analyzed.assign(NumNodes, false);
+   CriticalPath = 0;
+   Slowest = NULL;
+
+   std::ostringstream report;
+   report << std::fixed << std::setprecision(2);
+   report << "Timing report for function " << graph->getFunctionName() << "\n";
+   report << "Target clock period: " << clockPeriod << " ns (" << 1000.0 / clockPeriod << " MHz)\n\n";
+
+   const std::map<unsigned int, std::vector<const Value*> >& bbNodes = graph->getBbNodes();
+   for(std::map<unsigned int, std::vector<const Value*> >::const_iterator bb = bbNodes.begin(); bb != bbNodes.end(); bb++)
+   {
+      if (bb->first == 0) continue;
+      analyzeBasicBlock(graph, bb->first, report);
+   }
+
+   report << "Combinational critical path: " << CriticalPath << " ns";
+   if (CriticalPath > 0) report << " (" << 1000.0 / CriticalPath << " MHz without registers)";
+   report << "\n";
+   if (Slowest)
+   {
+      double MinPeriod = Delay[Slowest->Id];
+      report << "Slowest operation: " << Slowest->getName() << " (" << Slowest->getWidth() << " bits), " << MinPeriod << " ns";
+      if (MinPeriod > 0) report << " -> maximum frequency without multi-cycle operations: " << 1000.0 / MinPeriod << " MHz";
+      report << "\n";
+   }
+
+   std::ofstream file((graph->getFunctionName() + ".timing").c_str());
+   file << report.str();
+   file.close();
+
+   errs() << " - critical path = " << format("%.2f", CriticalPath) << " ns\n";
+   errs() << "##\n\n";
+   return false;
+}
+
+void DfgTiming::analyzeBasicBlock(DfgGraph* graph, unsigned int bb, std::ostringstream& report)
+{
+   ///operations of the basic block, in topological order
+   std::set<const DfgNode*> InBb;
+   const std::vector<const Value*>& Values = graph->getBbNode(bb);
+   for(unsigned int i = 0; i < Values.size(); i++)
+   {
+      if (!dyn_cast<Instruction>(Values[i]) || !graph->isNode(Values[i])) continue;
+      InBb.insert(graph->getNode(Values[i]));
+   }
+   std::vector<const DfgNode*> Ops;
+   const std::vector<DfgNode*>& Order = graph->getTopologicalOrder();
+   for(unsigned int o = 0; o < Order.size(); o++)
+      if (InBb.count(Order[o])) Ops.push_back(Order[o]);
+   if (Ops.empty()) return;
+
+   ///Path: longest combinational path ending at the node; Finish: cycle and time when the result is available
+   std::map<const DfgNode*, double> Path;
+   std::map<const DfgNode*, const DfgNode*> Prev;
+   std::map<const DfgNode*, std::pair<unsigned int, double> > Finish;
+   const DfgNode* PathEnd = NULL;
+   unsigned int Cycles = 0;
+   for(unsigned int o = 0; o < Ops.size(); o++)
+   {
+      const DfgNode* n = Ops[o];
+      double d = Library.getDelay(OperatorLibrary::getOpcode(n->Op), n->getWidth());
+      Delay[n->Id] = d;
+      Analyzed[n->Id] = true;
+      if (!Slowest || d > Delay[Slowest->Id]) Slowest = n;
+
+      double Longest = 0;
+      std::pair<unsigned int, double> Ready(0, 0.0);
+      for(DfgGraph::node_iterator p = graph->pred_begin(n); p != graph->pred_end(n); p++)
+      {
+         if (!InBb.count(*p)) continue;
+         if (Path[*p] > Longest)
+         {
+            Longest = Path[*p];
+            Prev[n] = *p;
+         }
+         Ready = std::max(Ready, Finish[*p]);
+      }
+      Path[n] = Longest + d;
+      if (!PathEnd || Path[n] > Path[PathEnd]) PathEnd = n;
+
+      ///chaining: the operation starts in the cycle where its operands are ready, if it fits
+      unsigned int Start = Ready.first;
+      if (d > clockPeriod)
+      {
+         if (Ready.second > 0) Start++;
+         Finish[n] = std::make_pair(Start + (unsigned int)std::ceil(d / clockPeriod), 0.0);
+      }
+      else if (Ready.second + d <= clockPeriod)
+      {
+         Finish[n] = std::make_pair(Start, Ready.second + d);
+      }
+      else
+      {
+         Start++;
+         Finish[n] = std::make_pair(Start, d);
+      }
+      StartCycle[n->Id] = Start;
+      Cycles = std::max(Cycles, Finish[n].first + (Finish[n].second > 0 ? 1 : 0));
+   }
+   CriticalPath = std::max(CriticalPath, Path[PathEnd]);
+
+   report << "Basic block " << bb << ": " << Ops.size() << " operations\n";
+   report << "  combinational critical path: " << Path[PathEnd] << " ns\n";
+   report << "  cycles at the target clock period: " << Cycles << " (" << Cycles * clockPeriod << " ns)\n";
+   report << "  critical path:\n";
+   std::vector<const DfgNode*> CriticalOps;
+   for(const DfgNode* n = PathEnd; n; n = Prev.count(n) ? Prev[n] : NULL)
+      CriticalOps.push_back(n);
+   for(std::vector<const DfgNode*>::reverse_iterator c = CriticalOps.rbegin(); c != CriticalOps.rend(); c++)
+      report << "    " << std::setw(8) << Delay[(*c)->Id] << " ns  " << (*c)->getName() << " (" << (*c)->getWidth() << " bits)\n";
+   report << "  chained operations:\n";
+   for(unsigned int o = 0; o < Ops.size(); o++)
+   {
+      const DfgNode* n = Ops[o];
+      report << "    cycle " << std::setw(3) << StartCycle[n->Id] << "  " << std::setw(8) << Delay[n->Id] << " ns  " << n->getName() << "\n";
+   }
+   report << "\n";
+}
+
+bool DfgTiming::isAnalyzed(const DfgNode* N) const
+{
+   return N->Id < Analyzed.size() && Analyzed[N->Id];
+}
+
+double DfgTiming::getDelay(const DfgNode* N) const
+{
+   assert(isAnalyzed(N) && "operation not analyzed");
+   return Delay[N->Id];
+}
+
+unsigned int DfgTiming::getChainedCycle(const DfgNode* N) const
+{
+   assert(isAnalyzed(N) && "operation not analyzed");
+   return StartCycle[N->Id];
+}
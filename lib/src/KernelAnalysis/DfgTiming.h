@@ -0,0 +1,89 @@
+/**
+ * The MIT License (MIT)
+ * 
+ * Copyright (c) 2013 cad-projects
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+/**
+ * Author: Christian Pilato <christian.pilato@polimi.it>
+ *
+ * Description: This class defines the pass for the timing analysis of the DFG
+ *              (combinational critical path and chaining of the operations into
+ *              clock cycles, based on bitwidth-aware delays)
+ */
+#ifndef DFGTIMING_H
+#define DFGTIMING_H
+
+#include "OperatorLibrary.h"
+
+#include "llvm/Pass.h"
+#include "llvm/Function.h"
+
+#include <sstream>
+#include <vector>
+
+namespace llvm {
+
+class DfgGraph;
+struct DfgNode;
+
+  // DfgTiming
+  struct DfgTiming : public FunctionPass {
+    static char ID; // Pass identification, replacement for typeid
+    DfgTiming() : FunctionPass(ID), CriticalPath(0), Slowest(NULL) {}
+
+    OperatorLibrary Library;
+
+    virtual bool doInitialization(Module &M);
+
+    virtual bool runOnFunction(Function &F);
+
+    void getAnalysisUsage(AnalysisUsage &AU) const;
+
+    bool isAnalyzed(const DfgNode* N) const;
+
+    /// returns the combinational delay of the operation (in ns)
+    double getDelay(const DfgNode* N) const;
+
+    /// returns the cycle (relative to the start of the basic block) where the chained operation starts
+    unsigned int getChainedCycle(const DfgNode* N) const;
+
+    /// returns the combinational critical path of the function (in ns)
+    double getCriticalPath() const
+    {
+       return CriticalPath;
+    }
+
+    private:
+
+      void analyzeBasicBlock(DfgGraph* graph, unsigned int bb, std::ostringstream& report);
+
+      ///values indexed by node id
+      std::vector<double> Delay;
+      std::vector<unsigned int> StartCycle;
+      std::vector<bool> Analyzed;
+
+      double CriticalPath;
+
+      ///slowest operation of the function (it bounds the clock period)
+      const DfgNode* Slowest;
+  };
+}
+
+#endif
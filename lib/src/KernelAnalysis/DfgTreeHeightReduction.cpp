@@ -0,0 +1,209 @@
+/**
+ * The MIT License (MIT)
+ * 
+ * Copyright (c) 2013 cad-projects
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+/**
+ * Author: Christian Pilato <christian.pilato@polimi.it>
+ *
+ * Description: Implementation of the tree-height reduction of the DFG. The
+ *              operands of each chain of add (or mul) operations of the same
+ *              basic block are recombined by pairing, each time, the two
+ *              operands that are available first, so that a chain of n
+ *              operands computes in about log2(n) levels. The operations of
+ *              the new tree are synthesized instructions owned by the DFG.
+ */
+#include "DfgTreeHeightReduction.h"
+
+#include "cad/Config.h"
+
+#include "Dfg.h"
+#include "DfgGeneration.h"
+
+#define DEBUG_TYPE "dfg-tree-height-reduction"
+#include "llvm/Instructions.h"
+#include "llvm/Support/raw_ostream.h"
+#include "llvm/ADT/Statistic.h"
+
+#include <functional>
+#include <queue>
+
+STATISTIC(ReducedChains, "[CAD] Number of rebalanced chains of associative operations");
+
+using namespace llvm;
+using namespace cadlib;
+
+void DfgTreeHeightReduction::getAnalysisUsage(AnalysisUsage &AU) const
+{
+   AU.addRequired<DfgGeneration>();
+   AU.setPreservesAll();
+}
+
+char DfgTreeHeightReduction::ID = 0;
+static const char dfg_tree_height_reduction_name[] = "[CAD] DFG Tree-Height Reduction";
+INITIALIZE_PASS_BEGIN(DfgTreeHeightReduction, DEBUG_TYPE, dfg_tree_height_reduction_name, false, false)
+INITIALIZE_PASS_DEPENDENCY(DfgGeneration)
+INITIALIZE_PASS_END(DfgTreeHeightReduction, DEBUG_TYPE, dfg_tree_height_reduction_name, false, false)
+
+Pass* createDfgTreeHeightReductionPass() {
+   return new DfgTreeHeightReduction;
+}
+
+///operand of the tree under construction: operands are paired by (level, width)
+typedef std::pair<std::pair<unsigned int, unsigned int>, unsigned int> Operand_t;
+
+bool DfgTreeHeightReduction::runOnFunction(Function &F)
+{
+   if (std::find(functionNames.begin(), functionNames.end(), F.getName()) == functionNames.end())
+      return false;
+
+   errs() << "DFG Tree-Height Reduction: #" << F.getName() << "#\n";
+   DfgGeneration& DG = getAnalysis<DfgGeneration>();
+   DfgGraph* graph = DG.graph;
+   if (!graph) return false;
+
+   unsigned int DepthBefore = graph->getNumLevels();
+   Height.clear();
+   Block.clear();
+   const std::map<unsigned int, std::vector<const Value*> >& bbNodes = graph->getBbNodes();
+   for(std::map<unsigned int, std::vector<const Value*> >::const_iterator b = bbNodes.begin(); b != bbNodes.end(); b++)
+      for(unsigned int v = 0; v < b->second.size(); v++)
+         Block[graph->getNode(b->second[v])] = b->first;
+   std::map<DfgNode*, DfgNode*> Replacement;
+   unsigned int Chains = 0;
+
+   ///the chains are visited in topological order, so the operands of a chain are already rebalanced
+   std::vector<DfgNode*> Order = graph->getTopologicalOrder();
+   for(unsigned int o = 0; o < Order.size(); o++)
+   {
+      DfgNode* RootNode = Order[o];
+      Instruction* Root = const_cast<Instruction*>(dyn_cast<Instruction>(RootNode->Op));
+      if (!Root || (Root->getOpcode() != Instruction::Add && Root->getOpcode() != Instruction::Mul)) continue;
+      if (graph->getFanOut(RootNode) == 1 && isChained(graph, Root, dyn_cast<Instruction>((*graph->succ_begin(RootNode))->Op))) continue;
+
+      std::vector<Value*> Leaves;
+      std::vector<DfgNode*> Inner;
+      unsigned int OldHeight = collectChain(graph, Root, Leaves, Inner);
+      if (Leaves.size() < 3) continue;
+
+      std::priority_queue<Operand_t, std::vector<Operand_t>, std::greater<Operand_t> > Ready;
+      std::vector<Value*> Values(Leaves);
+      std::vector<DfgNode*> ValueNodes;
+      for(unsigned int l = 0; l < Leaves.size(); l++)
+      {
+         DfgNode* Leaf = graph->getNode(getRealValue(Leaves[l]));
+         ValueNodes.push_back(Leaf);
+         Ready.push(Operand_t(std::make_pair(getHeight(Leaf), Leaf->getWidth()), l));
+      }
+
+      ///the height of the balanced tree only depends on the levels of the operands
+      std::priority_queue<unsigned int, std::vector<unsigned int>, std::greater<unsigned int> > Levels;
+      for(unsigned int l = 0; l < ValueNodes.size(); l++)
+         Levels.push(getHeight(ValueNodes[l]));
+      while (Levels.size() > 1)
+      {
+         unsigned int First = Levels.top();
+         Levels.pop();
+         unsigned int Second = Levels.top();
+         Levels.pop();
+         Levels.push(std::max(First, Second) + 1);
+      }
+      unsigned int NewHeight = Levels.top();
+      if (NewHeight >= OldHeight) continue;
+
+      unsigned int bb = Block[RootNode];
+      DfgNode* NewRoot = 0;
+      while (Ready.size() > 1)
+      {
+         Operand_t First = Ready.top();
+         Ready.pop();
+         Operand_t Second = Ready.top();
+         Ready.pop();
+         bool Last = Ready.empty();
+         ///inner operations follow the bitwidth rule of DetermineBitWidth, the root keeps its bitwidth
+         unsigned int Width = Last ? RootNode->getWidth() : std::max(First.first.second, Second.first.second);
+         Instruction* I = BinaryOperator::Create((Instruction::BinaryOps)Root->getOpcode(), graph->getPlaceholder(Values[First.second]), graph->getPlaceholder(Values[Second.second]), Last ? Root->getName() : Root->getName() + ".thr");
+         DfgNode* N = graph->createNode(I, Width, bb, Root);
+         N->UseNodes.push_back(ValueNodes[First.second]);
+         N->UseNodes.push_back(ValueNodes[Second.second]);
+         N->Predicate = RootNode->Predicate;
+         unsigned int Level = std::max(First.first.first, Second.first.first) + 1;
+         Height[N] = Level;
+         Ready.push(Operand_t(std::make_pair(Level, Width), Values.size()));
+         Values.push_back(I);
+         ValueNodes.push_back(N);
+         NewRoot = N;
+      }
+
+      Height[RootNode] = Height[NewRoot];
+      Replacement[RootNode] = NewRoot;
+      for(unsigned int i = 0; i < Inner.size(); i++)
+         Replacement[Inner[i]] = NULL;
+      ++ReducedChains;
+      Chains++;
+      errs() << " - " << Root->getOpcodeName() << " chain " << Root->getName() << ": " << Leaves.size() << " operands, height " << OldHeight << " -> " << NewHeight << "\n";
+   }
+
+   graph->replaceNodes(Replacement);
+   graph->finalize();
+   errs() << " - " << Chains << " chains rebalanced, DFG depth " << DepthBefore << " -> " << graph->getNumLevels() << " levels\n";
+   errs() << "##\n\n";
+   return false;
+}
+
+bool DfgTreeHeightReduction::isChained(DfgGraph* graph, const Value* Op, const Instruction* User) const
+{
+   const Instruction* I = dyn_cast<Instruction>(Op);
+   if (!I || !User || I->getOpcode() != User->getOpcode() || !graph->isNode(I) || !graph->isNode(User)) return false;
+   ///inner operations must not be used elsewhere, nor cross basic blocks or casts: a node can stand for several
+   ///instructions of the function, so the uses are the successors of the node in the DFG
+   const DfgNode* N = graph->getNode(I);
+   const DfgNode* UserNode = graph->getNode(User);
+   if (N == UserNode || graph->getFanOut(N) != 1 || *graph->succ_begin(N) != UserNode) return false;
+   std::map<const DfgNode*, unsigned int>::const_iterator NodeBb = Block.find(N), UserBb = Block.find(UserNode);
+   return NodeBb != Block.end() && UserBb != Block.end() && NodeBb->second == UserBb->second;
+}
+
+unsigned int DfgTreeHeightReduction::collectChain(DfgGraph* graph, Instruction* I, std::vector<Value*>& Leaves, std::vector<DfgNode*>& Inner)
+{
+   unsigned int ChainHeight = 0;
+   for(unsigned int o = 0; o < 2; o++)
+   {
+      Value* Op = I->getOperand(o);
+      if (isChained(graph, Op, I))
+      {
+         Inner.push_back(graph->getNode(Op));
+         ChainHeight = std::max(ChainHeight, collectChain(graph, dyn_cast<Instruction>(Op), Leaves, Inner));
+      }
+      else
+      {
+         Leaves.push_back(Op);
+         ChainHeight = std::max(ChainHeight, getHeight(graph->getNode(getRealValue(Op))));
+      }
+   }
+   return ChainHeight + 1;
+}
+
+unsigned int DfgTreeHeightReduction::getHeight(const DfgNode* N) const
+{
+   std::map<const DfgNode*, unsigned int>::const_iterator h = Height.find(N);
+   if (h != Height.end()) return h->second;
+   return N->Level;
+}
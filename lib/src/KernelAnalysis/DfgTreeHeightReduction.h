@@ -0,0 +1,74 @@
+/**
+ * The MIT License (MIT)
+ * 
+ * Copyright (c) 2013 cad-projects
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+/**
+ * Author: Christian Pilato <christian.pilato@polimi.it>
+ *
+ * Description: This class defines the DFG transformation that rebalances the
+ *              chains of associative and commutative operations (add, mul)
+ *              into trees of logarithmic height
+ */
+#ifndef DFGTREEHEIGHTREDUCTION_H
+#define DFGTREEHEIGHTREDUCTION_H
+
+#include "llvm/Pass.h"
+#include "llvm/Function.h"
+
+#include <map>
+#include <vector>
+
+namespace llvm {
+
+class DfgGraph;
+struct DfgNode;
+class Instruction;
+class Value;
+
+  // DfgTreeHeightReduction
+  struct DfgTreeHeightReduction : public FunctionPass {
+    static char ID; // Pass identification, replacement for typeid
+    DfgTreeHeightReduction() : FunctionPass(ID) {}
+
+    virtual bool runOnFunction(Function &F);
+
+    void getAnalysisUsage(AnalysisUsage &AU) const;
+
+    private:
+
+      /// returns true if the operand Op of User is an inner operation of the same chain
+      bool isChained(DfgGraph* graph, const Value* Op, const Instruction* User) const;
+
+      /// collects the operands of the chain rooted in I and returns the height of the chain
+      unsigned int collectChain(DfgGraph* graph, Instruction* I, std::vector<Value*>& Leaves, std::vector<DfgNode*>& Inner);
+
+      /// returns the level of the node, taking into account the chains already rebalanced
+      unsigned int getHeight(const DfgNode* N) const;
+
+      ///levels of the rebalanced nodes
+      std::map<const DfgNode*, unsigned int> Height;
+
+      ///basic block of each node, as recorded by the graph (the synthesized instructions have no parent)
+      std::map<const DfgNode*, unsigned int> Block;
+  };
+}
+
+#endif
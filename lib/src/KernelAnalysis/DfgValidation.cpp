@@ -0,0 +1,380 @@
+/**
+ * The MIT License (MIT)
+ * 
+ * Copyright (c) 2013 cad-projects
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+/**
+ * Author: Christian Pilato <christian.pilato@polimi.it>
+ *
+ * Description: Implementation of the functional validation of the DFGs. The
+ *              kernels selected with -function are executed in the given order
+ *              by the DFG interpreter, as done by the driver of the edge
+ *              detection example: each kernel is invoked for every pixel but the
+ *              border, with the output of the previous kernel (the RGB image for
+ *              the first one) as first pointer parameter and a new buffer as
+ *              second one. The scalar parameters dimh, dimv, h and v are the
+ *              dimensions of the image and the coordinates of the pixel; the
+ *              others are specified with -validate-arg=<name>=<value>. The rows
+ *              are split into tiles of consecutive pixels, evaluated as the lanes
+ *              of a DfgBatchInterpreter by a pool of threads.
+ */
+#include "DfgValidation.h"
+
+#include "cad/Config.h"
+
+#include "Dfg.h"
+#include "DfgGeneration.h"
+#include "DfgBatchInterpreter.h"
+#include "DfgInterpreter.h"
+#include "DfgMemoryCoalescing.h"
+
+#define DEBUG_TYPE "dfg-validation"
+#include "llvm/Support/CommandLine.h"
+#include "llvm/Support/raw_ostream.h"
+#include "llvm/ADT/Statistic.h"
+#include "llvm/ADT/StringExtras.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <fstream>
+#include <map>
+
+#include <pthread.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+STATISTIC(MismatchCounter, "[CAD] Number of pixels that differ from the reference image");
+
+using namespace llvm;
+using namespace cadlib;
+
+static cl::opt<std::string> validateImage("validate-image",
+  cl::desc("[CAD] Input image (PPM) of the validation of the kernels"),
+  cl::value_desc("file"));
+
+static cl::opt<std::string> validateReference("validate-reference",
+  cl::desc("[CAD] Output image (PPM) of the native execution of the kernels"),
+  cl::value_desc("file"));
+
+static cl::opt<std::string> validateOutput("validate-output",
+  cl::desc("[CAD] Output image (PPM) of the interpreted kernels"),
+  cl::value_desc("file"), cl::init("validation.ppm"));
+
+static cl::opt<unsigned int> validateLanes("validate-lanes",
+  cl::desc("[CAD] Number of invocations of the kernels evaluated together by the validation"),
+  cl::init(256));
+
+static cl::opt<unsigned int> validateThreads("validate-threads",
+  cl::desc("[CAD] Number of threads of the validation (0 = number of processors)"),
+  cl::init(0));
+
+static cl::opt<bool> validateScalar("validate-scalar",
+  cl::desc("[CAD] Interpret the kernels one invocation and one node at a time"),
+  cl::init(false));
+
+static cl::opt<bool> validateCoalescing("validate-coalescing",
+  cl::desc("[CAD] Coalesce the memory accesses of the DFGs (dfg-memory-coalescing) before their validation"),
+  cl::init(false));
+
+static cl::list<std::string> validateArgs("validate-arg",
+  cl::desc("[CAD] Value of a scalar parameter of the kernels"),
+  cl::value_desc("name=value"));
+
+void DfgValidation::getAnalysisUsage(AnalysisUsage &AU) const
+{
+   AU.addRequired<DfgGeneration>();
+   ///the DFG of each kernel is generated and transformed by the same on-the-fly pass manager
+   if (validateCoalescing) AU.addRequired<DfgMemoryCoalescing>();
+   AU.setPreservesAll();
+}
+
+char DfgValidation::ID = 0;
+static const char dfg_validation_name[] = "[CAD] DFG Validation";
+INITIALIZE_PASS_BEGIN(DfgValidation, DEBUG_TYPE, dfg_validation_name, false, false)
+INITIALIZE_PASS_DEPENDENCY(DfgGeneration)
+INITIALIZE_PASS_DEPENDENCY(DfgMemoryCoalescing)
+INITIALIZE_PASS_END(DfgValidation, DEBUG_TYPE, dfg_validation_name, false, false)
+
+Pass* createDfgValidationPass() {
+   return new DfgValidation;
+}
+
+bool DfgValidation::readImage(const std::string& FileName, Image& I)
+{
+   std::ifstream myfile(FileName.c_str());
+   std::string Type;
+   unsigned int MaxValue = 0;
+   if (!(myfile >> Type >> I.Width >> I.Height >> MaxValue) || Type != "P3") return false;
+   I.Data.resize(I.Width * I.Height * 3);
+   for(unsigned int i = 0; i < I.Data.size(); i++)
+   {
+      int V = 0;
+      if (!(myfile >> V)) return false;
+      I.Data[i] = (unsigned char)V;
+   }
+   return true;
+}
+
+void DfgValidation::writeImage(const std::string& FileName, const Image& I)
+{
+   std::ofstream myfile(FileName.c_str());
+   myfile << "P3\n" << I.Width << " " << I.Height << "\n255\n";
+   for(unsigned int i = 0; i < I.Data.size(); i++)
+      myfile << (int)I.Data[i] << "\n";
+}
+
+/// binds the parameters of the kernel: the first two pointers to the input and output buffers, the scalars
+/// by name; returns the parameters h and v (NULL if not available), that are set for each invocation
+template<class Interpreter_t>
+static void bindParameters(Interpreter_t& Interpreter, Function& Kernel, unsigned char* Input, unsigned char* Output, uint64_t Size,
+                           std::map<std::string, int64_t>& Scalars, const Argument*& H, const Argument*& V, bool Report)
+{
+   H = NULL;
+   V = NULL;
+   unsigned int Pointers = 0;
+   for(Function::arg_iterator A = Kernel.arg_begin(); A != Kernel.arg_end(); A++)
+   {
+      if (A->getType()->isPointerTy())
+      {
+         if (Pointers++ < 2) Interpreter.bindMemory(&*A, Pointers == 1 ? Input : Output, Size);
+         else if (Report) errs() << "WARNING: pointer parameter " << A->getName() << " not bound\n";
+      }
+      else if (A->getName() == "h")
+         H = &*A;
+      else if (A->getName() == "v")
+         V = &*A;
+      else if (Scalars.find(A->getName().str()) != Scalars.end())
+         Interpreter.setScalar(&*A, Scalars[A->getName().str()]);
+      else if (Report)
+         errs() << "WARNING: value of the parameter " << A->getName() << " not specified (-validate-arg)\n";
+   }
+}
+
+/// returns the current time in seconds
+static double getTime()
+{
+   struct timeval T;
+   gettimeofday(&T, NULL);
+   return T.tv_sec + T.tv_usec * 1e-6;
+}
+
+namespace {
+   ///consecutive pixels of a row, evaluated as the lanes of a batch
+   struct Tile
+   {
+      unsigned int V;
+      unsigned int FirstH;
+      unsigned int Lanes;
+   };
+
+   ///state of a thread of the pool: the tiles are shared, each thread has its own interpreter
+   struct Worker
+   {
+      DfgBatchInterpreter* Interpreter;
+      const Argument* H;
+      const Argument* V;
+      const std::vector<Tile>* Tiles;
+      unsigned int* Next;
+      pthread_mutex_t* Lock;
+   };
+}
+
+/// evaluates the tiles not yet taken by the other threads
+static void* runTiles(void* Arg)
+{
+   Worker* W = static_cast<Worker*>(Arg);
+   std::vector<int64_t> Lanes;
+   while (true)
+   {
+      pthread_mutex_lock(W->Lock);
+      unsigned int t = (*W->Next)++;
+      pthread_mutex_unlock(W->Lock);
+      if (t >= W->Tiles->size()) break;
+      const Tile& T = (*W->Tiles)[t];
+      Lanes.resize(T.Lanes);
+      for(unsigned int l = 0; l < T.Lanes; l++)
+         Lanes[l] = T.FirstH + l;
+      if (W->H) W->Interpreter->setLanes(W->H, &Lanes[0], T.Lanes);
+      if (W->V) W->Interpreter->setScalar(W->V, T.V);
+      W->Interpreter->run(T.Lanes);
+   }
+   return NULL;
+}
+
+unsigned int DfgValidation::runKernel(Function& Kernel, unsigned char* Input, unsigned char* Output, uint64_t Size, unsigned int Width, unsigned int Height)
+{
+   DfgGraph* graph = getAnalysis<DfgGeneration>(Kernel).graph;
+   if (!graph) return 1;
+
+   std::map<std::string, int64_t> Scalars;
+   for(unsigned int a = 0; a < validateArgs.size(); a++)
+   {
+      std::string::size_type Eq = validateArgs[a].find('=');
+      if (Eq == std::string::npos) continue;
+      Scalars[validateArgs[a].substr(0, Eq)] = atoll(validateArgs[a].substr(Eq + 1).c_str());
+   }
+   ///the same convention of the driver: the image is loaded with dimv = width and dimh = height
+   Scalars["dimv"] = Width;
+   Scalars["dimh"] = Height;
+
+   const Argument* H = NULL;
+   const Argument* V = NULL;
+   double Start = getTime();
+   uint64_t Invocations = 0, Evaluated = 0;
+   unsigned int Errors = 0, Threads = 1;
+   bool Batched = false;
+   if (validateScalar)
+   {
+      DfgInterpreter Interpreter(graph);
+      bindParameters(Interpreter, Kernel, Input, Output, Size, Scalars, H, V, true);
+      for(unsigned int v = 1; v + 1 < Width; v++)
+      {
+         for(unsigned int h = 1; h + 1 < Height; h++, Invocations++)
+         {
+            if (H) Interpreter.setScalar(H, h);
+            if (V) Interpreter.setScalar(V, v);
+            Interpreter.run();
+         }
+      }
+      Evaluated = Interpreter.getNumEvaluated();
+      Errors = Interpreter.getNumErrors();
+   }
+   else
+   {
+      ///each row (but the border) is split into tiles of at most Lanes pixels
+      unsigned int Lanes = std::max(1U, (unsigned int)validateLanes);
+      std::vector<Tile> Tiles;
+      for(unsigned int v = 1; v + 1 < Width; v++)
+      {
+         for(unsigned int h = 1; h + 1 < Height; h += Lanes)
+         {
+            Tile T;
+            T.V = v;
+            T.FirstH = h;
+            T.Lanes = std::min(Lanes, Height - 1 - h);
+            Tiles.push_back(T);
+            Invocations += T.Lanes;
+         }
+      }
+      Threads = validateThreads ? validateThreads : std::max(1L, sysconf(_SC_NPROCESSORS_ONLN));
+      Threads = std::max(1U, std::min(Threads, (unsigned int)Tiles.size()));
+
+      ///the interpreters are created before starting the threads, that share only the (read-only) DFG and the buffers
+      unsigned int Next = 0;
+      pthread_mutex_t Lock;
+      pthread_mutex_init(&Lock, NULL);
+      std::vector<Worker> Workers(Threads);
+      for(unsigned int t = 0; t < Threads; t++)
+      {
+         Workers[t].Interpreter = new DfgBatchInterpreter(graph, Lanes);
+         bindParameters(*Workers[t].Interpreter, Kernel, Input, Output, Size, Scalars, Workers[t].H, Workers[t].V, t == 0);
+         Workers[t].Tiles = &Tiles;
+         Workers[t].Next = &Next;
+         Workers[t].Lock = &Lock;
+      }
+      Batched = Workers[0].Interpreter->isBatched();
+      std::vector<pthread_t> Pool(Threads);
+      for(unsigned int t = 1; t < Threads; t++)
+         pthread_create(&Pool[t], NULL, runTiles, &Workers[t]);
+      runTiles(&Workers[0]);
+      for(unsigned int t = 1; t < Threads; t++)
+         pthread_join(Pool[t], NULL);
+      pthread_mutex_destroy(&Lock);
+      for(unsigned int t = 0; t < Threads; t++)
+      {
+         Evaluated += Workers[t].Interpreter->getNumEvaluated();
+         Errors += Workers[t].Interpreter->getNumErrors();
+         delete Workers[t].Interpreter;
+      }
+   }
+   double Seconds = getTime() - Start;
+   errs() << " - " << Kernel.getName() << ": " << Invocations << " invocations, " << Evaluated << " nodes evaluated in " << Seconds << " s";
+   if (!validateScalar) errs() << " (" << (Batched ? "batches of " + utostr(std::max(1U, (unsigned int)validateLanes)) + " lanes" : "one lane at a time") << ", " << Threads << " threads)";
+   if (Errors) errs() << ", " << Errors << " errors";
+   errs() << "\n";
+   return Errors;
+}
+
+bool DfgValidation::runOnModule(Module &M)
+{
+   if (validateImage.empty()) return false;
+   errs() << "DFG Validation: #" << validateImage << "#\n";
+   Image Input;
+   if (!readImage(validateImage, Input))
+   {
+      errs() << "ERROR: unable to read the image " << validateImage << "\n##\n\n";
+      return false;
+   }
+
+   ///buffers of the stages (the output of a stage is the input of the next one)
+   uint64_t Size = Input.Data.size();
+   std::vector<unsigned char> Current(Input.Data);
+   unsigned int Errors = 0;
+   for(unsigned int f = 0; f < functionNames.size(); f++)
+   {
+      Function* Kernel = M.getFunction(functionNames[f]);
+      if (!Kernel || Kernel->isDeclaration())
+      {
+         errs() << "WARNING: kernel " << functionNames[f] << " not available\n";
+         continue;
+      }
+      std::vector<unsigned char> Next(Size, 0);
+      Errors += runKernel(*Kernel, &Current[0], &Next[0], Size, Input.Width, Input.Height);
+      Current.swap(Next);
+   }
+
+   ///one gray level per pixel, written in the three components as done by the driver
+   Image Output;
+   Output.Width = Input.Width;
+   Output.Height = Input.Height;
+   Output.Data.resize(Size);
+   unsigned int Pixels = Input.Width * Input.Height;
+   for(unsigned int p = 0; p < Pixels; p++)
+      Output.Data[3 * p] = Output.Data[3 * p + 1] = Output.Data[3 * p + 2] = Current[p];
+   writeImage(validateOutput, Output);
+   errs() << " - output written in " << validateOutput << "\n";
+
+   if (!validateReference.empty())
+   {
+      Image Reference;
+      if (!readImage(validateReference, Reference) || Reference.Width != Input.Width || Reference.Height != Input.Height)
+         errs() << "ERROR: unable to read the reference image " << validateReference << "\n";
+      else
+      {
+         ///the border is not computed by the kernels
+         unsigned int Mismatches = 0, Compared = 0;
+         for(unsigned int v = 1; v + 1 < Input.Width; v++)
+         {
+            for(unsigned int h = 1; h + 1 < Input.Height; h++, Compared++)
+            {
+               unsigned int p = v * Input.Height + h;
+               if (Reference.Data[3 * p] == Current[p]) continue;
+               if (Mismatches++ < 10)
+                  errs() << "   pixel (" << v << ", " << h << "): " << (int)Current[p] << " instead of " << (int)Reference.Data[3 * p] << "\n";
+            }
+         }
+         MismatchCounter += Mismatches;
+         errs() << " - " << Mismatches << " of " << Compared << " pixels differ from " << validateReference << "\n";
+         errs() << (Mismatches || Errors ? " - validation FAILED\n" : " - validation PASSED\n");
+      }
+   }
+   errs() << "##\n\n";
+   return false;
+}
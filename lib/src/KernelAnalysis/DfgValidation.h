@@ -0,0 +1,71 @@
+/**
+ * The MIT License (MIT)
+ * 
+ * Copyright (c) 2013 cad-projects
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+/**
+ * Author: Christian Pilato <christian.pilato@polimi.it>
+ *
+ * Description: This class defines the functional validation of the DFGs: the
+ *              selected kernels are interpreted as a pipeline of image filters
+ *              over a PPM image and the result is compared with the output of
+ *              the native execution
+ */
+#ifndef DFGVALIDATION_H
+#define DFGVALIDATION_H
+
+#include "llvm/Pass.h"
+#include "llvm/Module.h"
+
+#include <string>
+#include <vector>
+
+namespace llvm {
+
+  // DfgValidation
+  struct DfgValidation : public ModulePass {
+    static char ID; // Pass identification, replacement for typeid
+    DfgValidation() : ModulePass(ID) {}
+
+    ///image in PPM format (P3)
+    struct Image
+    {
+       unsigned int Width;
+       unsigned int Height;
+       ///components of the pixels (three per pixel)
+       std::vector<unsigned char> Data;
+    };
+
+    virtual bool runOnModule(Module &M);
+
+    void getAnalysisUsage(AnalysisUsage &AU) const;
+
+    static bool readImage(const std::string& FileName, Image& I);
+
+    static void writeImage(const std::string& FileName, const Image& I);
+
+    private:
+
+      /// executes the kernel on each pixel of the image (but the border), returns the number of errors
+      unsigned int runKernel(Function& Kernel, unsigned char* Input, unsigned char* Output, uint64_t Size, unsigned int Width, unsigned int Height);
+  };
+}
+
+#endif
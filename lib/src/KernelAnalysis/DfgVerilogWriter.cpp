@@ -0,0 +1,589 @@
+/**
+ * The MIT License (MIT)
+ * 
+ * Copyright (c) 2013 cad-projects
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+/**
+ * Author: Christian Pilato <christian.pilato@polimi.it>
+ *
+ * Description: Implementation of the Verilog datapath of a DFG. The kernel is
+ *              fully pipelined: a new invocation can start at each cycle
+ *              (in_valid) and its result is available after the latency of the
+ *              pipeline (out_valid, ret). The cycle of each operation is given
+ *              by the schedule, with the basic blocks placed one after the
+ *              other in reverse post-order (without a schedule, each level of
+ *              operations of the DFG takes one cycle); the cycles are then
+ *              grouped into the requested number of stages, and a register is
+ *              inserted for each value at each stage boundary it crosses. The
+ *              control flow is converted into predicates: a flag for each basic
+ *              block and edge, phi nodes as multiplexers and write enables of
+ *              the stores. The scalar parameters are inputs sampled with
+ *              in_valid; each load is a read stream (address, enable and data,
+ *              expected the given number of cycles after the address) and each
+ *              store a write stream (address, data and enable). The loads are
+ *              issued for every valid invocation, also in the conditional
+ *              basic blocks.
+ */
+#include "DfgVerilogWriter.h"
+
+#include "cad/Support.h"
+
+#include "DfgInterpreter.h"
+#include "DfgScheduling.h"
+
+#include "llvm/BasicBlock.h"
+#include "llvm/Constants.h"
+#include "llvm/DerivedTypes.h"
+#include "llvm/Function.h"
+#include "llvm/GlobalVariable.h"
+#include "llvm/Instructions.h"
+#include "llvm/Support/CFG.h"
+#include "llvm/Support/raw_ostream.h"
+#include "llvm/ADT/StringExtras.h"
+
+#include <algorithm>
+#include <set>
+
+using namespace llvm;
+using namespace cadlib;
+
+/// returns the cycles taken by the node when the DFG is not scheduled (extensions, truncations and phi nodes are wires)
+static unsigned int getLevelCost(const DfgNode* N)
+{
+   return dyn_cast<CastInst>(N->Op) || dyn_cast<PHINode>(N->Op) ? 0 : 1;
+}
+
+DfgVerilogWriter::DfgVerilogWriter(DfgGraph* G, const Function* F, DfgScheduling* Scheduling, unsigned int Stages) : Graph(G), F(F), Scheduling(Scheduling), Stages(Stages), Supported(true), Total(0), Final(0)
+{
+   Graph->getEvaluationOrder(Order);
+
+   ///the datapath requires an acyclic control flow and no calls
+   if (!getReversePostOrder(const_cast<Function*>(F), Blocks)) Supported = false;
+   for(unsigned int n = 0; n < Graph->getNodes().size(); n++)
+      if (Graph->getNodes()[n]->Type == DfgNode::CALL) Supported = false;
+
+   if (Supported) computeCycles();
+}
+
+bool DfgVerilogWriter::isSupported() const
+{
+   return Supported;
+}
+
+unsigned int DfgVerilogWriter::getDepth() const
+{
+   return Final;
+}
+
+void DfgVerilogWriter::computeCycles()
+{
+   std::map<BasicBlock*, unsigned int> BbStart;
+   for(unsigned int b = 0; b < Blocks.size(); b++)
+   {
+      BasicBlock* BB = Blocks[b];
+      unsigned int idx = Graph->getBbIdx(BB);
+      ///a basic block starts after the end of its predecessors
+      unsigned int S = 0;
+      if (Scheduling)
+         for(pred_iterator p = pred_begin(BB); p != pred_end(BB); p++)
+            if (BbStart.count(*p)) S = std::max(S, BbStart[*p] + Scheduling->getBbLatency(Graph->getBbIdx(*p)));
+      BbStart[BB] = S;
+
+      for(BasicBlock::iterator i = BB->begin(); dyn_cast<PHINode>(&*i); i++)
+      {
+         const PHINode* P = dyn_cast<PHINode>(&*i);
+         if (!Graph->isNode(P) || Graph->getNode(P)->Op != P) continue;
+         const DfgNode* N = Graph->getNode(P);
+         unsigned int R = S;
+         for(unsigned int v = 0; v < P->getNumIncomingValues(); v++)
+            if (Graph->isNode(P->getIncomingValue(v)) && Ready.count(Graph->getNode(P->getIncomingValue(v))))
+               R = std::max(R, Ready[Graph->getNode(P->getIncomingValue(v))]);
+         Start[N] = R;
+         Ready[N] = R;
+      }
+
+      std::vector<DfgNode*>& Nodes = Order[idx];
+      for(unsigned int n = 0; n < Nodes.size(); n++)
+      {
+         const DfgNode* N = Nodes[n];
+         unsigned int St = 0;
+         for(unsigned int u = 0; u < N->UseNodes.size(); u++)
+            if (Ready.count(N->UseNodes[u])) St = std::max(St, Ready[N->UseNodes[u]]);
+         if (Scheduling && Scheduling->isScheduled(N))
+         {
+            St = std::max(St, S + Scheduling->getCycle(N));
+            Ready[N] = St + Scheduling->getLatency(N);
+         }
+         else
+            Ready[N] = St + (Scheduling ? 0 : getLevelCost(N));
+         Start[N] = St;
+         Total = std::max(Total, Ready[N]);
+      }
+   }
+}
+
+unsigned int DfgVerilogWriter::getStage(unsigned int Cycle) const
+{
+   if (!Stages || Stages >= Total) return Cycle;
+   return Cycle * Stages / Total;
+}
+
+void DfgVerilogWriter::addSignal(const std::string& Name, unsigned int Width, bool Signed, unsigned int Stage, bool Port)
+{
+   Signal S;
+   S.Width = std::max(Width, 1U);
+   S.Signed = Signed && S.Width > 1;
+   S.Stage = Stage;
+   S.MaxStage = Stage;
+   S.Port = Port;
+   Signals[Name] = S;
+   SignalOrder.push_back(Name);
+}
+
+std::string DfgVerilogWriter::getDeclaration(const std::string& Name, const std::string& Declared) const
+{
+   const Signal& S = Signals.find(Name)->second;
+   std::string Declaration = S.Signed ? "signed " : "";
+   if (S.Width > 1) Declaration += "[" + utostr(S.Width - 1) + ":0] ";
+   return Declaration + Declared;
+}
+
+std::string DfgVerilogWriter::at(const std::string& Name, unsigned int Stage)
+{
+   Signal& S = Signals[Name];
+   assert(Stage >= S.Stage && "signal used before its stage");
+   if (Stage == S.Stage) return Name;
+   S.MaxStage = std::max(S.MaxStage, Stage);
+   return Name + "_s" + utostr(Stage);
+}
+
+std::string DfgVerilogWriter::getOperand(const Value* V, unsigned int Stage)
+{
+   V = getOriginalValue(V);
+   if (const ConstantInt* C = dyn_cast<ConstantInt>(V))
+   {
+      if (C->getBitWidth() == 1) return C->isZero() ? "1'b0" : "1'b1";
+      int64_t Value = C->getSExtValue();
+      std::string Literal = utostr(getConstantWidth(Value)) + "'sd" + utostr(Value < 0 ? 0 - (uint64_t)Value : (uint64_t)Value);
+      return Value < 0 ? "(-" + Literal + ")" : Literal;
+   }
+   if (Graph->isNode(V))
+   {
+      const DfgNode* N = Graph->getNode(V);
+      if (Names.count(N)) return at(Names[N], Stage);
+   }
+   else if (const CastInst* C = dyn_cast<CastInst>(V))
+   {
+      std::string Op = getOperand(C->getOperand(0), Stage);
+      if (dyn_cast<ZExtInst>(C)) return "$signed({1'b0, " + Op + "})";
+      if (dyn_cast<TruncInst>(C) && Graph->isNode(C->getOperand(0)) && Names.count(Graph->getNode(C->getOperand(0))))
+      {
+         unsigned int Width = DfgInterpreter::getTypeWidth(C);
+         if (Width < Signals[Names[Graph->getNode(C->getOperand(0))]].Width)
+            return Width == 1 ? Op + "[0]" : "$signed(" + Op + "[" + utostr(Width - 1) + ":0])";
+      }
+      return Op;
+   }
+   ///index computations that are not nodes (e.g., those of the instructions synthesized by the transformations),
+   ///truncated to their width by the assignment to a signal
+   else if (const BinaryOperator* B = dyn_cast<BinaryOperator>(V))
+   {
+      if (!Indexes.count(B))
+      {
+         unsigned int Width = Graph->hasWidth(B) ? Graph->getWidth(B) : DfgInterpreter::getTypeWidth(B);
+         unsigned int OpStage = getOperandStage(B);
+         std::string Expression = getBinary(B, getOperand(B->getOperand(0), OpStage), getOperand(B->getOperand(1), OpStage));
+         if (Expression.empty())
+         {
+            errs() << "WARNING: operation not supported by the Verilog datapath: " << B->getOpcodeName() << "\n";
+            Expression = "1'sb0";
+         }
+         std::string Name = "x" + utostr(Indexes.size());
+         addSignal(Name, Width, true, OpStage);
+         Logic << "   assign " << Name << " = " << Expression << ";\n";
+         Indexes[B] = Name;
+      }
+      return at(Indexes[B], Stage);
+   }
+   ///undefined values
+   return "1'sb0";
+}
+
+unsigned int DfgVerilogWriter::getOperandStage(const Value* V) const
+{
+   V = getOriginalValue(V);
+   if (Graph->isNode(V))
+   {
+      std::map<const DfgNode*, std::string>::const_iterator It = Names.find(Graph->getNode(V));
+      if (It == Names.end()) return 0;
+      return Signals.find(It->second)->second.Stage;
+   }
+   if (const CastInst* C = dyn_cast<CastInst>(V))
+      return getOperandStage(C->getOperand(0));
+   if (const BinaryOperator* B = dyn_cast<BinaryOperator>(V))
+      return std::max(getOperandStage(B->getOperand(0)), getOperandStage(B->getOperand(1)));
+   return 0;
+}
+
+unsigned int DfgVerilogWriter::getAddressStage(const Value* Ptr) const
+{
+   unsigned int Stage = 0;
+   const Value* Memory = NULL;
+   std::vector<std::pair<const Value*, uint64_t> > Terms;
+   getAddressTerms(Ptr, Memory, Terms);
+   for(unsigned int t = 0; t < Terms.size(); t++)
+      Stage = std::max(Stage, getOperandStage(Terms[t].first));
+   return Stage;
+}
+
+std::string DfgVerilogWriter::getAddress(const Value* Ptr, Type* ElementTy, unsigned int Stage, std::string& Memory)
+{
+   ///byte offsets of the indexes of the address
+   std::vector<std::pair<const Value*, uint64_t> > Terms;
+   if (!getAddressTerms(Ptr, Ptr, Terms))
+   {
+      errs() << "WARNING: address not supported by the Verilog datapath: " << Ptr->getName() << "\n";
+      Memory = "unknown";
+      return "32'd0";
+   }
+   Memory = getVarName(Ptr);
+
+   ///the address in elements of the memory if all the offsets are multiple of the element, in bytes otherwise
+   uint64_t Bytes = DfgInterpreter::getTypeBytes(ElementTy);
+   bool Elements = Bytes > 0;
+   for(unsigned int t = 0; t < Terms.size(); t++)
+      Elements = Elements && Terms[t].second % Bytes == 0;
+   std::string Address;
+   for(unsigned int t = 0; t < Terms.size(); t++)
+   {
+      uint64_t Scale = Elements ? Terms[t].second / Bytes : Terms[t].second;
+      if (t) Address += " + ";
+      Address += getOperand(Terms[t].first, Stage);
+      if (Scale != 1) Address += " * 32'sd" + utostr(Scale);
+   }
+   if (Address.empty()) return "32'd0";
+   return "$unsigned(" + Address + ")";
+}
+
+std::string DfgVerilogWriter::getExpression(const DfgNode* N, unsigned int Stage)
+{
+   const Instruction* I = dyn_cast<Instruction>(N->Op);
+   if (const BinaryOperator* B = dyn_cast<BinaryOperator>(I))
+   {
+      std::string Expression = getBinary(B, getOperand(B->getOperand(0), Stage), getOperand(B->getOperand(1), Stage));
+      if (!Expression.empty()) return Expression;
+   }
+   else if (const ICmpInst* C = dyn_cast<ICmpInst>(I))
+   {
+      std::string A = getOperand(C->getOperand(0), Stage), B = getOperand(C->getOperand(1), Stage);
+      if (C->isUnsigned())
+      {
+         A = "$unsigned(" + A + ")";
+         B = "$unsigned(" + B + ")";
+      }
+      switch(C->getPredicate())
+      {
+         case CmpInst::ICMP_EQ: return A + " == " + B;
+         case CmpInst::ICMP_NE: return A + " != " + B;
+         case CmpInst::ICMP_SGT:
+         case CmpInst::ICMP_UGT: return A + " > " + B;
+         case CmpInst::ICMP_SGE:
+         case CmpInst::ICMP_UGE: return A + " >= " + B;
+         case CmpInst::ICMP_SLT:
+         case CmpInst::ICMP_ULT: return A + " < " + B;
+         case CmpInst::ICMP_SLE:
+         case CmpInst::ICMP_ULE: return A + " <= " + B;
+         default:
+            break;
+      }
+   }
+   else if (const SelectInst* S = dyn_cast<SelectInst>(I))
+      return getOperand(S->getCondition(), Stage) + " ? " + getOperand(S->getTrueValue(), Stage) + " : " + getOperand(S->getFalseValue(), Stage);
+   else if (const CastInst* C = dyn_cast<CastInst>(I))
+   {
+      ///extensions and truncations that are nodes of the DFG (their users refer to the original value)
+      if (dyn_cast<ZExtInst>(C)) return "$signed({1'b0, " + getOperand(C->getOperand(0), Stage) + "})";
+      return getOperand(C->getOperand(0), Stage);
+   }
+
+   errs() << "WARNING: operation not supported by the Verilog datapath: " << I->getOpcodeName() << "\n";
+   return "1'sb0";
+}
+
+std::string DfgVerilogWriter::getBinary(const BinaryOperator* B, const std::string& A, const std::string& C)
+{
+   switch(B->getOpcode())
+   {
+      case Instruction::Add: return A + " + " + C;
+      case Instruction::Sub: return A + " - " + C;
+      case Instruction::Mul: return A + " * " + C;
+      case Instruction::And: return A + " & " + C;
+      case Instruction::Or: return A + " | " + C;
+      case Instruction::Xor: return A + " ^ " + C;
+      case Instruction::Shl: return A + " <<< $unsigned(" + C + ")";
+      case Instruction::AShr: return A + " >>> $unsigned(" + C + ")";
+      case Instruction::LShr: return "$signed($unsigned(" + A + ") >> $unsigned(" + C + "))";
+      ///division by zero returns 0, as in the DFG interpreter
+      case Instruction::SDiv: return "(" + C + " == 0) ? 1'sb0 : " + A + " / " + C;
+      case Instruction::SRem: return "(" + C + " == 0) ? 1'sb0 : " + A + " % " + C;
+      case Instruction::UDiv: return "(" + C + " == 0) ? 1'sb0 : $signed($unsigned(" + A + ") / $unsigned(" + C + "))";
+      case Instruction::URem: return "(" + C + " == 0) ? 1'sb0 : $signed($unsigned(" + A + ") % $unsigned(" + C + "))";
+      default:
+         return "";
+   }
+}
+
+std::string DfgVerilogWriter::getEdge(BasicBlock* From, BasicBlock* To)
+{
+   std::string Name = "e" + utostr(Graph->getBbIdx(From)) + "_" + utostr(Graph->getBbIdx(To));
+   if (Signals.count(Name)) return Name;
+   std::string Source = "bb" + utostr(Graph->getBbIdx(From));
+   const TerminatorInst* T = From->getTerminator();
+   const Value* Condition = NULL;
+   if (const BranchInst* Br = dyn_cast<BranchInst>(T))
+      Condition = Br->isConditional() && Br->getSuccessor(0) != Br->getSuccessor(1) ? Br->getCondition() : NULL;
+   else if (const SwitchInst* Sw = dyn_cast<SwitchInst>(T))
+      Condition = Sw->getCondition();
+   unsigned int Stage = std::max(Signals[Source].Stage, Condition ? getOperandStage(Condition) : 0);
+   std::string Taken;
+   if (const BranchInst* Br = dyn_cast<BranchInst>(T))
+   {
+      if (!Condition)
+         Taken = "1'b1";
+      else
+         Taken = std::string(Br->getSuccessor(0) == To ? "" : "!") + "(" + getOperand(Condition, Stage) + ")";
+   }
+   else if (const SwitchInst* Sw = dyn_cast<SwitchInst>(T))
+   {
+      std::string Value = getOperand(Condition, Stage), Cases;
+      for(SwitchInst::ConstCaseIt c = Sw->case_begin(); c != Sw->case_end(); ++c)
+      {
+         std::string Case = Value + " == " + getOperand(c.getCaseValue(), Stage);
+         Cases += (Cases.empty() ? "" : " || ") + Case;
+         if (c.getCaseSuccessor() == To) Taken += (Taken.empty() ? "" : " || ") + Case;
+      }
+      if (Sw->getDefaultDest() == To)
+         Taken += (Taken.empty() ? "" : " || ") + (Cases.empty() ? std::string("1'b1") : "!(" + Cases + ")");
+   }
+   if (Taken.empty()) Taken = "1'b0";
+   addSignal(Name, 1, false, Stage);
+   Logic << "   assign " << Name << " = " << at(Source, Stage) << " && (" << Taken << ");\n";
+   return Name;
+}
+
+void DfgVerilogWriter::writeBasicBlock(unsigned int b, std::map<std::string, unsigned int>& PortCount)
+{
+   BasicBlock* BB = Blocks[b];
+   unsigned int idx = Graph->getBbIdx(BB);
+   std::string Flag = "bb" + utostr(idx);
+   std::set<BasicBlock*> Processed(Blocks.begin(), Blocks.begin() + b);
+
+   ///execution flag of the basic block
+   std::vector<std::string> Edges;
+   unsigned int FlagStage = 0;
+   std::set<BasicBlock*> Predecessors;
+   for(pred_iterator p = pred_begin(BB); p != pred_end(BB); p++)
+   {
+      if (!Processed.count(*p) || !Predecessors.insert(*p).second) continue;
+      Edges.push_back(getEdge(*p, BB));
+      FlagStage = std::max(FlagStage, Signals[Edges.back()].Stage);
+   }
+   addSignal(Flag, 1, false, FlagStage);
+   std::string Incoming;
+   for(unsigned int e = 0; e < Edges.size(); e++)
+      Incoming += (e ? " || " : "") + at(Edges[e], FlagStage);
+   Logic << "   assign " << Flag << " = " << (b == 0 ? std::string("1'b1") : Incoming.empty() ? std::string("1'b0") : Incoming) << ";\n";
+
+   ///the phi nodes select the value of the active incoming edge
+   for(BasicBlock::iterator i = BB->begin(); dyn_cast<PHINode>(&*i); i++)
+   {
+      const PHINode* P = dyn_cast<PHINode>(&*i);
+      if (!Graph->isNode(P) || Graph->getNode(P)->Op != P) continue;
+      const DfgNode* N = Graph->getNode(P);
+      unsigned int Stage = getStage(Ready[N]);
+      for(unsigned int v = 0; v < P->getNumIncomingValues(); v++)
+      {
+         if (!Processed.count(P->getIncomingBlock(v))) continue;
+         Stage = std::max(Stage, Signals[getEdge(P->getIncomingBlock(v), BB)].Stage);
+         Stage = std::max(Stage, getOperandStage(P->getIncomingValue(v)));
+      }
+      std::string Select = "1'sb0";
+      for(unsigned int v = P->getNumIncomingValues(); v > 0; v--)
+      {
+         if (!Processed.count(P->getIncomingBlock(v-1))) continue;
+         Select = at(getEdge(P->getIncomingBlock(v-1), BB), Stage) + " ? " + getOperand(P->getIncomingValue(v-1), Stage) + " : " + (v == P->getNumIncomingValues() ? Select : "(" + Select + ")");
+      }
+      Names[N] = "n" + utostr(N->Id);
+      addSignal(Names[N], N->getWidth(), DfgInterpreter::getTypeWidth(P) > 1, Stage);
+      Logic << "   assign " << Names[N] << " = " << Select << "; // " << P->getName().str() << "\n";
+      Final = std::max(Final, Stage);
+   }
+
+   std::vector<DfgNode*>& Nodes = Order[idx];
+   for(unsigned int n = 0; n < Nodes.size(); n++)
+   {
+      const DfgNode* N = Nodes[n];
+      if (const StoreInst* S = dyn_cast<StoreInst>(N->Op))
+      {
+         ///the write is enabled if the invocation is valid and the basic block is executed
+         unsigned int Stage = std::max(std::max(getStage(Start[N]), FlagStage), std::max(getAddressStage(S->getPointerOperand()), getOperandStage(S->getValueOperand())));
+         std::string Memory, Address = getAddress(S->getPointerOperand(), S->getValueOperand()->getType(), Stage, Memory);
+         std::string Port = Memory + "_wr" + utostr(PortCount[Memory + "_wr"]++);
+         ///the data port is as wide as the element of the memory: the (signed) value is sign-extended to the
+         ///element, or truncated to it, by the assignment
+         unsigned int Width = std::max(DfgInterpreter::getTypeWidth(S->getValueOperand()), 1U);
+         Ports.push_back("output [31:0] " + Port + "_addr");
+         Ports.push_back("output " + (Width > 1 ? "[" + utostr(Width - 1) + ":0] " : std::string("")) + Port + "_data");
+         Ports.push_back("output " + Port + "_en");
+         Logic << "   assign " << Port << "_addr = " << Address << ";\n";
+         Logic << "   assign " << Port << "_data = " << getOperand(S->getValueOperand(), Stage) << ";\n";
+         Logic << "   assign " << Port << "_en = " << at("in_valid", Stage) << " && " << at(Flag, Stage) << ";\n";
+         Final = std::max(Final, Stage);
+      }
+      else if (const LoadInst* L = dyn_cast<LoadInst>(N->Op))
+      {
+         ///the data is expected the same number of stages after the address as in the schedule
+         unsigned int Issue = std::max(getStage(Start[N]), getAddressStage(L->getPointerOperand()));
+         unsigned int Stage = Issue + getStage(Ready[N]) - getStage(Start[N]);
+         std::string Memory, Address = getAddress(L->getPointerOperand(), L->getType(), Issue, Memory);
+         std::string Port = Memory + "_rd" + utostr(PortCount[Memory + "_rd"]++);
+         ///the data port is as wide as the element of the memory: as in DfgInterpreter, the element is
+         ///zero-extended to the width of the node, or wrapped to it
+         unsigned int Width = std::max(DfgInterpreter::getTypeWidth(L), 1U);
+         Ports.push_back("output [31:0] " + Port + "_addr");
+         Ports.push_back("output " + Port + "_en");
+         Ports.push_back("input " + (Width > 1 ? "[" + utostr(Width - 1) + ":0] " : std::string("")) + Port + "_data /* " + utostr(Stage - Issue) + " cycles after the address */");
+         Logic << "   assign " << Port << "_addr = " << Address << ";\n";
+         Logic << "   assign " << Port << "_en = " << at("in_valid", Issue) << ";\n";
+         Names[N] = "n" + utostr(N->Id);
+         addSignal(Names[N], N->getWidth(), Width > 1, Stage);
+         std::string Data = N->getWidth() > Width ? "$signed({1'b0, " + Port + "_data})" : Port + "_data";
+         Logic << "   assign " << Names[N] << " = " << Data << "; // " << L->getName().str() << "\n";
+         Final = std::max(Final, Stage);
+      }
+      else if (N->hasValue())
+      {
+         unsigned int Stage = getStage(Ready[N]);
+         ///the operands of the node might be available in a later stage (e.g., phi nodes)
+         for(unsigned int o = 0; o < dyn_cast<Instruction>(N->Op)->getNumOperands(); o++)
+            Stage = std::max(Stage, getOperandStage(dyn_cast<Instruction>(N->Op)->getOperand(o)));
+         Names[N] = "n" + utostr(N->Id);
+         addSignal(Names[N], N->getWidth(), DfgInterpreter::getTypeWidth(N->Op) > 1, Stage);
+         Logic << "   assign " << Names[N] << " = " << getExpression(N, Stage) << "; // " << N->Op->getName().str() << "\n";
+         Final = std::max(Final, Stage);
+      }
+   }
+}
+
+std::string DfgVerilogWriter::write()
+{
+   if (!Supported) return "";
+   Signals.clear();
+   SignalOrder.clear();
+   Names.clear();
+   Indexes.clear();
+   Ports.clear();
+   Logic.str("");
+   Final = getStage(Total);
+
+   Ports.push_back("input clk");
+   Ports.push_back("input rst");
+   Ports.push_back("input in_valid");
+   Ports.push_back("output out_valid");
+   addSignal("in_valid", 1, false, 0, true);
+
+   ///scalar parameters, sampled with in_valid
+   for(Function::const_arg_iterator A = F->arg_begin(); A != F->arg_end(); A++)
+   {
+      if (A->getType()->isPointerTy() || !Graph->isNode(&*A)) continue;
+      const DfgNode* N = Graph->getNode(&*A);
+      Names[N] = getVarName(&*A);
+      addSignal(Names[N], N->getWidth(), true, 0, true);
+      Ports.push_back("input " + getDeclaration(Names[N], Names[N]));
+   }
+
+   std::map<std::string, unsigned int> PortCount;
+   for(unsigned int b = 0; b < Blocks.size(); b++)
+      writeBasicBlock(b, PortCount);
+
+   ///returned value, selected by the flag of the basic block of the return
+   IntegerType* RetTy = dyn_cast<IntegerType>(F->getReturnType());
+   if (RetTy)
+   {
+      unsigned int Stage = 0;
+      std::vector<std::pair<std::string, const Value*> > Returns;
+      for(unsigned int b = 0; b < Blocks.size(); b++)
+      {
+         const ReturnInst* Ret = dyn_cast<ReturnInst>(Blocks[b]->getTerminator());
+         if (!Ret || !Ret->getReturnValue()) continue;
+         std::string Flag = "bb" + utostr(Graph->getBbIdx(Blocks[b]));
+         Returns.push_back(std::make_pair(Flag, Ret->getReturnValue()));
+         Stage = std::max(Stage, std::max(Signals[Flag].Stage, getOperandStage(Ret->getReturnValue())));
+      }
+      std::string Select = "1'sb0";
+      for(unsigned int r = Returns.size(); r > 0; r--)
+         Select = at(Returns[r-1].first, Stage) + " ? " + getOperand(Returns[r-1].second, Stage) + " : " + (r == Returns.size() ? Select : "(" + Select + ")");
+      addSignal("ret_value", RetTy->getBitWidth(), true, Stage);
+      Logic << "   assign ret_value = " << Select << ";\n";
+      Final = std::max(Final, Stage);
+      Ports.push_back("output " + getDeclaration("ret_value", "ret"));
+      Logic << "   assign ret = " << at("ret_value", Final) << ";\n";
+   }
+   Logic << "   assign out_valid = " << at("in_valid", Final) << ";\n";
+
+   std::ostringstream oss;
+   oss << "/// Pipelined datapath of " << Graph->getFunctionName() << ": a new invocation can start at each cycle\n";
+   oss << "/// (in_valid) and its result is available after " << Final << " cycles (out_valid)\n";
+   oss << "module " << Graph->getFunctionName() << "(\n";
+   for(unsigned int p = 0; p < Ports.size(); p++)
+   {
+      ///the comment of a port follows the separator
+      std::string Port = Ports[p], Comment;
+      if (Port.find(" /*") != std::string::npos)
+      {
+         Comment = Port.substr(Port.find(" /*"));
+         Port = Port.substr(0, Port.find(" /*"));
+      }
+      oss << "   " << Port << (p + 1 < Ports.size() ? "," : "") << Comment << "\n";
+   }
+   oss << ");\n\n";
+
+   std::ostringstream Registers;
+   for(unsigned int s = 0; s < SignalOrder.size(); s++)
+   {
+      const std::string& Name = SignalOrder[s];
+      const Signal& S = Signals[Name];
+      if (!S.Port) oss << "   wire " << getDeclaration(Name, Name) << ";\n";
+      for(unsigned int k = S.Stage + 1; k <= S.MaxStage; k++)
+      {
+         std::string Reg = Name + "_s" + utostr(k), Prev = k == S.Stage + 1 ? Name : Name + "_s" + utostr(k - 1);
+         oss << "   reg " << getDeclaration(Name, Reg) << ";\n";
+         if (Name == "in_valid")
+            Registers << "      " << Reg << " <= rst ? 1'b0 : " << Prev << ";\n";
+         else
+            Registers << "      " << Reg << " <= " << Prev << ";\n";
+      }
+   }
+   oss << "\n" << Logic.str();
+   if (Registers.str().size())
+      oss << "\n   always @(posedge clk)\n   begin\n" << Registers.str() << "   end\n";
+   oss << "\nendmodule\n";
+   return oss.str();
+}
@@ -0,0 +1,160 @@
+/**
+ * The MIT License (MIT)
+ * 
+ * Copyright (c) 2013 cad-projects
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+/**
+ * Author: Christian Pilato <christian.pilato@polimi.it>
+ *
+ * Description: This file defines the generator of the pipelined datapath of a
+ *              DFG in Verilog: one module per function, with the operators
+ *              sized by the width of the nodes and registers at the boundaries
+ *              of the pipeline stages obtained from the schedule
+ */
+#ifndef DFGVERILOGWRITER_H
+#define DFGVERILOGWRITER_H
+
+#include "Dfg.h"
+
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace llvm {
+
+class BasicBlock;
+class BinaryOperator;
+class Function;
+class Type;
+struct DfgScheduling;
+
+class DfgVerilogWriter
+{
+
+   private:
+
+      ///signal of the datapath, produced in the stage Stage and delayed by registers up to MaxStage
+      struct Signal
+      {
+         unsigned int Width;
+         bool Signed;
+         unsigned int Stage;
+         unsigned int MaxStage;
+         ///input port of the module (not declared as a wire)
+         bool Port;
+      };
+
+      DfgGraph* Graph;
+
+      const Function* F;
+
+      ///schedule of the operations (NULL: one cycle per level of the DFG)
+      DfgScheduling* Scheduling;
+
+      ///requested number of pipeline stages (0: one stage per cycle)
+      unsigned int Stages;
+
+      ///basic blocks in reverse post-order
+      std::vector<BasicBlock*> Blocks;
+
+      ///true if the control flow is acyclic and there are no calls
+      bool Supported;
+
+      ///non-phi nodes of each basic block in evaluation order (memory accesses in program order)
+      std::map<unsigned int, std::vector<DfgNode*> > Order;
+
+      ///cycles (from the start of the invocation) when the operation starts and its result is available
+      std::map<const DfgNode*, unsigned int> Start;
+      std::map<const DfgNode*, unsigned int> Ready;
+      unsigned int Total;
+
+      std::map<std::string, Signal> Signals;
+      ///names of the signals in order of creation
+      std::vector<std::string> SignalOrder;
+
+      ///last stage of the pipeline
+      unsigned int Final;
+
+      ///name of the signal of each node
+      std::map<const DfgNode*, std::string> Names;
+
+      ///name of the signal of each index computation that is not a node
+      std::map<const Value*, std::string> Indexes;
+
+      std::vector<std::string> Ports;
+      std::ostringstream Logic;
+
+      /// computes the start and ready cycles of the nodes
+      void computeCycles();
+
+      /// returns the pipeline stage of a cycle
+      unsigned int getStage(unsigned int Cycle) const;
+
+      void addSignal(const std::string& Name, unsigned int Width, bool Signed, unsigned int Stage, bool Port = false);
+
+      /// returns the declaration of a signal of the format of Name, e.g. "signed [7:0] n12"
+      std::string getDeclaration(const std::string& Name, const std::string& Declared) const;
+
+      /// returns the name of the signal delayed to the stage
+      std::string at(const std::string& Name, unsigned int Stage);
+
+      /// returns the expression of an operand in the stage (constant, node, extension/truncation of a node or
+      /// index computation)
+      std::string getOperand(const Value* V, unsigned int Stage);
+
+      /// returns the stage when the operand is available (0 for constants)
+      unsigned int getOperandStage(const Value* V) const;
+
+      /// returns the stage when the indexes of the address are available
+      unsigned int getAddressStage(const Value* Ptr) const;
+
+      /// returns the element address accessed through the pointer in the stage and the accessed memory
+      std::string getAddress(const Value* Ptr, Type* ElementTy, unsigned int Stage, std::string& Memory);
+
+      /// returns the expression computed by the node in the stage
+      std::string getExpression(const DfgNode* N, unsigned int Stage);
+
+      /// returns the expression of a binary operation on the given operands, empty if not supported
+      static std::string getBinary(const BinaryOperator* B, const std::string& A, const std::string& C);
+
+      /// returns the condition of the edge between two basic blocks (the signal is created if needed)
+      std::string getEdge(BasicBlock* From, BasicBlock* To);
+
+      void writeBasicBlock(unsigned int b, std::map<std::string, unsigned int>& PortCount);
+
+   public:
+
+      DfgVerilogWriter(DfgGraph* G, const Function* F, DfgScheduling* Scheduling, unsigned int Stages);
+
+      /// returns true if the datapath can be generated (acyclic control flow and no calls)
+      bool isSupported() const;
+
+      /// returns the Verilog code of the module
+      std::string write();
+
+      /// returns the latency of the generated pipeline (in cycles)
+      unsigned int getDepth() const;
+
+};
+
+}
+
+#endif
@@ -0,0 +1,213 @@
+/**
+ * The MIT License (MIT)
+ * 
+ * Copyright (c) 2013 cad-projects
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+/**
+ * Author: Christian Pilato <christian.pilato@polimi.it>
+ *
+ * Description: Implementation of the library of functional units. The default
+ *              characterization can be overridden in the configuration file with
+ *              the following entries:
+ *                OPERATOR <opcode> <max_width> <latency> <area>
+ *                DELAY <opcode> <base_ns> <ns_per_bit> [<ns_per_squared_bit>]
+ *                RESOURCE <opcode> <units>
+ *                MEMORY_PORTS <ports>
+ */
+#include "OperatorLibrary.h"
+
+#include "llvm/Instructions.h"
+#include "llvm/Support/raw_ostream.h"
+
+#include <algorithm>
+#include <fstream>
+#include <set>
+#include <sstream>
+
+using namespace llvm;
+
+static bool compareWidth(const OperatorLibrary::Characterization& a, const OperatorLibrary::Characterization& b)
+{
+   return a.MaxWidth < b.MaxWidth;
+}
+
+OperatorLibrary::OperatorLibrary() : MemoryPorts(1)
+{
+   addOperator("add", 16, 1, 16);
+   addOperator("add", 32, 1, 32);
+   addOperator("add", 64, 2, 64);
+   addOperator("sub", 16, 1, 16);
+   addOperator("sub", 32, 1, 32);
+   addOperator("sub", 64, 2, 64);
+   addOperator("icmp", 32, 1, 32);
+   addOperator("icmp", 64, 1, 64);
+   addOperator("ashr", 32, 1, 40);
+   addOperator("ashr", 64, 1, 96);
+   ///shifts by constants, slices and concatenations generated by the DFG transformations are wires
+   addOperator("shl", 64, 0, 0);
+   addOperator("lshr", 64, 0, 0);
+   addOperator("or", 64, 0, 0);
+   addOperator("mul", 8, 1, 64);
+   addOperator("mul", 16, 2, 256);
+   addOperator("mul", 32, 3, 1024);
+   addOperator("mul", 64, 5, 4096);
+   addOperator("sdiv", 8, 4, 200);
+   addOperator("sdiv", 16, 8, 600);
+   addOperator("sdiv", 32, 16, 2000);
+   addOperator("sdiv", 64, 34, 8000);
+   addOperator("udiv", 8, 4, 200);
+   addOperator("udiv", 16, 8, 600);
+   addOperator("udiv", 32, 16, 2000);
+   addOperator("udiv", 64, 34, 8000);
+   addOperator("load", 64, 2, 0);
+   addOperator("store", 64, 1, 0);
+   addOperator("ret", 64, 0, 0);
+   ///the phi nodes select the value of the current iteration
+   addOperator("phi", 64, 0, 0);
+   ///multiplexers created by the if-conversion
+   addOperator("select", 32, 0, 8);
+   addOperator("select", 64, 0, 16);
+
+   addDelay("add", 0.5, 0.03, 0);
+   addDelay("sub", 0.5, 0.03, 0);
+   addDelay("icmp", 0.4, 0.02, 0);
+   addDelay("ashr", 0.4, 0.01, 0);
+   addDelay("mul", 1.0, 0.12, 0);
+   addDelay("sdiv", 0.5, 0.5, 0.03);
+   addDelay("udiv", 0.5, 0.5, 0.03);
+   addDelay("select", 0.3, 0, 0);
+   addDelay("load", 2.0, 0, 0);
+   addDelay("store", 1.0, 0, 0);
+}
+
+void OperatorLibrary::addDelay(const std::string& Opcode, double Base, double Linear, double Quadratic)
+{
+   DelayModel D;
+   D.Base = Base;
+   D.Linear = Linear;
+   D.Quadratic = Quadratic;
+   Delays[Opcode] = D;
+}
+
+void OperatorLibrary::addOperator(const std::string& Opcode, unsigned int MaxWidth, unsigned int Latency, double Area)
+{
+   Characterization C;
+   C.MaxWidth = MaxWidth;
+   C.Latency = Latency;
+   C.Area = Area;
+   std::vector<Characterization>& Entries = Operators[Opcode];
+   Entries.push_back(C);
+   std::stable_sort(Entries.begin(), Entries.end(), compareWidth);
+}
+
+void OperatorLibrary::parseConfig(const std::string& configFile)
+{
+   std::set<std::string> Overridden;
+   std::string line;
+   std::ifstream myfile(configFile.c_str());
+   if (myfile.is_open())
+   {
+      while (myfile.good())
+      {
+         getline (myfile,line);
+         std::istringstream iss(line);
+         std::string Key;
+         iss >> Key;
+         if (Key == "OPERATOR")
+         {
+            std::string Opcode;
+            unsigned int MaxWidth = 0, Latency = 0;
+            double Area = 0;
+            if (!(iss >> Opcode >> MaxWidth >> Latency >> Area)) continue;
+            ///the first entry of an opcode replaces its default characterization
+            if (Overridden.insert(Opcode).second) Operators.erase(Opcode);
+            addOperator(Opcode, MaxWidth, Latency, Area);
+            errs() << "#" << Opcode << "# up to " << MaxWidth << " bits -> latency = " << Latency << ", area = " << Area << "\n";
+         }
+         else if (Key == "DELAY")
+         {
+            std::string Opcode;
+            double Base = 0, Linear = 0, Quadratic = 0;
+            if (!(iss >> Opcode >> Base >> Linear)) continue;
+            iss >> Quadratic;
+            addDelay(Opcode, Base, Linear, Quadratic);
+            errs() << "#" << Opcode << "# -> delay = " << Base << " + " << Linear << " * w + " << Quadratic << " * w^2 ns\n";
+         }
+         else if (Key == "RESOURCE")
+         {
+            std::string Opcode;
+            unsigned int Num = 0;
+            if (!(iss >> Opcode >> Num)) continue;
+            Units[Opcode] = Num;
+            errs() << "#" << Opcode << "# -> units = " << Num << "\n";
+         }
+         else if (Key == "MEMORY_PORTS")
+         {
+            unsigned int Num = 0;
+            if (!(iss >> Num) || Num == 0) continue;
+            MemoryPorts = Num;
+            errs() << "memory ports = " << Num << "\n";
+         }
+      }
+      myfile.close();
+   }
+}
+
+std::string OperatorLibrary::getOpcode(const Value* Op)
+{
+   if (!dyn_cast<Instruction>(Op)) return "";
+   return dyn_cast<Instruction>(Op)->getOpcodeName();
+}
+
+const OperatorLibrary::Characterization& OperatorLibrary::getCharacterization(const std::string& Opcode, unsigned int Width) const
+{
+   static Characterization Default = { ~0U, 1, 0 };
+   std::map<std::string, std::vector<Characterization> >::const_iterator It = Operators.find(Opcode);
+   if (It == Operators.end() || It->second.empty()) return Default;
+   const std::vector<Characterization>& Entries = It->second;
+   for(unsigned int e = 0; e < Entries.size(); e++)
+      if (Width <= Entries[e].MaxWidth) return Entries[e];
+   return Entries.back();
+}
+
+unsigned int OperatorLibrary::getLatency(const std::string& Opcode, unsigned int Width) const
+{
+   return getCharacterization(Opcode, Width).Latency;
+}
+
+double OperatorLibrary::getArea(const std::string& Opcode, unsigned int Width) const
+{
+   return getCharacterization(Opcode, Width).Area;
+}
+
+double OperatorLibrary::getDelay(const std::string& Opcode, unsigned int Width) const
+{
+   std::map<std::string, DelayModel>::const_iterator It = Delays.find(Opcode);
+   if (It == Delays.end()) return 0;
+   const DelayModel& D = It->second;
+   return D.Base + D.Linear * Width + D.Quadratic * Width * Width;
+}
+
+unsigned int OperatorLibrary::getUnits(const std::string& Opcode) const
+{
+   std::map<std::string, unsigned int>::const_iterator It = Units.find(Opcode);
+   if (It == Units.end()) return 0;
+   return It->second;
+}
@@ -0,0 +1,113 @@
+/**
+ * The MIT License (MIT)
+ * 
+ * Copyright (c) 2013 cad-projects
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+/**
+ * Author: Christian Pilato <christian.pilato@polimi.it>
+ *
+ * Description: This file defines the library of functional units (latency and
+ *              area of each operation, as function of the opcode and bitwidth)
+ *              used by the analyses on the DFG.
+ */
+#ifndef OPERATORLIBRARY_H
+#define OPERATORLIBRARY_H
+
+#include <map>
+#include <string>
+#include <vector>
+
+namespace llvm {
+
+class Value;
+
+class OperatorLibrary
+{
+
+   public:
+
+      struct Characterization
+      {
+         ///maximum bitwidth covered by this entry
+         unsigned int MaxWidth;
+         ///latency (in clock cycles)
+         unsigned int Latency;
+         ///area (in arbitrary units)
+         double Area;
+      };
+
+      ///combinational delay (in ns) as function of the bitwidth: Base + Linear * w + Quadratic * w^2
+      struct DelayModel
+      {
+         double Base;
+         double Linear;
+         double Quadratic;
+      };
+
+   private:
+
+      ///characterizations of each opcode, sorted by increasing MaxWidth
+      std::map<std::string, std::vector<Characterization> > Operators;
+
+      ///delay model of each opcode
+      std::map<std::string, DelayModel> Delays;
+
+      ///number of units available for each opcode (missing entries are unlimited)
+      std::map<std::string, unsigned int> Units;
+
+      ///number of ports of each memory (stream)
+      unsigned int MemoryPorts;
+
+      void addOperator(const std::string& Opcode, unsigned int MaxWidth, unsigned int Latency, double Area);
+
+      void addDelay(const std::string& Opcode, double Base, double Linear, double Quadratic);
+
+      const Characterization& getCharacterization(const std::string& Opcode, unsigned int Width) const;
+
+   public:
+
+      OperatorLibrary();
+
+      /// reads the OPERATOR, DELAY, RESOURCE and MEMORY_PORTS entries of the configuration file
+      void parseConfig(const std::string& configFile);
+
+      /// returns the opcode used to characterize the given operation
+      static std::string getOpcode(const Value* Op);
+
+      unsigned int getLatency(const std::string& Opcode, unsigned int Width) const;
+
+      double getArea(const std::string& Opcode, unsigned int Width) const;
+
+      /// returns the combinational delay (in ns) of the opcode at the given bitwidth
+      double getDelay(const std::string& Opcode, unsigned int Width) const;
+
+      /// returns the number of available units for the opcode (0 if unlimited)
+      unsigned int getUnits(const std::string& Opcode) const;
+
+      unsigned int getMemoryPorts() const
+      {
+         return MemoryPorts;
+      }
+
+};
+
+}
+
+#endif
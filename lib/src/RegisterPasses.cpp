@@ -45,6 +45,21 @@ static void initializeCodesignPasses(PassRegistry &Registry) {
    initializeDfgGenerationPass(Registry);
    initializeDfgPrintingPass(Registry);
    initializeDetermineBitWidthPass(Registry);
+   initializeDfgSchedulingPass(Registry);
+   initializeDfgTimingPass(Registry);
+   initializeDfgTreeHeightReductionPass(Registry);
+   initializeDfgStrengthReductionPass(Registry);
+   initializeDfgStencilPass(Registry);
+   initializeAffineIndexPass(Registry);
+   initializeDfgMemoryCoalescingPass(Registry);
+   initializeDfgMemoryPortsPass(Registry);
+   initializeDfgInitiationIntervalPass(Registry);
+   initializeDfgMemoryDependencePass(Registry);
+   initializeDfgTaskGraphPass(Registry);
+   initializeDfgIfConversionPass(Registry);
+   initializeDfgPruningPass(Registry);
+   initializeDfgValidationPass(Registry);
+   initializeDfgProfilingPass(Registry);
 }
 
 namespace {
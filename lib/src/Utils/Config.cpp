@@ -27,6 +27,11 @@
  */
 #include "cad/Config.h"
 
+#include "llvm/Instructions.h"
+
+#include <algorithm>
+#include <set>
+
 using namespace llvm;
 
 cl::list<std::string> llvm::functionNames("function",
@@ -37,3 +42,25 @@ cl::opt<std::string> llvm::configFile("cadlib-config",
   cl::desc("Specify the configuration file to be processed"),
   cl::value_desc("name"));
 
+
+static bool isReachedFromKernel(const Function* F, std::set<const Function*>& Visited)
+{
+   if (std::find(functionNames.begin(), functionNames.end(), F->getName()) != functionNames.end())
+      return true;
+   for(Value::const_use_iterator It = F->use_begin(); It != F->use_end(); It++)
+   {
+      const CallInst* Call = dyn_cast<CallInst>(*It);
+      if (!Call || Call->getCalledFunction() != F) continue;
+      const Function* Caller = Call->getParent()->getParent();
+      if (Visited.insert(Caller).second && isReachedFromKernel(Caller, Visited))
+         return true;
+   }
+   return false;
+}
+
+bool llvm::isCalledByKernel(const Function& F)
+{
+   std::set<const Function*> Visited;
+   Visited.insert(&F);
+   return isReachedFromKernel(&F, Visited);
+}
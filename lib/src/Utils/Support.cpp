@@ -28,8 +28,16 @@
 #include "cad/Support.h"
 
 #include "llvm/Constants.h"
+#include "llvm/Function.h"
 #include "llvm/Instructions.h"
+#include "llvm/Support/CFG.h"
 #include "llvm/Support/raw_ostream.h"
+#include "llvm/ADT/PostOrderIterator.h"
+#include "llvm/ADT/StringExtras.h"
+
+#include <algorithm>
+#include <iterator>
+#include <sstream>
 
 using namespace llvm;
 
@@ -61,6 +69,18 @@ std::string getOperator(const Instruction* I)
       {
          return ">>";
       }
+      case Instruction::Shl:
+      {
+         return "<<";
+      }
+      case Instruction::LShr:
+      {
+         return ">>";
+      }
+      case Instruction::Or:
+      {
+         return "|";
+      }
       case Instruction::ICmp:
       {
          CmpInst::Predicate pred = dyn_cast<ICmpInst>(I)->getSignedPredicate();
@@ -76,6 +96,26 @@ std::string getOperator(const Instruction* I)
                return "<";
                break;
             }
+            case CmpInst::ICMP_SGE:
+            {
+               return ">=";
+               break;
+            }
+            case CmpInst::ICMP_SLE:
+            {
+               return "<=";
+               break;
+            }
+            case CmpInst::ICMP_EQ:
+            {
+               return "==";
+               break;
+            }
+            case CmpInst::ICMP_NE:
+            {
+               return "!=";
+               break;
+            }
             default:
             {
                assert(0 && "UNSUPPORTED PREDICATE!\n");
@@ -133,7 +173,9 @@ std::string addBracket(const Value* op)
 
 void getMemoryOps(const Value* I, std::list<const Value*>& operations)
 {
-   if (dyn_cast<Argument>(I) || dyn_cast<GlobalVariable>(I) || dyn_cast<Constant>(I))
+   I = getOriginalValue(I);
+   ///the induction variables of the loops are nodes of the DFG
+   if (dyn_cast<Argument>(I) || dyn_cast<GlobalVariable>(I) || dyn_cast<Constant>(I) || dyn_cast<PHINode>(I))
    {
       return;
    }
@@ -151,6 +193,10 @@ void getMemoryOps(const Value* I, std::list<const Value*>& operations)
 
 const Value* getMemoryVar(const Value* I)
 {
+   I = getOriginalValue(I);
+   if (dyn_cast<BitCastInst>(I))
+      return getMemoryVar(dyn_cast<BitCastInst>(I)->getOperand(0));
+
    if (dyn_cast<Argument>(I) || dyn_cast<GlobalVariable>(I))
    {
       if (I->getType()->isPointerTy())
@@ -193,6 +239,7 @@ const Value* getMemoryVar(const Value* I)
 
 void getMemoryUses(const Value* I, std::set<const Value*> &Uses)
 {
+   I = getOriginalValue(I);
    if (dyn_cast<ConstantInt>(I))
       return;
 
@@ -215,6 +262,11 @@ void getMemoryUses(const Value* I, std::set<const Value*> &Uses)
 
    switch(dyn_cast<Instruction>(I)->getOpcode())
    {
+      case Instruction::PHI:
+      {
+         Uses.insert(I);
+         return;
+      }
       case Instruction::Load:
       {
          getMemoryUses(getRealValue(dyn_cast<LoadInst>(I)->getPointerOperand()), Uses);
@@ -233,6 +285,10 @@ void getMemoryUses(const Value* I, std::set<const Value*> &Uses)
 
 std::string getMemoryString(const Value* I)
 {
+   I = getOriginalValue(I);
+   if (dyn_cast<BitCastInst>(I))
+      return getMemoryString(dyn_cast<BitCastInst>(I)->getOperand(0));
+
    if (dyn_cast<Argument>(I) || dyn_cast<GlobalVariable>(I))
       return I->getName();
 
@@ -252,6 +308,10 @@ std::string getMemoryString(const Value* I)
 
    switch(dyn_cast<Instruction>(I)->getOpcode())
    {
+      case Instruction::PHI:
+      {
+         return I->getName();
+      }
       case Instruction::Load:
       {
          return getMemoryString(dyn_cast<LoadInst>(I)->getPointerOperand());
@@ -286,8 +346,26 @@ std::string getMemoryString(const Value* I)
    return "[ERROR]";
 }
 
+///values of the function represented by the placeholders
+static std::map<const Value*, const Value*> Placeholders;
+
+void setPlaceholder(const Value* P, const Value* V)
+{
+   if (V)
+      Placeholders[P] = V;
+   else
+      Placeholders.erase(P);
+}
+
+const Value* getOriginalValue(const Value* V)
+{
+   std::map<const Value*, const Value*>::const_iterator p = Placeholders.find(V);
+   return p == Placeholders.end() ? V : p->second;
+}
+
 const Value* getRealValue(const Value* I)
 {
+   I = getOriginalValue(I);
    if (dyn_cast<CastInst>(I))
    {
       const Value* val = dyn_cast<UnaryInstruction>(I)->getOperand(0);
@@ -301,6 +379,247 @@ const Value* getRealValue(const Value* I)
    return I;
 }
 
+unsigned int getConstantWidth(int64_t C)
+{
+   ///digits of the signed binary representation plus one
+   unsigned int Width = C ? 1 : 2;
+   for(uint64_t M = C < 0 ? -(uint64_t)C : (uint64_t)C; M; M >>= 1)
+      Width++;
+   return Width + (C < 0 ? 1 : 0);
+}
+
+void AffineForm::add(const AffineForm& Other, int64_t Scale)
+{
+   Constant += Scale * Other.Constant;
+   for(std::map<Monomial, int64_t>::const_iterator t = Other.Terms.begin(); t != Other.Terms.end(); t++)
+   {
+      int64_t& Coefficient = Terms[t->first];
+      Coefficient += Scale * t->second;
+      if (Coefficient == 0) Terms.erase(t->first);
+   }
+}
+
+AffineForm AffineForm::multiply(const AffineForm& A, const AffineForm& B)
+{
+   ///the constant is the coefficient of the empty monomial
+   std::vector<std::pair<Monomial, int64_t> > TermsA(A.Terms.begin(), A.Terms.end());
+   std::vector<std::pair<Monomial, int64_t> > TermsB(B.Terms.begin(), B.Terms.end());
+   TermsA.push_back(std::make_pair(Monomial(), A.Constant));
+   TermsB.push_back(std::make_pair(Monomial(), B.Constant));
+   AffineForm Product;
+   for(unsigned int a = 0; a < TermsA.size(); a++)
+   {
+      for(unsigned int b = 0; b < TermsB.size(); b++)
+      {
+         AffineForm Term;
+         Monomial M;
+         std::merge(TermsA[a].first.begin(), TermsA[a].first.end(), TermsB[b].first.begin(), TermsB[b].first.end(), std::back_inserter(M));
+         if (M.empty())
+            Term.Constant = 1;
+         else
+            Term.Terms[M] = 1;
+         Product.add(Term, TermsA[a].second * TermsB[b].second);
+      }
+   }
+   return Product;
+}
+
+int64_t AffineForm::getCoefficient(const Monomial& M) const
+{
+   std::map<Monomial, int64_t>::const_iterator t = Terms.find(M);
+   if (t == Terms.end()) return 0;
+   return t->second;
+}
+
+std::string AffineForm::getString(const Monomial& M)
+{
+   std::vector<std::string> Names;
+   for(unsigned int v = 0; v < M.size(); v++)
+   {
+      if (M[v]->hasName())
+         Names.push_back(M[v]->getName().str());
+      else if (dyn_cast<LoadInst>(M[v]))
+         Names.push_back("(" + getMemoryString(M[v]) + ")");
+      else
+         Names.push_back("?");
+   }
+   std::sort(Names.begin(), Names.end());
+   std::string Name;
+   for(unsigned int n = 0; n < Names.size(); n++)
+      Name += (n ? "*" : "") + Names[n];
+   return Name;
+}
+
+std::string AffineForm::toString() const
+{
+   ///terms are printed sorted by name, so that the string does not depend on the addresses of the values
+   std::vector<std::pair<std::string, int64_t> > Printed;
+   for(std::map<Monomial, int64_t>::const_iterator t = Terms.begin(); t != Terms.end(); t++)
+      Printed.push_back(std::make_pair(getString(t->first), t->second));
+   std::sort(Printed.begin(), Printed.end());
+   std::ostringstream oss;
+   for(unsigned int t = 0; t < Printed.size(); t++)
+   {
+      int64_t Coefficient = Printed[t].second;
+      if (t) oss << (Coefficient < 0 ? " - " : " + ");
+      else if (Coefficient < 0) oss << "-";
+      if (Coefficient != 1 && Coefficient != -1) oss << (Coefficient < 0 ? -Coefficient : Coefficient) << "*";
+      oss << Printed[t].first;
+   }
+   if (Printed.empty())
+      oss << Constant;
+   else if (Constant)
+      oss << (Constant < 0 ? " - " : " + ") << (Constant < 0 ? -Constant : Constant);
+   return oss.str();
+}
+
+void getAffineForm(const Value* I, AffineForm& Form, std::map<const Value*, AffineForm>* Cache)
+{
+   I = getRealValue(I);
+   if (Cache)
+   {
+      std::map<const Value*, AffineForm>::const_iterator c = Cache->find(I);
+      if (c != Cache->end())
+      {
+         Form = c->second;
+         return;
+      }
+   }
+
+   Form = AffineForm();
+   const BinaryOperator* BO = dyn_cast<BinaryOperator>(I);
+   if (dyn_cast<ConstantInt>(I) && dyn_cast<ConstantInt>(I)->getBitWidth() <= 64)
+   {
+      Form.Constant = dyn_cast<ConstantInt>(I)->getSExtValue();
+   }
+   else if (BO && (BO->getOpcode() == Instruction::Add || BO->getOpcode() == Instruction::Sub || BO->getOpcode() == Instruction::Mul || BO->getOpcode() == Instruction::Shl))
+   {
+      AffineForm Op0, Op1;
+      getAffineForm(BO->getOperand(0), Op0, Cache);
+      getAffineForm(BO->getOperand(1), Op1, Cache);
+      if (BO->getOpcode() == Instruction::Add || BO->getOpcode() == Instruction::Sub)
+      {
+         Form = Op0;
+         Form.add(Op1, BO->getOpcode() == Instruction::Add ? 1 : -1);
+      }
+      else if (BO->getOpcode() == Instruction::Mul)
+         Form = AffineForm::multiply(Op0, Op1);
+      else if (Op1.isConstant() && Op1.Constant >= 0 && Op1.Constant <= 62)
+         Form.add(Op0, (int64_t)1 << Op1.Constant);
+      else
+         Form.Terms[AffineForm::Monomial(1, I)] = 1;
+   }
+   else
+   {
+      ///any other value is a variable
+      Form.Terms[AffineForm::Monomial(1, I)] = 1;
+   }
+   if (Cache) (*Cache)[I] = Form;
+}
+
+/// returns the number of scalar elements of the type (0 if not supported)
+static uint64_t getNumScalars(const Type* Ty)
+{
+   if (Ty->isIntegerTy()) return 1;
+   if (const ArrayType* AT = dyn_cast<ArrayType>(Ty))
+      return AT->getNumElements() * getNumScalars(AT->getElementType());
+   return 0;
+}
+
+bool getAddressForm(const Value* Ptr, AffineForm& Form, std::map<const Value*, AffineForm>* Cache)
+{
+   Ptr = getOriginalValue(Ptr);
+   if (dyn_cast<Argument>(Ptr) || dyn_cast<GlobalVariable>(Ptr))
+   {
+      Form = AffineForm();
+      return true;
+   }
+
+   const GetElementPtrInst* ptr = dyn_cast<GetElementPtrInst>(Ptr);
+   if (!ptr || !getAddressForm(ptr->getPointerOperand(), Form, Cache)) return false;
+   const Type* Ty = dyn_cast<PointerType>(ptr->getPointerOperand()->getType())->getElementType();
+   for(GetElementPtrInst::const_op_iterator It = ptr->idx_begin(); It != ptr->idx_end(); It++)
+   {
+      ///the first index moves across the pointed elements, the others inside the arrays
+      if (It != ptr->idx_begin())
+      {
+         if (!dyn_cast<ArrayType>(Ty)) return false;
+         Ty = dyn_cast<ArrayType>(Ty)->getElementType();
+      }
+      uint64_t Scalars = getNumScalars(Ty);
+      if (!Scalars) return false;
+      AffineForm Index;
+      getAffineForm(*It, Index, Cache);
+      Form.add(Index, Scalars);
+   }
+   return true;
+}
+
+uint64_t getTypeBytes(const Type* Ty)
+{
+   if (Ty->isIntegerTy()) return (Ty->getIntegerBitWidth() + 7) / 8;
+   if (const ArrayType* AT = dyn_cast<ArrayType>(Ty)) return AT->getNumElements() * getTypeBytes(AT->getElementType());
+   if (Ty->isPointerTy()) return 4;
+   return 0;
+}
+
+bool getAddressTerms(const Value* Ptr, const Value*& Memory, std::vector<std::pair<const Value*, uint64_t> >& Terms)
+{
+   Terms.clear();
+   Ptr = getOriginalValue(Ptr);
+   while (!dyn_cast<Argument>(Ptr) && !dyn_cast<GlobalVariable>(Ptr))
+   {
+      if (const BitCastInst* C = dyn_cast<BitCastInst>(Ptr))
+      {
+         Ptr = getOriginalValue(C->getOperand(0));
+         continue;
+      }
+      const GetElementPtrInst* GEP = dyn_cast<GetElementPtrInst>(Ptr);
+      if (!GEP) return false;
+      Type* Ty = GEP->getPointerOperandType();
+      for(GetElementPtrInst::const_op_iterator It = GEP->idx_begin(); It != GEP->idx_end(); It++)
+      {
+         ///the first index moves across the pointed elements, the others inside the arrays
+         if (PointerType* PT = dyn_cast<PointerType>(Ty))
+            Ty = PT->getElementType();
+         else if (ArrayType* AT = dyn_cast<ArrayType>(Ty))
+            Ty = AT->getElementType();
+         else
+            return false;
+         uint64_t Bytes = getTypeBytes(Ty);
+         if (!Bytes) return false;
+         Terms.push_back(std::make_pair((const Value*)*It, Bytes));
+      }
+      Ptr = getOriginalValue(GEP->getPointerOperand());
+   }
+   Memory = Ptr;
+   return true;
+}
+
+std::string getVarName(const Value* V)
+{
+   if (V->hasName()) return V->getName().str();
+   if (const Argument* A = dyn_cast<Argument>(V)) return "arg" + utostr(A->getArgNo());
+   return "global";
+}
+
+bool getReversePostOrder(Function* F, std::vector<BasicBlock*>& Blocks)
+{
+   std::map<BasicBlock*, unsigned int> Position;
+   Blocks.clear();
+   ReversePostOrderTraversal<Function*> RPOT(F);
+   for(ReversePostOrderTraversal<Function*>::rpo_iterator b = RPOT.begin(); b != RPOT.end(); b++)
+   {
+      Position[*b] = Blocks.size();
+      Blocks.push_back(*b);
+   }
+   ///a back edge goes to a block that precedes its source in reverse post-order
+   for(unsigned int b = 0; b < Blocks.size(); b++)
+      for(succ_iterator s = succ_begin(Blocks[b]); s != succ_end(Blocks[b]); s++)
+         if (Position[*s] <= b) return false;
+   return true;
+}
+
 FormattedOutput::FormattedOutput(formatted_raw_ostream& _oss) :
    IndentNum(0),
    OpeningChar('{'), ClosingChar('}'),
@@ -0,0 +1,102 @@
+/**
+ * The MIT License (MIT)
+ * 
+ * Copyright (c) 2013 cad-projects
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+/**
+ * Author: Christian Pilato <christian.pilato@polimi.it>
+ *
+ * Description: Throughput of the operations of cad/FixedInt.h on 13-bit signed values
+ *              (a typical narrowed node of the DFG): the scalar FixedInt, the lanes of
+ *              FixedIntVector and the native 16-bit arithmetic as a bound. The optional
+ *              argument is the number of repetitions over the 64K values.
+ */
+#include "cad/FixedInt.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+using namespace cadlib;
+
+static const unsigned int Size = 65536;
+static const unsigned int Lanes = 16;
+
+typedef FixedInt<13, true> Scalar;
+typedef FixedIntVector<13, true, Lanes> Vector;
+
+static int16_t A[Size], B[Size], C[Size];
+
+/// one pass of each kernel over the arrays; the passes are not inlined, so that the compiler does not merge the
+/// repetitions (A * B would be computed once for several passes)
+__attribute__((noinline)) static void scalarMulAdd()
+{
+   for(unsigned int i = 0; i < Size; i++)
+      C[i] = (int16_t)(Scalar((int64_t)A[i]) * Scalar((int64_t)B[i]) + Scalar((int64_t)C[i])).get();
+}
+
+__attribute__((noinline)) static void vectorMulAdd()
+{
+   for(unsigned int i = 0; i < Size; i += Lanes)
+      (Vector::load(A + i) * Vector::load(B + i) + Vector::load(C + i)).store(C + i);
+}
+
+__attribute__((noinline)) static void vectorAddSat()
+{
+   for(unsigned int i = 0; i < Size; i += Lanes)
+      Vector::addSat(Vector::load(A + i), Vector::load(C + i)).store(C + i);
+}
+
+///native arithmetic on 16 bits, without the truncation to 13 bits
+__attribute__((noinline)) static void nativeMulAdd()
+{
+   for(unsigned int i = 0; i < Size; i++)
+      C[i] = (int16_t)(A[i] * B[i] + C[i]);
+}
+
+/// prints the millions of operations per second of the repetitions of the kernel, and a checksum of C
+static void measure(const char* Name, void (*Kernel)(), unsigned int Repetitions)
+{
+   clock_t Start = clock();
+   for(unsigned int r = 0; r < Repetitions; r++)
+      Kernel();
+   double Seconds = (double)(clock() - Start) / CLOCKS_PER_SEC;
+   long long Checksum = 0;
+   for(unsigned int i = 0; i < Size; i++)
+      Checksum += C[i];
+   double Count = (double)Size * Repetitions;
+   printf("%-28s %10.1f Mops/s (checksum %lld)\n", Name, Seconds > 0 ? Count / Seconds / 1e6 : 0.0, Checksum);
+}
+
+int main(int argc, char** argv)
+{
+   unsigned int Repetitions = argc > 1 ? (unsigned int)atoi(argv[1]) : 2000;
+   for(unsigned int i = 0; i < Size; i++)
+   {
+      A[i] = (int16_t)Scalar((int64_t)(i * 2654435761U)).get();
+      B[i] = (int16_t)Scalar((int64_t)(i * 40503U + 17)).get();
+   }
+
+   measure("FixedInt mul+add", scalarMulAdd, Repetitions);
+   measure("FixedIntVector mul+add", vectorMulAdd, Repetitions);
+   measure("FixedIntVector addSat", vectorAddSat, Repetitions);
+   measure("int16_t mul+add (bound)", nativeMulAdd, Repetitions);
+   return 0;
+}
@@ -0,0 +1,219 @@
+/**
+ * The MIT License (MIT)
+ * 
+ * Copyright (c) 2013 cad-projects
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+/**
+ * Author: Christian Pilato <christian.pilato@polimi.it>
+ *
+ * Description: Check of cad/FixedInt.h against a 128-bit reference of the hardware
+ *              operators for every width between 1 and 64 bits, both signed and
+ *              unsigned, on boundary and random operands (wrapping, saturating,
+ *              division and shift edge cases, conversions and the lanes of
+ *              FixedIntVector). Returns 1 and prints the first mismatches on error.
+ */
+#include "cad/FixedInt.h"
+
+#include <stdio.h>
+
+using namespace cadlib;
+
+typedef __int128 Int128;
+typedef unsigned __int128 UInt128;
+
+static unsigned int Failures = 0;
+
+/// xorshift generator, for a reproducible sequence of operands
+static uint64_t random64()
+{
+   static uint64_t State = 0x9E3779B97F4A7C15ULL;
+   State ^= State << 13;
+   State ^= State >> 7;
+   State ^= State << 17;
+   return State;
+}
+
+static void check(bool Condition, const char* Operation, unsigned int Width, bool Signed, Int128 A, Int128 B)
+{
+   if (Condition) return;
+   if (Failures++ < 20)
+      printf("FAILED: %s on %s%u (a = %lld, b = %lld)\n", Operation, Signed ? "int" : "uint", Width, (long long)A, (long long)B);
+}
+
+/// reference model of a format of Width bits
+template<unsigned int Width, bool Signed>
+struct Reference
+{
+   static Int128 getMin()
+   {
+      return Signed ? -((Int128)1 << (Width - 1)) : 0;
+   }
+
+   static Int128 getMax()
+   {
+      return Signed ? ((Int128)1 << (Width - 1)) - 1 : ((Int128)1 << Width) - 1;
+   }
+
+   /// the low Width bits of X, extended by the signedness of the format
+   static Int128 wrap(Int128 X)
+   {
+      UInt128 Low = (UInt128)X & (((UInt128)1 << Width) - 1);
+      if (Signed && (Low >> (Width - 1)) & 1) return (Int128)Low - ((Int128)1 << Width);
+      return (Int128)Low;
+   }
+
+   static Int128 clamp(Int128 X)
+   {
+      return X < getMin() ? getMin() : X > getMax() ? getMax() : X;
+   }
+};
+
+template<unsigned int Width, bool Signed>
+static void checkPair(Int128 A, Int128 B)
+{
+   typedef FixedInt<Width, Signed> F;
+   typedef Reference<Width, Signed> R;
+   F X((int64_t)A), Y((int64_t)B);
+   check(X.get() == A && Y.get() == B, "construction", Width, Signed, A, B);
+
+   check(X + Y == F((int64_t)R::wrap(A + B)), "+", Width, Signed, A, B);
+   check(X - Y == F((int64_t)R::wrap(A - B)), "-", Width, Signed, A, B);
+   check((X * Y).get() == R::wrap((Int128)((UInt128)A * (UInt128)B)), "*", Width, Signed, A, B);
+   check((X & Y).get() == R::wrap(A & B), "&", Width, Signed, A, B);
+   check((X | Y).get() == R::wrap(A | B), "|", Width, Signed, A, B);
+   check((X ^ Y).get() == R::wrap(A ^ B), "^", Width, Signed, A, B);
+   check((-X).get() == R::wrap(-A), "negation", Width, Signed, A, B);
+   check((~X).get() == R::wrap(~A), "~", Width, Signed, A, B);
+
+   ///division and remainder by zero return 0, MIN / -1 wraps around
+   check((X / Y).get() == (B == 0 ? 0 : R::wrap(A / B)), "/", Width, Signed, A, B);
+   check((X % Y).get() == (B == 0 ? 0 : R::wrap(A % B)), "%", Width, Signed, A, B);
+
+   check((X < Y) == (A < B) && (X <= Y) == (A <= B) && (X > Y) == (A > B) && (X >= Y) == (A >= B), "comparison", Width, Signed, A, B);
+   check((X == Y) == (A == B) && (X != Y) == (A != B), "equality", Width, Signed, A, B);
+
+   check(F::addSat(X, Y).get() == R::clamp(A + B), "addSat", Width, Signed, A, B);
+   check(F::subSat(X, Y).get() == R::clamp(A - B), "subSat", Width, Signed, A, B);
+   ///the unsigned product of 64 bits does not fit in a signed 128-bit integer
+   if (Signed)
+      check(F::mulSat(X, Y).get() == R::clamp(A * B), "mulSat", Width, Signed, A, B);
+   else
+   {
+      UInt128 P = (UInt128)A * (UInt128)B;
+      check((UInt128)F::mulSat(X, Y).get() == (P > (UInt128)R::getMax() ? (UInt128)R::getMax() : P), "mulSat", Width, Signed, A, B);
+   }
+
+   ///the shift amount is taken from the second operand, including the amounts beyond the width
+   unsigned int S = (unsigned int)((UInt128)B % 70);
+   check((X << S).get() == (S >= Width ? 0 : R::wrap((Int128)((UInt128)A << S))), "<<", Width, Signed, A, S);
+   check((X >> S).get() == (S >= Width ? (A < 0 ? -1 : 0) : A >> S), ">>", Width, Signed, A, S);
+
+   ///conversions from the widest formats
+   check(F::saturate(FixedInt<64, true>((int64_t)A)).get() == R::clamp((Int128)(int64_t)A), "saturate(int64)", Width, Signed, A, B);
+   check(F::saturate(FixedInt<64, false>((int64_t)A)).get() == R::clamp((Int128)(uint64_t)A), "saturate(uint64)", Width, Signed, A, B);
+   check(F(FixedInt<64, false>((int64_t)B)).get() == R::wrap((Int128)(uint64_t)B), "conversion", Width, Signed, A, B);
+}
+
+/// boundary values of the format and random operands
+template<unsigned int Width, bool Signed>
+static void checkFormat()
+{
+   typedef Reference<Width, Signed> R;
+   Int128 Values[] = { 0, 1, 2, 3, -1, -2, R::getMin(), R::getMin() + 1, R::getMax(), R::getMax() - 1, R::getMax() / 2, R::getMin() / 2, R::getMax() / 2 + 1 };
+   const unsigned int Count = sizeof(Values) / sizeof(Values[0]);
+   for(unsigned int a = 0; a < Count; a++)
+      for(unsigned int b = 0; b < Count; b++)
+         checkPair<Width, Signed>(R::wrap(Values[a]), R::wrap(Values[b]));
+
+   for(unsigned int i = 0; i < 2000; i++)
+   {
+      ///small operands too, so that the saturating operations are exercised below the limits
+      uint64_t A = random64(), B = random64();
+      if (i % 4 == 1) B &= 0xFF;
+      if (i % 4 == 2) A &= 0xFFFF;
+      checkPair<Width, Signed>(R::wrap((Int128)A), R::wrap((Int128)B));
+   }
+
+   ///every operation of the vector matches the scalar operation on each lane
+   typedef FixedIntVector<Width, Signed, 8> V;
+   typedef FixedInt<Width, Signed> F;
+   for(unsigned int i = 0; i < 100; i++)
+   {
+      int64_t DataA[8], DataB[8];
+      for(unsigned int l = 0; l < 8; l++)
+      {
+         DataA[l] = (int64_t)random64();
+         DataB[l] = l == 0 ? 0 : l == 1 ? -1 : (int64_t)random64();
+      }
+      V A = V::load(DataA), B = V::load(DataB);
+      unsigned int S = (unsigned int)(random64() % 70);
+      V Sum = A + B, Difference = A - B, Product = A * B, Quotient = A / B, Remainder = A % B;
+      V And = A & B, Or = A | B, Xor = A ^ B, Left = A << S, Right = A >> S;
+      V AddSat = V::addSat(A, B), SubSat = V::subSat(A, B), MulSat = V::mulSat(A, B);
+      V Min = V::select(A < B, A, B);
+      FixedIntVector<1, false, 8> Equal = A == B, Less = A <= B;
+      for(unsigned int l = 0; l < 8; l++)
+      {
+         F X(DataA[l]), Y(DataB[l]);
+         Int128 Lane = X.get(), Other = Y.get();
+         check(A[l] == X && B[l] == Y, "vector load", Width, Signed, Lane, Other);
+         check(Sum[l] == X + Y && Difference[l] == X - Y && Product[l] == X * Y, "vector arithmetic", Width, Signed, Lane, Other);
+         check(Quotient[l] == X / Y && Remainder[l] == X % Y, "vector division", Width, Signed, Lane, Other);
+         check(And[l] == (X & Y) && Or[l] == (X | Y) && Xor[l] == (X ^ Y), "vector logic", Width, Signed, Lane, Other);
+         check(Left[l] == X << S && Right[l] == X >> S, "vector shift", Width, Signed, Lane, S);
+         check(AddSat[l] == F::addSat(X, Y) && SubSat[l] == F::subSat(X, Y) && MulSat[l] == F::mulSat(X, Y), "vector saturation", Width, Signed, Lane, Other);
+         check(Min[l] == (X < Y ? X : Y) && Equal[l].get() == (X == Y) && Less[l].get() == (X <= Y), "vector comparison", Width, Signed, Lane, Other);
+      }
+      int64_t Stored[8];
+      Sum.store(Stored);
+      for(unsigned int l = 0; l < 8; l++)
+         check(Stored[l] == (int64_t)Sum[l].get(), "vector store", Width, Signed, Stored[l], 0);
+   }
+}
+
+/// checks the signed and unsigned formats of every width from Width to 64
+template<unsigned int Width>
+struct CheckWidths
+{
+   static void run()
+   {
+      checkFormat<Width, true>();
+      checkFormat<Width, false>();
+      CheckWidths<Width + 1>::run();
+   }
+};
+
+template<>
+struct CheckWidths<65>
+{
+   static void run() {}
+};
+
+int main()
+{
+   CheckWidths<1>::run();
+   if (Failures)
+   {
+      printf("%u checks FAILED\n", Failures);
+      return 1;
+   }
+   printf("FixedInt: all the checks PASSED\n");
+   return 0;
+}